@@ -0,0 +1,187 @@
+// Compares the ways of walking the AST: virtual accept_visitor + ASTVisitor, the kind-tag switch
+// in StaticVisitor, and a linear scan over the flat structure-of-arrays copy. Builds a program with
+// a few million expression nodes and times a full traversal with each.
+//
+// usage: ./bench_dispatch [num_statements] [expr_depth] [iterations]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "../../src/ast/visitor.hpp"
+#include "../../src/ast/static_visitor.hpp"
+#include "../../src/ast/flat_ast.hpp"
+
+// Build a random expression tree mixing every expression node kind
+std::unique_ptr<Expr> make_expr(std::mt19937& rng, unsigned int depth) {
+	if (depth == 0) {
+		switch (rng() % 4) {
+			case 0: return std::unique_ptr<Expr>(new IntExpr(rng() % 100, 0, 0));
+			case 1: return std::unique_ptr<Expr>(new FloatExpr(1.5f, 0, 0));
+			case 2: return std::unique_ptr<Expr>(new BoolExpr(true, 0, 0));
+			default: return std::unique_ptr<Expr>(new IdentifierExpr("x", 0, 0));
+		}
+	}
+
+	switch (rng() % 8) {
+		case 0:
+			return std::unique_ptr<Expr>(new UnaryExpr(UnaryOp::Negate, make_expr(rng, depth - 1), 0, 0));
+
+		case 1: {
+			auto assign = std::unique_ptr<AssignExpr>(new AssignExpr());
+			assign->name = "x";
+			assign->expr = make_expr(rng, depth - 1);
+			return std::move(assign);
+		}
+
+		case 2: {
+			auto call = std::unique_ptr<FuncCallExpr>(new FuncCallExpr());
+			call->func_name = "f";
+			call->params.push_front(make_expr(rng, depth - 1));
+			call->params.push_front(make_expr(rng, depth - 1));
+			return std::move(call);
+		}
+
+		default:
+			return std::unique_ptr<Expr>(new BinaryExpr(BinaryOp::Plus, make_expr(rng, depth - 1), make_expr(rng, depth - 1), 0, 0));
+	}
+}
+
+std::unique_ptr<Program> make_program(unsigned int num_statements, unsigned int expr_depth) {
+	std::mt19937 rng(42);
+
+	auto block = std::unique_ptr<Block>(new Block());
+	for (unsigned int i = 0; i < num_statements; i++) {
+		auto stmt = std::unique_ptr<ExprStmt>(new ExprStmt());
+		stmt->expr = make_expr(rng, expr_depth);
+		block->statements.push_front(std::move(stmt));
+	}
+
+	auto func = std::unique_ptr<FuncDecl>(new FuncDecl());
+	func->name = "main";
+	func->return_type = ReturnType::Void;
+	func->body = std::move(block);
+
+	auto program = std::unique_ptr<Program>(new Program());
+	program->decls.push_front(std::move(func));
+	return program;
+}
+
+// Both counters do the same (small) amount of work per node, so the difference is the dispatch cost
+class DynamicCounter : public ASTVisitor {
+public:
+	void visit_program(const Program& program) override { nodes++; for (auto& d : program.decls) d->accept_visitor(*this); }
+	void visit_extern_decl(const ExternDecl&) override { nodes++; }
+	void visit_var_decl(const VarDecl&) override { nodes++; }
+	void visit_func_decl(const FuncDecl& decl) override { nodes++; decl.body->accept_visitor(*this); }
+	void visit_block(const Block& block) override { nodes++; for (auto& s : block.statements) s->accept_visitor(*this); }
+	void visit_local_decl(const VarDecl&) override { nodes++; }
+	void visit_expr_stmt(const ExprStmt& stmt) override { nodes++; stmt.expr->accept_visitor(*this); }
+	void visit_return_stmt(const Return&) override { nodes++; }
+	void visit_if_else_stmt(const IfElse&) override { nodes++; }
+	void visit_while_stmt(const While&) override { nodes++; }
+	void visit_unary_expr(const UnaryExpr& expr) override { nodes++; expr.operand->accept_visitor(*this); }
+	void visit_binary_expr(const BinaryExpr& expr) override { nodes++; expr.first_operand->accept_visitor(*this); expr.second_operand->accept_visitor(*this); }
+	void visit_assign_expr(const AssignExpr& expr) override { nodes++; expr.expr->accept_visitor(*this); }
+	void visit_identifier_expr(const IdentifierExpr&) override { nodes++; }
+	void visit_index_expr(const IndexExpr& expr) override { nodes++; expr.index->accept_visitor(*this); }
+	void visit_func_call_expr(const FuncCallExpr& expr) override { nodes++; for (auto& p : expr.params) p->accept_visitor(*this); }
+	void visit_int_expr(const IntExpr& expr) override { nodes++; sum += expr.value; }
+	void visit_float_expr(const FloatExpr&) override { nodes++; }
+	void visit_bool_expr(const BoolExpr&) override { nodes++; }
+
+	unsigned long nodes = 0;
+	long sum = 0;
+};
+
+class StaticCounter : public StaticVisitor<StaticCounter> {
+public:
+	void visit_program(const Program& program) { nodes++; for (auto& d : program.decls) this->dispatch(*d); }
+	void visit_extern_decl(const ExternDecl&) { nodes++; }
+	void visit_var_decl(const VarDecl&) { nodes++; }
+	void visit_func_decl(const FuncDecl& decl) { nodes++; this->dispatch(*decl.body); }
+	void visit_block(const Block& block) { nodes++; for (auto& s : block.statements) this->dispatch(*s); }
+	void visit_local_decl(const VarDecl&) { nodes++; }
+	void visit_expr_stmt(const ExprStmt& stmt) { nodes++; this->dispatch(*stmt.expr); }
+	void visit_return_stmt(const Return&) { nodes++; }
+	void visit_if_else_stmt(const IfElse&) { nodes++; }
+	void visit_while_stmt(const While&) { nodes++; }
+	void visit_unary_expr(const UnaryExpr& expr) { nodes++; this->dispatch(*expr.operand); }
+	void visit_binary_expr(const BinaryExpr& expr) { nodes++; this->dispatch(*expr.first_operand); this->dispatch(*expr.second_operand); }
+	void visit_assign_expr(const AssignExpr& expr) { nodes++; this->dispatch(*expr.expr); }
+	void visit_identifier_expr(const IdentifierExpr&) { nodes++; }
+	void visit_index_expr(const IndexExpr& expr) { nodes++; this->dispatch(*expr.index); }
+	void visit_func_call_expr(const FuncCallExpr& expr) { nodes++; for (auto& p : expr.params) this->dispatch(*p); }
+	void visit_int_expr(const IntExpr& expr) { nodes++; sum += expr.value; }
+	void visit_float_expr(const FloatExpr&) { nodes++; }
+	void visit_bool_expr(const BoolExpr&) { nodes++; }
+
+	unsigned long nodes = 0;
+	long sum = 0;
+};
+
+template <typename F>
+double best_of(unsigned int iterations, F walk) {
+	std::vector<double> times;
+
+	for (unsigned int i = 0; i < iterations; i++) {
+		auto start = std::chrono::steady_clock::now();
+		walk();
+		auto end = std::chrono::steady_clock::now();
+		times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+	}
+
+	return *std::min_element(times.begin(), times.end());
+}
+
+int main(int argc, char** argv) {
+	unsigned int num_statements = argc > 1 ? std::atoi(argv[1]) : 4096;
+	unsigned int expr_depth = argc > 2 ? std::atoi(argv[2]) : 10;
+	unsigned int iterations = argc > 3 ? std::atoi(argv[3]) : 10;
+
+	auto program = make_program(num_statements, expr_depth);
+
+	unsigned long nodes = 0;
+	long sum = 0;
+
+	double dynamic_ms = best_of(iterations, [&]() {
+		DynamicCounter counter;
+		program->accept_visitor(counter);
+		nodes = counter.nodes;
+		sum = counter.sum;
+	});
+
+	double static_ms = best_of(iterations, [&]() {
+		StaticCounter counter;
+		counter.dispatch(*program);
+		if (counter.nodes != nodes || counter.sum != sum) {
+			std::cerr << "visitors disagree on the tree they walked" << std::endl;
+			std::exit(1);
+		}
+	});
+
+	// The flat copy also holds the function's params, so compare the literal sum rather than the count
+	auto flat_ast = ast::flat::flatten(*program);
+	double flat_ms = best_of(iterations, [&]() {
+		long flat_sum = 0;
+		for (ast::flat::NodeId id = 0; id < flat_ast.size(); id++) {
+			if (flat_ast.kinds[id] == NodeKind::IntExpr) {
+				flat_sum += flat_ast.int_value(id);
+			}
+		}
+		if (flat_sum != sum) {
+			std::cerr << "flat scan disagrees with the visitors" << std::endl;
+			std::exit(1);
+		}
+	});
+
+	std::cout << "nodes:            " << nodes << std::endl;
+	std::cout << "virtual dispatch: " << dynamic_ms << " ms (" << dynamic_ms * 1e6 / nodes << " ns/node)" << std::endl;
+	std::cout << "static dispatch:  " << static_ms << " ms (" << static_ms * 1e6 / nodes << " ns/node)" << std::endl;
+	std::cout << "flat scan:        " << flat_ms << " ms (" << flat_ms * 1e6 / nodes << " ns/node)" << std::endl;
+	std::cout << "speedup:          " << dynamic_ms / static_ms << "x static, " << dynamic_ms / flat_ms << "x flat" << std::endl;
+}
@@ -0,0 +1,290 @@
+// Generates a random, valid (parses and type checks) MiniC program following the grammar file, for
+// measuring compiler throughput on inputs of any size. The same options and seed always produce the
+// same program.
+//
+// usage: ./minic_gen [options] > program.c
+//   --functions=N   number of functions (default 100)
+//   --stmts=N       statements per block (default 20)
+//   --depth=N       maximum expression depth (default 4)
+//   --literals=P    probability that an expression leaf is a literal rather than a variable (default 0.3)
+//   --nesting=N     maximum nesting of if/while blocks (default 2)
+//   --size=BYTES    keep adding functions until the program is at least this big (overrides --functions)
+//   --seed=N        random seed (default 1)
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+enum class Type { Int, Float, Bool };
+
+const Type ALL_TYPES[] = { Type::Int, Type::Float, Type::Bool };
+
+const char* type_str(Type type) {
+	switch (type) {
+		case Type::Int: return "int";
+		case Type::Float: return "float";
+		case Type::Bool: return "bool";
+	}
+	return "";
+}
+
+struct Options {
+	unsigned int functions = 100;
+	unsigned int stmts = 20;
+	unsigned int depth = 4;
+	double literals = 0.3;
+	unsigned int nesting = 2;
+	unsigned long long size = 0;
+	unsigned int seed = 1;
+};
+
+struct Variable {
+	std::string name;
+	Type type;
+};
+
+struct Function {
+	std::string name;
+	Type return_type;
+	std::vector<Type> params;
+};
+
+class Generator {
+public:
+	Generator(const Options& options) :
+		options(options),
+		rng(options.seed) { }
+
+	void generate(std::ostream& os) {
+		os << "// Generated by minic_gen" << std::endl << std::endl;
+		os << "extern int print_int(int X);" << std::endl;
+		os << "extern float print_float(float X);" << std::endl << std::endl;
+		this->functions.push_back({ "print_int", Type::Int, { Type::Int } });
+		this->functions.push_back({ "print_float", Type::Float, { Type::Float } });
+
+		for (Type type : ALL_TYPES) {
+			for (unsigned int i = 0; i < 2; i++) {
+				Variable global { std::string("g_") + type_str(type) + std::to_string(i), type };
+				os << type_str(type) << " " << global.name << ";" << std::endl;
+				this->globals.push_back(global);
+			}
+		}
+		os << std::endl;
+
+		unsigned long long written = 0;
+		for (unsigned int i = 0; this->options.size != 0 ? written < this->options.size : i < this->options.functions; i++) {
+			std::string func = this->function(i);
+			written += func.size();
+			os << func;
+		}
+	}
+
+private:
+	bool chance(double p) {
+		return std::uniform_real_distribution<double>(0, 1)(this->rng) < p;
+	}
+
+	unsigned int below(unsigned int n) {
+		return this->rng() % n;
+	}
+
+	Type any_type() {
+		return ALL_TYPES[this->below(3)];
+	}
+
+	void indent(unsigned int level) {
+		for (unsigned int i = 0; i < level; i++) {
+			this->out << "  ";
+		}
+	}
+
+	std::string function(unsigned int index) {
+		this->out.str("");
+
+		Function func { "f" + std::to_string(index), this->any_type(), {} };
+		unsigned int num_params = this->below(4);
+		for (unsigned int i = 0; i < num_params; i++) {
+			func.params.push_back(this->any_type());
+		}
+
+		this->out << type_str(func.return_type) << " " << func.name << "(";
+		this->locals.clear();
+		for (unsigned int i = 0; i < num_params; i++) {
+			Variable param { "p" + std::to_string(i), func.params[i] };
+			this->out << (i == 0 ? "" : ", ") << type_str(param.type) << " " << param.name;
+			this->locals.push_back(param);
+		}
+		this->out << ") {" << std::endl;
+
+		for (Type type : ALL_TYPES) {
+			for (unsigned int i = 0; i < 2; i++) {
+				Variable local { std::string("l_") + type_str(type) + std::to_string(i), type };
+				this->indent(1);
+				this->out << type_str(type) << " " << local.name << ";" << std::endl;
+				this->locals.push_back(local);
+			}
+		}
+
+		this->stmt_list(1, 0);
+
+		this->indent(1);
+		this->out << "return " << this->expr(func.return_type, this->options.depth) << ";" << std::endl;
+		this->out << "}" << std::endl << std::endl;
+
+		// Only earlier functions are called, so the generated program has no recursion
+		this->functions.push_back(func);
+		return this->out.str();
+	}
+
+	void stmt_list(unsigned int level, unsigned int nesting) {
+		for (unsigned int i = 0; i < this->options.stmts; i++) {
+			this->stmt(level, nesting);
+		}
+	}
+
+	void stmt(unsigned int level, unsigned int nesting) {
+		unsigned int kind = this->below(10);
+
+		if (kind == 0 && nesting < this->options.nesting) {
+			this->indent(level);
+			this->out << "if (" << this->expr(Type::Bool, this->options.depth) << ") {" << std::endl;
+			this->stmt_list(level + 1, nesting + 1);
+			this->indent(level);
+			if (this->chance(0.5)) {
+				this->out << "} else {" << std::endl;
+				this->stmt_list(level + 1, nesting + 1);
+				this->indent(level);
+			}
+			this->out << "}" << std::endl;
+		} else if (kind == 1 && nesting < this->options.nesting) {
+			this->indent(level);
+			this->out << "while (" << this->expr(Type::Bool, this->options.depth) << ") {" << std::endl;
+			this->stmt_list(level + 1, nesting + 1);
+			this->indent(level);
+			this->out << "}" << std::endl;
+		} else {
+			const Variable& var = this->variable(this->any_type());
+			this->indent(level);
+			this->out << var.name << " = " << this->expr(var.type, this->options.depth) << ";" << std::endl;
+		}
+	}
+
+	const Variable& variable(Type type) {
+		std::vector<const Variable*> candidates;
+		for (auto& var : this->locals) {
+			if (var.type == type) {
+				candidates.push_back(&var);
+			}
+		}
+		for (auto& var : this->globals) {
+			if (var.type == type) {
+				candidates.push_back(&var);
+			}
+		}
+
+		return *candidates[this->below(candidates.size())];
+	}
+
+	std::string literal(Type type) {
+		switch (type) {
+			case Type::Int: return std::to_string(this->below(1000));
+			case Type::Float: return std::to_string(this->below(1000)) + "." + std::to_string(this->below(100));
+			case Type::Bool: return this->chance(0.5) ? "true" : "false";
+		}
+		return "";
+	}
+
+	std::string call(Type type, unsigned int depth) {
+		std::vector<const Function*> candidates;
+		for (auto& func : this->functions) {
+			if (func.return_type == type) {
+				candidates.push_back(&func);
+			}
+		}
+
+		if (candidates.empty()) {
+			return this->literal(type);
+		}
+
+		const Function& func = *candidates[this->below(candidates.size())];
+		std::string s = func.name + "(";
+		for (size_t i = 0; i < func.params.size(); i++) {
+			s += (i == 0 ? "" : ", ") + this->expr(func.params[i], depth - 1);
+		}
+		return s + ")";
+	}
+
+	std::string expr(Type type, unsigned int depth) {
+		if (depth == 0 || this->chance(0.2)) {
+			return this->chance(this->options.literals) ? this->literal(type) : this->variable(type).name;
+		}
+
+		unsigned int kind = this->below(10);
+		if (kind == 0) {
+			return "(" + this->expr(type, depth - 1) + ")";
+		} else if (kind == 1) {
+			return this->call(type, depth);
+		} else if (kind == 2) {
+			return (type == Type::Bool ? "!" : "- ") + this->expr(type, depth - 1);
+		}
+
+		if (type == Type::Bool) {
+			const char* logic_ops[] = { "&&", "||", "==", "!=" };
+			const char* cmp_ops[] = { "<", "<=", ">", ">=", "==", "!=" };
+
+			if (this->chance(0.5)) {
+				return this->expr(Type::Bool, depth - 1) + " " + logic_ops[this->below(4)] + " " + this->expr(Type::Bool, depth - 1);
+			}
+
+			Type operand_type = this->chance(0.5) ? Type::Int : Type::Float;
+			return "(" + this->expr(operand_type, depth - 1) + " " + cmp_ops[this->below(6)] + " " + this->expr(operand_type, depth - 1) + ")";
+		}
+
+		const char* int_ops[] = { "+", "-", "*", "/", "%" };
+		const char* op = int_ops[this->below(type == Type::Int ? 5 : 4)];
+		return "(" + this->expr(type, depth - 1) + " " + op + " " + this->expr(type, depth - 1) + ")";
+	}
+
+	Options options;
+	std::mt19937 rng;
+	std::ostringstream out;
+	std::vector<Variable> globals;
+	std::vector<Variable> locals;
+	std::vector<Function> functions;
+};
+
+int main(int argc, char** argv) {
+	Options options;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg(argv[i]);
+		size_t eq = arg.find('=');
+		std::string name = arg.substr(0, eq);
+		const char* value = eq == std::string::npos ? "" : argv[i] + eq + 1;
+
+		if (name == "--functions") {
+			options.functions = std::atoi(value);
+		} else if (name == "--stmts") {
+			options.stmts = std::atoi(value);
+		} else if (name == "--depth") {
+			options.depth = std::atoi(value);
+		} else if (name == "--literals") {
+			options.literals = std::atof(value);
+		} else if (name == "--nesting") {
+			options.nesting = std::atoi(value);
+		} else if (name == "--size") {
+			options.size = std::strtoull(value, nullptr, 10);
+		} else if (name == "--seed") {
+			options.seed = std::atoi(value);
+		} else {
+			std::cerr << "usage error: unknown option \"" << arg << "\"" << std::endl;
+			return 1;
+		}
+	}
+
+	Generator generator(options);
+	generator.generate(std::cout);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+// Shared timing loop for the runtime benchmark drivers. Each driver links against one compiled MiniC
+// kernel, like the drivers in tests/, and calls benchmark() on its entry point.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+// Kernels may print, but printing would dominate the time being measured, so the externs only consume
+// their argument
+extern "C" DLLEXPORT int print_int(int X) {
+	volatile int sink = X;
+	(void)sink;
+	return 0;
+}
+
+extern "C" DLLEXPORT float print_float(float X) {
+	volatile float sink = X;
+	(void)sink;
+	return 0;
+}
+
+template <typename F>
+double time_batch(F fn, unsigned long calls) {
+	volatile double sink = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned long i = 0; i < calls; i++) {
+		sink = sink + fn();
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+// Calibrates the number of calls per batch so that a batch takes at least 10ms, then times a number of
+// batches and prints "RESULT <name> <median ns/call> <mean ns/call> <stddev ns/call>".
+template <typename F>
+void benchmark(const char* name, F fn, unsigned int repetitions = 15) {
+	const double min_batch_ns = 10e6;
+
+	unsigned long calls = 1;
+	while (time_batch(fn, calls) < min_batch_ns) {
+		calls *= 2;
+	}
+
+	std::vector<double> ns_per_call;
+	for (unsigned int i = 0; i < repetitions; i++) {
+		ns_per_call.push_back(time_batch(fn, calls) / calls);
+	}
+
+	std::sort(ns_per_call.begin(), ns_per_call.end());
+	double median = ns_per_call[ns_per_call.size() / 2];
+
+	double mean = 0;
+	for (double ns : ns_per_call) {
+		mean += ns;
+	}
+	mean /= ns_per_call.size();
+
+	double variance = 0;
+	for (double ns : ns_per_call) {
+		variance += (ns - mean) * (ns - mean);
+	}
+	double stddev = std::sqrt(variance / ns_per_call.size());
+
+	printf("RESULT %s %.3f %.3f %.3f\n", name, median, mean, stddev);
+}
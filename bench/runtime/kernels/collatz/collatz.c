@@ -0,0 +1,24 @@
+// MiniC kernel: total Collatz sequence length of every number below n (branchy integer loop)
+
+int collatz(int n) {
+  int i;
+  int x;
+  int steps;
+
+  steps = 0;
+  i = 1;
+  while (i < n) {
+    x = i;
+    while (x != 1) {
+      if (x % 2 == 0) {
+        x = x / 2;
+      } else {
+        x = 3 * x + 1;
+      }
+      steps = steps + 1;
+    }
+    i = i + 1;
+  }
+
+  return steps;
+}
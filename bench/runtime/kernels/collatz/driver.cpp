@@ -0,0 +1,11 @@
+#include "../../harness.hpp"
+
+// Benchmarks bench/runtime/kernels/collatz/collatz.c
+
+extern "C" {
+  int collatz(int n);
+}
+
+int main() {
+  benchmark("collatz", []() { return collatz(10000); });
+}
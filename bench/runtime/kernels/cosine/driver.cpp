@@ -0,0 +1,11 @@
+#include "../../harness.hpp"
+
+// Benchmarks tests/cosine/cosine.c
+
+extern "C" {
+  float cosine(float x);
+}
+
+int main() {
+  benchmark("cosine", []() { return cosine(1.0f); });
+}
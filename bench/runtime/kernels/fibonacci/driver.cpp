@@ -0,0 +1,11 @@
+#include "../../harness.hpp"
+
+// Benchmarks tests/fibonacci/fibonacci.c
+
+extern "C" {
+  int fibonacci(int n);
+}
+
+int main() {
+  benchmark("fibonacci", []() { return fibonacci(40); });
+}
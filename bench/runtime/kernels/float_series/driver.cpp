@@ -0,0 +1,11 @@
+#include "../../harness.hpp"
+
+// Benchmarks bench/runtime/kernels/float_series/float_series.c
+
+extern "C" {
+  float float_series(int n);
+}
+
+int main() {
+  benchmark("float_series", []() { return float_series(100000); });
+}
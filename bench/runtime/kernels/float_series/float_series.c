@@ -0,0 +1,18 @@
+// MiniC kernel: partial sum of the Leibniz series (floating point loop with int to float coercion)
+
+float float_series(int n) {
+  int i;
+  float sum;
+  float sign;
+
+  sum = 0.0;
+  sign = 1.0;
+  i = 0;
+  while (i < n) {
+    sum = sum + sign / (2 * i + 1);
+    sign = -sign;
+    i = i + 1;
+  }
+
+  return 4.0 * sum;
+}
@@ -0,0 +1,11 @@
+#include "../../harness.hpp"
+
+// Benchmarks bench/runtime/kernels/nested_loop/nested_loop.c
+
+extern "C" {
+  int nested_loop(int n);
+}
+
+int main() {
+  benchmark("nested_loop", []() { return nested_loop(300); });
+}
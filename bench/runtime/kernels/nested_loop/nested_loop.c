@@ -0,0 +1,20 @@
+// MiniC kernel: integer arithmetic in a doubly nested loop
+
+int nested_loop(int n) {
+  int i;
+  int j;
+  int sum;
+
+  sum = 0;
+  i = 0;
+  while (i < n) {
+    j = 0;
+    while (j < n) {
+      sum = sum + (i * j) % 7 - (i + j) / 3;
+      j = j + 1;
+    }
+    i = i + 1;
+  }
+
+  return sum;
+}
@@ -0,0 +1,11 @@
+#include "../../harness.hpp"
+
+// Benchmarks tests/pi/pi.c
+
+extern "C" {
+  float pi();
+}
+
+int main() {
+  benchmark("pi", []() { return pi(); });
+}
@@ -0,0 +1,11 @@
+#include "../../harness.hpp"
+
+// Benchmarks tests/rfact/rfact.c
+
+extern "C" {
+  int rfact(int n);
+}
+
+int main() {
+  benchmark("rfact", []() { return rfact(12); });
+}
@@ -0,0 +1,11 @@
+#include "../../harness.hpp"
+
+// Benchmarks bench/runtime/kernels/tail_recursion/tail_recursion.c
+
+extern "C" {
+  int tail_recursion(int n);
+}
+
+int main() {
+  benchmark("tail_recursion", []() { return tail_recursion(1000000); });
+}
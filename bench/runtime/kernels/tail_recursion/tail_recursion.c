@@ -0,0 +1,13 @@
+// MiniC kernel: a million calls deep self tail recursion, which only fits on the stack as tail calls
+
+int count_down(int n, int total) {
+  if (n == 0) {
+    return total;
+  }
+
+  return count_down(n - 1, total + n % 7);
+}
+
+int tail_recursion(int n) {
+  return count_down(n, 0);
+}
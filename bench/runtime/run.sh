@@ -0,0 +1,74 @@
+#!/bin/bash
+# Measures how fast the code mccomp generates runs. Each kernel in bench/runtime/kernels is compiled by
+# mccomp at every optimisation level in LEVELS (its own -O0 to -O3 pipeline), turned into object code by
+# llc at the same level, linked against the kernel's driver.cpp (see harness.hpp) and timed. With CLANG_COMPARE=1 the kernel's source is also compiled as C by clang
+# -O2, as a baseline for what the same program could run at. Results are printed and appended to
+# bench/results/runtime.csv.
+#
+# usage: bench/runtime/run.sh                (from the repository root, after make mccomp)
+#   KERNELS="pi collatz" LEVELS="0 2" CLANG_COMPARE=1 bench/runtime/run.sh
+
+LEVELS=${LEVELS:-"0 1 2 3"}
+LLC=${LLC:-llc}
+CC=${CC:-clang}
+CXX=${CXX:-clang++}
+
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+RESULTS=$ROOT/bench/results/runtime.csv
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+if [ -z "$KERNELS" ]; then
+	KERNELS=$(ls "$ROOT/bench/runtime/kernels")
+fi
+
+mkdir -p "$(dirname "$RESULTS")"
+if [ ! -f "$RESULTS" ]; then
+	echo "date,commit,kernel,config,median_ns,mean_ns,stddev_ns" > "$RESULTS"
+fi
+
+DATE=$(date -u +%Y-%m-%dT%H:%M:%SZ)
+COMMIT=$(git -C "$ROOT" rev-parse --short HEAD 2>/dev/null || echo unknown)
+
+# Link kernel.o against a driver, run it and record its result line
+function run_kernel {
+	local kernel=$1 config=$2
+
+	if ! $CXX -O2 "$ROOT/bench/runtime/kernels/$kernel/driver.cpp" "$WORK/kernel.o" -o "$WORK/bench"; then
+		echo "$kernel: failed to link for $config"
+		return
+	fi
+
+	read -r _ name median mean stddev <<< "$("$WORK/bench" | grep '^RESULT')"
+	printf "%-14s %-10s %14s %14s %14s\n" "$kernel" "$config" "$median" "$mean" "$stddev"
+	echo "$DATE,$COMMIT,$kernel,$config,$median,$mean,$stddev" >> "$RESULTS"
+}
+
+printf "%-14s %-10s %14s %14s %14s\n" "kernel" "config" "median ns" "mean ns" "stddev ns"
+
+for kernel in $KERNELS; do
+	# Kernels taken from tests/ have no source of their own
+	source=$ROOT/bench/runtime/kernels/$kernel/$kernel.c
+	if [ ! -f "$source" ]; then
+		source=$ROOT/tests/$kernel/$kernel.c
+	fi
+
+	for level in $LEVELS; do
+		rm -f "$WORK/output.ll"
+		if ! "$ROOT/mccomp" -O$level -o "$WORK/output.ll" "$source" > /dev/null; then
+			echo "$kernel: mccomp -O$level failed"
+			continue
+		fi
+
+		# The IR is already optimised, so llc only selects instructions and allocates registers
+		$LLC -O$level -relocation-model=pic -filetype=obj "$WORK/output.ll" -o "$WORK/kernel.o" || continue
+		run_kernel "$kernel" "mccomp-O$level"
+	done
+
+	# MiniC is close enough to C that, given stdbool.h, the kernels compile as C unchanged
+	if [ "$CLANG_COMPARE" = "1" ]; then
+		if $CC -x c -O2 -include stdbool.h -fPIC -c "$source" -o "$WORK/kernel.o"; then
+			run_kernel "$kernel" "clang-O2"
+		fi
+	fi
+done
@@ -0,0 +1,41 @@
+#!/bin/bash
+# Measures the throughput (source lines per second) of each phase of mccomp on generated programs from
+# 1 KB to 100 MB, using mccomp's -ftime-report. Every run is appended to bench/results/throughput.csv,
+# tagged with the date and commit, so regressions can be tracked over time.
+#
+# usage: bench/throughput/run.sh             (from the repository root, after make mccomp minic_gen)
+#   SIZES="1000 1000000" bench/throughput/run.sh   to choose the input sizes in bytes
+
+SIZES=${SIZES:-"1000 10000 100000 1000000 10000000 100000000"}
+GEN_OPTIONS=${GEN_OPTIONS:-"--stmts=8 --depth=4 --nesting=2"}
+
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+RESULTS=$ROOT/bench/results/throughput.csv
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+mkdir -p "$(dirname "$RESULTS")"
+if [ ! -f "$RESULTS" ]; then
+	echo "date,commit,size_bytes,lines,phase,ms,lines_per_sec" > "$RESULTS"
+fi
+
+DATE=$(date -u +%Y-%m-%dT%H:%M:%SZ)
+COMMIT=$(git -C "$ROOT" rev-parse --short HEAD 2>/dev/null || echo unknown)
+
+printf "%-12s %-10s %-24s %12s %16s\n" "size" "lines" "phase" "ms" "lines/sec"
+
+for size in $SIZES; do
+	"$ROOT/minic_gen" --size="$size" $GEN_OPTIONS > "$WORK/input.c"
+	lines=$(wc -l < "$WORK/input.c")
+
+	# The report's first column is the phase name, padded to 28 characters
+	(cd "$WORK" && "$ROOT/mccomp" -ftime-report input.c 2> report.txt > /dev/null)
+	sed -n '/^phase/,/^total/p' "$WORK/report.txt" | tail -n +2 | while IFS= read -r row; do
+		phase=$(echo "${row:0:28}" | sed 's/ *$//')
+		ms=$(echo "${row:28}" | awk '{ print $1 }')
+		rate=$(awk -v lines="$lines" -v ms="$ms" 'BEGIN { printf "%.0f", (ms > 0 ? lines / (ms / 1000) : 0) }')
+
+		printf "%-12s %-10s %-24s %12s %16s\n" "$size" "$lines" "$phase" "$ms" "$rate"
+		echo "$DATE,$COMMIT,$size,$lines,$phase,$ms,$rate" >> "$RESULTS"
+	done
+done
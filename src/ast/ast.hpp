@@ -4,8 +4,34 @@
 
 class ASTVisitor;
 
+// Tag identifying the concrete class of a node, used by StaticVisitor to dispatch without virtual calls
+enum class NodeKind {
+	Program,
+	ExternDecl,
+	VarDecl,
+	FuncDecl,
+	Param,
+	Block,
+	IfElse,
+	While,
+	Return,
+	ExprStmt,
+	UnaryExpr,
+	BinaryExpr,
+	AssignExpr,
+	IdentifierExpr,
+	IndexExpr,
+	FuncCallExpr,
+	IntExpr,
+	FloatExpr,
+	BoolExpr
+};
+
 class ASTNode {
 public:
+	ASTNode(NodeKind kind) noexcept : kind(kind) {}
 	virtual void accept_visitor(ASTVisitor& visitor) = 0;
 	virtual ~ASTNode() {}
+
+	const NodeKind kind;
 };
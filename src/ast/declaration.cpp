@@ -11,6 +11,12 @@ namespace declaration {
 			case ReturnType::Float: return "float";
 			case ReturnType::Bool: return "bool";
 			case ReturnType::Void: return "void";
+			case ReturnType::Long: return "long";
+			case ReturnType::Double: return "double";
+			case ReturnType::Int4: return "int4";
+			case ReturnType::Int8: return "int8";
+			case ReturnType::Float4: return "float4";
+			case ReturnType::Float8: return "float8";
 		}
 	}
 
@@ -19,6 +25,21 @@ namespace declaration {
 			case VarType::Int: return "int";
 			case VarType::Float: return "float";
 			case VarType::Bool: return "bool";
+			case VarType::Long: return "long";
+			case VarType::Double: return "double";
+			case VarType::Int4: return "int4";
+			case VarType::Int8: return "int8";
+			case VarType::Float4: return "float4";
+			case VarType::Float8: return "float8";
+			case VarType::IntArray: return "int[]";
+			case VarType::FloatArray: return "float[]";
+			case VarType::BoolArray: return "bool[]";
+			case VarType::LongArray: return "long[]";
+			case VarType::DoubleArray: return "double[]";
+			case VarType::Int4Array: return "int4[]";
+			case VarType::Int8Array: return "int8[]";
+			case VarType::Float4Array: return "float4[]";
+			case VarType::Float8Array: return "float8[]";
 		}
 	}
 
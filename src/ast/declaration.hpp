@@ -15,6 +15,8 @@ namespace declaration {
 
 	
 	struct Param : public ASTNode {
+		Param() noexcept : ASTNode(NodeKind::Param) {}
+
 		VarType type;
 		std::string name;
 
@@ -22,9 +24,13 @@ namespace declaration {
 	};
 
 	class Declaration : public ASTNode {
+	public:
+		Declaration(NodeKind kind) noexcept : ASTNode(kind) {}
 	};
 
 	struct ExternDecl : public Declaration {
+		ExternDecl() noexcept : Declaration(NodeKind::ExternDecl) {}
+
 		ReturnType return_type;
 		std::string name;
 		std::forward_list<std::unique_ptr<Param>> params;
@@ -35,17 +41,37 @@ namespace declaration {
 	};
 
 	struct VarDecl : public Declaration {
+		VarDecl() noexcept : Declaration(NodeKind::VarDecl) {}
+
 		VarType type;
 		std::string name;
-		
+		unsigned int array_size = 0; // the number of elements, if type is an array type
+		bool is_const = false; // declared "const", so never assigned after being initialized
+
+		// A global's initial value, or for an array its first elements, the rest being zero. Empty for a
+		// global initialized to zero, as every global is by default, and for a local variable.
+		std::forward_list<std::unique_ptr<Expr>> initializer;
+		size_t initializer_begin = 0; // token range of the initializer, after the "="
+		size_t initializer_end = 0;
+
+		// Annotation filled in by the TypeChecker: the value of each expression in initializer
+		mutable std::vector<ConstantValue> initial_values;
+		unsigned int line_num = 0;
+		unsigned int column_num = 0;
+
 		void accept_visitor(ASTVisitor& visitor) override;
 	};
 
 	struct FuncDecl : public Declaration {
+		FuncDecl() noexcept : Declaration(NodeKind::FuncDecl) {}
+
 		ReturnType return_type;
 		std::string name;
 		std::forward_list<std::unique_ptr<Param>> params;
-		std::unique_ptr<Block> body;
+		std::unique_ptr<Block> body; // nullptr until parsed when the parser defers bodies
+		size_t body_begin = 0; // token range of the body, including the braces
+		size_t body_end = 0;
+		bool is_inline = false; // declared with the "inline" keyword
 		unsigned int line_num;
 		unsigned int column_num;
 
@@ -53,6 +79,8 @@ namespace declaration {
 	};
 
 	struct Program : public ASTNode {
+		Program() noexcept : ASTNode(NodeKind::Program) {}
+
 		std::forward_list<std::unique_ptr<ExternDecl>> externs;
 		std::forward_list<std::unique_ptr<Declaration>> decls;
 
@@ -8,12 +8,14 @@ namespace ast {
 namespace expr {
 
 	UnaryExpr::UnaryExpr(UnaryOp op, std::unique_ptr<Expr> operand, unsigned int line_num, unsigned int column_num) noexcept :
+		Expr(NodeKind::UnaryExpr),
 		op(op),
 		operand(std::move(operand)),
 		line_num(line_num),
 		column_num(column_num) { }
 
 	BinaryExpr::BinaryExpr(BinaryOp op, std::unique_ptr<Expr> first_operand, std::unique_ptr<Expr> second_operand, unsigned int line_num, unsigned int column_num) noexcept :
+		Expr(NodeKind::BinaryExpr),
 		op(op),
 		first_operand(std::move(first_operand)),
 		second_operand(std::move(second_operand)),
@@ -21,21 +23,32 @@ namespace expr {
 		column_num(column_num) { }
 
 	IdentifierExpr::IdentifierExpr(std::string&& name, unsigned int line_num, unsigned int column_num) noexcept :
+		Expr(NodeKind::IdentifierExpr),
 		name(std::move(name)),
 		line_num(line_num),
 		column_num(column_num) { }
 
-	IntExpr::IntExpr(int value, unsigned int line_num, unsigned int column_num) noexcept :
+	IndexExpr::IndexExpr(std::string&& name, std::unique_ptr<Expr> index, unsigned int line_num, unsigned int column_num) noexcept :
+		Expr(NodeKind::IndexExpr),
+		name(std::move(name)),
+		index(std::move(index)),
+		line_num(line_num),
+		column_num(column_num) { }
+
+	IntExpr::IntExpr(int64_t value, unsigned int line_num, unsigned int column_num) noexcept :
+		Expr(NodeKind::IntExpr),
 		value(value),
 		line_num(line_num),
 		column_num(column_num) { }
 
-	FloatExpr::FloatExpr(float value, unsigned int line_num, unsigned int column_num) noexcept :
+	FloatExpr::FloatExpr(double value, unsigned int line_num, unsigned int column_num) noexcept :
+		Expr(NodeKind::FloatExpr),
 		value(value),
 		line_num(line_num),
 		column_num(column_num) { }
 
 	BoolExpr::BoolExpr(bool value, unsigned int line_num, unsigned int column_num) noexcept :
+		Expr(NodeKind::BoolExpr),
 		value(value),
 		line_num(line_num),
 		column_num(column_num) { }
@@ -48,12 +61,21 @@ namespace expr {
 			case BinaryOp::Minus:
 				return {
 					FuncType::binary(VarType::Int, VarType::Int, ReturnType::Int),
-					FuncType::binary(VarType::Float, VarType::Float, ReturnType::Float)
+					FuncType::binary(VarType::Long, VarType::Long, ReturnType::Long),
+					FuncType::binary(VarType::Float, VarType::Float, ReturnType::Float),
+					FuncType::binary(VarType::Double, VarType::Double, ReturnType::Double),
+					FuncType::binary(VarType::Int4, VarType::Int4, ReturnType::Int4),
+					FuncType::binary(VarType::Int8, VarType::Int8, ReturnType::Int8),
+					FuncType::binary(VarType::Float4, VarType::Float4, ReturnType::Float4),
+					FuncType::binary(VarType::Float8, VarType::Float8, ReturnType::Float8)
 				};
 
 			case BinaryOp::Modulo:
 				return {
-					FuncType::binary(VarType::Int, VarType::Int, ReturnType::Int)
+					FuncType::binary(VarType::Int, VarType::Int, ReturnType::Int),
+					FuncType::binary(VarType::Long, VarType::Long, ReturnType::Long),
+					FuncType::binary(VarType::Int4, VarType::Int4, ReturnType::Int4),
+					FuncType::binary(VarType::Int8, VarType::Int8, ReturnType::Int8)
 				};
 
 			case BinaryOp::Less:
@@ -62,14 +84,18 @@ namespace expr {
 			case BinaryOp::GreaterEqual:
 				return {
 					FuncType::binary(VarType::Int, VarType::Int, ReturnType::Bool),
-					FuncType::binary(VarType::Float, VarType::Float, ReturnType::Bool)
+					FuncType::binary(VarType::Long, VarType::Long, ReturnType::Bool),
+					FuncType::binary(VarType::Float, VarType::Float, ReturnType::Bool),
+					FuncType::binary(VarType::Double, VarType::Double, ReturnType::Bool)
 				};
 
 			case BinaryOp::Equals:
 			case BinaryOp::NotEquals:
 				return {
 					FuncType::binary(VarType::Int, VarType::Int, ReturnType::Bool),
+					FuncType::binary(VarType::Long, VarType::Long, ReturnType::Bool),
 					FuncType::binary(VarType::Float, VarType::Float, ReturnType::Bool),
+					FuncType::binary(VarType::Double, VarType::Double, ReturnType::Bool),
 					FuncType::binary(VarType::Bool, VarType::Bool, ReturnType::Bool),
 				};
 
@@ -178,6 +204,10 @@ namespace expr {
 		visitor.visit_identifier_expr(*this);
 	}
 
+	void IndexExpr::accept_visitor(ASTVisitor& visitor) {
+		visitor.visit_index_expr(*this);
+	}
+
 	void FuncCallExpr::accept_visitor(ASTVisitor& visitor) {
 		visitor.visit_func_call_expr(*this);
 	}
@@ -195,29 +225,32 @@ namespace expr {
 	}
 	
 	
-	unsigned int UnaryExpr::get_line_num() { return this->line_num; }
-	unsigned int UnaryExpr::get_column_num() { return this->column_num; }
+	unsigned int UnaryExpr::get_line_num() const { return this->line_num; }
+	unsigned int UnaryExpr::get_column_num() const { return this->column_num; }
+
+	unsigned int BinaryExpr::get_line_num() const { return this->line_num; }
+	unsigned int BinaryExpr::get_column_num() const { return this->column_num; }
 
-	unsigned int BinaryExpr::get_line_num() { return this->line_num; }
-	unsigned int BinaryExpr::get_column_num() { return this->column_num; }
+	unsigned int AssignExpr::get_line_num() const { return this->line_num; }
+	unsigned int AssignExpr::get_column_num() const { return this->column_num; }
 
-	unsigned int AssignExpr::get_line_num() { return this->line_num; }
-	unsigned int AssignExpr::get_column_num() { return this->column_num; }
+	unsigned int IdentifierExpr::get_line_num() const { return this->line_num; }
+	unsigned int IdentifierExpr::get_column_num() const { return this->column_num; }
 
-	unsigned int IdentifierExpr::get_line_num() { return this->line_num; }
-	unsigned int IdentifierExpr::get_column_num() { return this->column_num; }
+	unsigned int IndexExpr::get_line_num() const { return this->line_num; }
+	unsigned int IndexExpr::get_column_num() const { return this->column_num; }
 
-	unsigned int FuncCallExpr::get_line_num() { return this->line_num; }
-	unsigned int FuncCallExpr::get_column_num() { return this->column_num; }
+	unsigned int FuncCallExpr::get_line_num() const { return this->line_num; }
+	unsigned int FuncCallExpr::get_column_num() const { return this->column_num; }
 
-	unsigned int IntExpr::get_line_num() { return this->line_num; }
-	unsigned int IntExpr::get_column_num() { return this->column_num; }
+	unsigned int IntExpr::get_line_num() const { return this->line_num; }
+	unsigned int IntExpr::get_column_num() const { return this->column_num; }
 
-	unsigned int FloatExpr::get_line_num() { return this->line_num; }
-	unsigned int FloatExpr::get_column_num() { return this->column_num; }
+	unsigned int FloatExpr::get_line_num() const { return this->line_num; }
+	unsigned int FloatExpr::get_column_num() const { return this->column_num; }
 
-	unsigned int BoolExpr::get_line_num() { return this->line_num; }
-	unsigned int BoolExpr::get_column_num() { return this->column_num; }
+	unsigned int BoolExpr::get_line_num() const { return this->line_num; }
+	unsigned int BoolExpr::get_column_num() const { return this->column_num; }
 
 }
 }
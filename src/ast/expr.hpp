@@ -48,15 +48,21 @@ namespace expr {
 	const char* unary_op_to_str(UnaryOp op);
 
 	struct Expr : public ASTNode {
-		virtual unsigned int get_line_num() = 0;
-		virtual unsigned int get_column_num() = 0;
+		Expr(NodeKind kind) noexcept : ASTNode(kind) {}
+		virtual unsigned int get_line_num() const = 0;
+		virtual unsigned int get_column_num() const = 0;
+
+		// Annotations filled in by the TypeChecker. "type" is the type the expression evaluates to
+		// (none for calls to void functions), "coerced_type" is the type the parent expression uses it as.
+		mutable boost::optional<VarType> type;
+		mutable boost::optional<VarType> coerced_type;
 	};
 
 	struct UnaryExpr : public Expr {
 		UnaryExpr(UnaryOp op, std::unique_ptr<Expr> operand, unsigned int line_num, unsigned int column_num) noexcept;
 		void accept_visitor(ASTVisitor& visitor) override;
-		unsigned int get_line_num() override;
-		unsigned int get_column_num() override;
+		unsigned int get_line_num() const override;
+		unsigned int get_column_num() const override;
 
 		UnaryOp op;
 		std::unique_ptr<Expr> operand;
@@ -69,8 +75,8 @@ namespace expr {
 		void accept_visitor(ASTVisitor& visitor) override;
 		unsigned int line_num;
 		unsigned int column_num;
-		unsigned int get_line_num() override;
-		unsigned int get_column_num() override;
+		unsigned int get_line_num() const override;
+		unsigned int get_column_num() const override;
 
 		BinaryOp op;
 		std::unique_ptr<Expr> first_operand;
@@ -78,11 +84,13 @@ namespace expr {
 	};
 
 	struct AssignExpr : public Expr {
+		AssignExpr() noexcept : Expr(NodeKind::AssignExpr) {}
 		void accept_visitor(ASTVisitor& visitor) override;
-		unsigned int get_line_num() override;
-		unsigned int get_column_num() override;
+		unsigned int get_line_num() const override;
+		unsigned int get_column_num() const override;
 
 		std::string name;
+		std::unique_ptr<Expr> index; // nullptr, unless assigning to an element of the array "name"
 		std::unique_ptr<Expr> expr;
 		unsigned int line_num;
 		unsigned int column_num;
@@ -91,18 +99,32 @@ namespace expr {
 	struct IdentifierExpr : public Expr {
 		IdentifierExpr(std::string&& name, unsigned int line_num, unsigned int column_num) noexcept;
 		void accept_visitor(ASTVisitor& visitor) override;
-		unsigned int get_line_num() override;
-		unsigned int get_column_num() override;
+		unsigned int get_line_num() const override;
+		unsigned int get_column_num() const override;
 
 		std::string name;
 		unsigned int line_num;
 		unsigned int column_num;
 	};
 
+	// An element of an array variable, as in "name[index]"
+	struct IndexExpr : public Expr {
+		IndexExpr(std::string&& name, std::unique_ptr<Expr> index, unsigned int line_num, unsigned int column_num) noexcept;
+		void accept_visitor(ASTVisitor& visitor) override;
+		unsigned int get_line_num() const override;
+		unsigned int get_column_num() const override;
+
+		std::string name;
+		std::unique_ptr<Expr> index;
+		unsigned int line_num;
+		unsigned int column_num;
+	};
+
 	struct FuncCallExpr : public Expr {
+		FuncCallExpr() noexcept : Expr(NodeKind::FuncCallExpr) {}
 		void accept_visitor(ASTVisitor& visitor) override;
-		unsigned int get_line_num() override;
-		unsigned int get_column_num() override;
+		unsigned int get_line_num() const override;
+		unsigned int get_column_num() const override;
 
 		std::string func_name;
 		std::forward_list<std::unique_ptr<Expr>> params;
@@ -111,23 +133,23 @@ namespace expr {
 	};
 
 	struct IntExpr : public Expr {
-		IntExpr(int value, unsigned int line_num, unsigned int column_num) noexcept;
+		IntExpr(int64_t value, unsigned int line_num, unsigned int column_num) noexcept;
 		void accept_visitor(ASTVisitor& visitor) override;
-		unsigned int get_line_num() override;
-		unsigned int get_column_num() override;
+		unsigned int get_line_num() const override;
+		unsigned int get_column_num() const override;
 
-		int value;
+		int64_t value;
 		unsigned int line_num;
 		unsigned int column_num;
 	};
 
 	struct FloatExpr : public Expr {
-		FloatExpr(float value, unsigned int line_num, unsigned int column_num) noexcept;
+		FloatExpr(double value, unsigned int line_num, unsigned int column_num) noexcept;
 		void accept_visitor(ASTVisitor& visitor) override;
-		unsigned int get_line_num() override;
-		unsigned int get_column_num() override;
+		unsigned int get_line_num() const override;
+		unsigned int get_column_num() const override;
 
-		float value;
+		double value;
 		unsigned int line_num;
 		unsigned int column_num;
 	};
@@ -135,8 +157,8 @@ namespace expr {
 	struct BoolExpr : public Expr {
 		BoolExpr(bool value, unsigned int line_num, unsigned int column_num) noexcept;
 		void accept_visitor(ASTVisitor& visitor) override;
-		unsigned int get_line_num() override;
-		unsigned int get_column_num() override;
+		unsigned int get_line_num() const override;
+		unsigned int get_column_num() const override;
 
 		bool value;
 		unsigned int line_num;
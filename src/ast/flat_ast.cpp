@@ -0,0 +1,305 @@
+#include "flat_ast.hpp"
+#include "static_visitor.hpp"
+#include <cstring>
+
+namespace ast {
+namespace flat {
+
+	size_t FlatAst::size() const {
+		return this->kinds.size();
+	}
+
+	const std::string& FlatAst::name(NodeId node) const {
+		return this->names[this->values[node]];
+	}
+
+	int64_t FlatAst::int_value(NodeId node) const {
+		return static_cast<int64_t>(this->values[node]);
+	}
+
+	double FlatAst::float_value(NodeId node) const {
+		double f;
+		std::memcpy(&f, &this->values[node], sizeof(f));
+		return f;
+	}
+
+	bool FlatAst::bool_value(NodeId node) const {
+		return this->values[node] != 0;
+	}
+
+	uint8_t encode_type(const boost::optional<VarType>& type) {
+		return type ? static_cast<uint8_t>(*type) : NO_TYPE;
+	}
+
+	// Appends nodes in pre-order. Each visit_* leaves the id of the node it created in "result".
+	class Flattener : public StaticVisitor<Flattener> {
+	public:
+		Flattener(FlatAst& ast) : ast(ast) { }
+
+		NodeId flatten(const ASTNode& node) {
+			this->dispatch(node);
+			return this->result;
+		}
+
+		template <typename T>
+		NodeId flatten_list(const std::forward_list<std::unique_ptr<T>>& list) {
+			NodeId head = NO_NODE;
+			NodeId prev = NO_NODE;
+
+			for (auto& node : list) {
+				NodeId id = this->flatten(*node);
+				if (prev == NO_NODE) {
+					head = id;
+				} else {
+					this->ast.next[prev] = id;
+				}
+				prev = id;
+			}
+
+			return head;
+		}
+
+		NodeId flatten_params(const std::forward_list<std::unique_ptr<Param>>& params) {
+			NodeId head = NO_NODE;
+			NodeId prev = NO_NODE;
+
+			for (auto& param : params) {
+				NodeId id = this->add_node(NodeKind::Param, 0, 0);
+				this->ast.values[id] = this->intern(param->name);
+				this->ast.types[id] = static_cast<uint8_t>(param->type);
+				this->finish(id);
+
+				if (prev == NO_NODE) {
+					head = id;
+				} else {
+					this->ast.next[prev] = id;
+				}
+				prev = id;
+			}
+
+			return head;
+		}
+
+		// Children are flattened into locals before being stored, as appending them may reallocate the
+		// arrays and invalidate any reference taken beforehand
+		void visit_program(const Program& program) {
+			NodeId id = this->add_node(NodeKind::Program, 0, 0);
+			NodeId externs = this->flatten_list(program.externs);
+			NodeId decls = this->flatten_list(program.decls);
+			this->ast.first[id] = externs;
+			this->ast.second[id] = decls;
+			this->finish(id);
+		}
+
+		void visit_extern_decl(const ExternDecl& extern_decl) {
+			NodeId id = this->add_node(NodeKind::ExternDecl, extern_decl.line_num, extern_decl.column_num);
+			this->ast.values[id] = this->intern(extern_decl.name);
+			this->ast.types[id] = static_cast<uint8_t>(extern_decl.return_type);
+			NodeId params = this->flatten_params(extern_decl.params);
+			this->ast.first[id] = params;
+			this->finish(id);
+		}
+
+		void visit_var_decl(const VarDecl& decl) {
+			NodeId id = this->add_node(NodeKind::VarDecl, decl.line_num, decl.column_num);
+			this->ast.values[id] = this->intern(decl.name);
+			this->ast.types[id] = static_cast<uint8_t>(decl.type);
+			this->ast.flags[id] = decl.is_const ? FLAG_CONST : 0;
+			if (is_array_type(decl.type)) {
+				this->ast.second[id] = decl.array_size;
+			}
+			NodeId initializer = this->flatten_list(decl.initializer);
+			this->ast.first[id] = initializer;
+			this->finish(id);
+		}
+
+		void visit_func_decl(const FuncDecl& decl) {
+			NodeId id = this->add_node(NodeKind::FuncDecl, decl.line_num, decl.column_num);
+			this->ast.values[id] = this->intern(decl.name);
+			this->ast.types[id] = static_cast<uint8_t>(decl.return_type);
+			this->ast.flags[id] = decl.is_inline ? FLAG_INLINE : 0;
+			NodeId params = this->flatten_params(decl.params);
+			NodeId body = decl.body != nullptr ? this->flatten(*decl.body) : NO_NODE;
+			this->ast.first[id] = params;
+			this->ast.second[id] = body;
+			this->finish(id);
+		}
+
+		void visit_block(const Block& block) {
+			NodeId id = this->add_node(NodeKind::Block, 0, 0);
+			NodeId var_decls = this->flatten_list(block.var_decls);
+			NodeId statements = this->flatten_list(block.statements);
+			this->ast.first[id] = var_decls;
+			this->ast.second[id] = statements;
+			this->finish(id);
+		}
+
+		void visit_local_decl(const VarDecl& local_decl) {
+			this->visit_var_decl(local_decl);
+		}
+
+		void visit_expr_stmt(const ExprStmt& expr_stmt) {
+			NodeId id = this->add_node(NodeKind::ExprStmt, 0, 0);
+			if (expr_stmt.expr != nullptr) {
+				NodeId expr = this->flatten(*expr_stmt.expr);
+				this->ast.first[id] = expr;
+			}
+			this->finish(id);
+		}
+
+		void visit_return_stmt(const Return& ret_stmt) {
+			NodeId id = this->add_node(NodeKind::Return, ret_stmt.line_num, ret_stmt.column_num);
+			if (ret_stmt.return_val != nullptr) {
+				NodeId return_val = this->flatten(*ret_stmt.return_val);
+				this->ast.first[id] = return_val;
+			}
+			this->finish(id);
+		}
+
+		void visit_if_else_stmt(const IfElse& if_else_stmt) {
+			NodeId id = this->add_node(NodeKind::IfElse, if_else_stmt.line_num, if_else_stmt.column_num);
+			NodeId cond = this->flatten(*if_else_stmt.cond);
+			NodeId if_true = this->flatten(*if_else_stmt.if_true);
+			NodeId if_false = if_else_stmt.if_false != nullptr ? this->flatten(*if_else_stmt.if_false) : NO_NODE;
+			this->ast.first[id] = cond;
+			this->ast.second[id] = if_true;
+			this->ast.third[id] = if_false;
+			this->finish(id);
+		}
+
+		void visit_while_stmt(const While& while_stmt) {
+			NodeId id = this->add_node(NodeKind::While, while_stmt.line_num, while_stmt.column_num);
+			NodeId cond = this->flatten(*while_stmt.cond);
+			NodeId body = this->flatten(*while_stmt.body);
+			this->ast.first[id] = cond;
+			this->ast.second[id] = body;
+			this->finish(id);
+		}
+
+		void visit_unary_expr(const UnaryExpr& unary_expr) {
+			NodeId id = this->add_expr(unary_expr, NodeKind::UnaryExpr);
+			this->ast.values[id] = static_cast<uint32_t>(unary_expr.op);
+			NodeId operand = this->flatten(*unary_expr.operand);
+			this->ast.first[id] = operand;
+			this->finish(id);
+		}
+
+		void visit_binary_expr(const BinaryExpr& binary_expr) {
+			NodeId id = this->add_expr(binary_expr, NodeKind::BinaryExpr);
+			this->ast.values[id] = static_cast<uint32_t>(binary_expr.op);
+			NodeId lhs = this->flatten(*binary_expr.first_operand);
+			NodeId rhs = this->flatten(*binary_expr.second_operand);
+			this->ast.first[id] = lhs;
+			this->ast.second[id] = rhs;
+			this->finish(id);
+		}
+
+		void visit_assign_expr(const AssignExpr& assign_expr) {
+			NodeId id = this->add_expr(assign_expr, NodeKind::AssignExpr);
+			this->ast.values[id] = this->intern(assign_expr.name);
+			NodeId index = assign_expr.index != nullptr ? this->flatten(*assign_expr.index) : NO_NODE;
+			NodeId expr = this->flatten(*assign_expr.expr);
+			this->ast.first[id] = expr;
+			this->ast.second[id] = index;
+			this->finish(id);
+		}
+
+		void visit_identifier_expr(const IdentifierExpr& identifier_expr) {
+			NodeId id = this->add_expr(identifier_expr, NodeKind::IdentifierExpr);
+			this->ast.values[id] = this->intern(identifier_expr.name);
+			this->finish(id);
+		}
+
+		void visit_index_expr(const IndexExpr& index_expr) {
+			NodeId id = this->add_expr(index_expr, NodeKind::IndexExpr);
+			this->ast.values[id] = this->intern(index_expr.name);
+			NodeId index = this->flatten(*index_expr.index);
+			this->ast.first[id] = index;
+			this->finish(id);
+		}
+
+		void visit_func_call_expr(const FuncCallExpr& func_call_expr) {
+			NodeId id = this->add_expr(func_call_expr, NodeKind::FuncCallExpr);
+			this->ast.values[id] = this->intern(func_call_expr.func_name);
+			NodeId args = this->flatten_list(func_call_expr.params);
+			this->ast.first[id] = args;
+			this->finish(id);
+		}
+
+		void visit_int_expr(const IntExpr& int_expr) {
+			NodeId id = this->add_expr(int_expr, NodeKind::IntExpr);
+			this->ast.values[id] = static_cast<uint64_t>(int_expr.value);
+			this->finish(id);
+		}
+
+		void visit_float_expr(const FloatExpr& float_expr) {
+			NodeId id = this->add_expr(float_expr, NodeKind::FloatExpr);
+			std::memcpy(&this->ast.values[id], &float_expr.value, sizeof(float_expr.value));
+			this->finish(id);
+		}
+
+		void visit_bool_expr(const BoolExpr& bool_expr) {
+			NodeId id = this->add_expr(bool_expr, NodeKind::BoolExpr);
+			this->ast.values[id] = bool_expr.value ? 1 : 0;
+			this->finish(id);
+		}
+
+	private:
+		NodeId add_node(NodeKind kind, unsigned int line_num, unsigned int column_num) {
+			NodeId id = this->ast.kinds.size();
+
+			this->ast.kinds.push_back(kind);
+			this->ast.first.push_back(NO_NODE);
+			this->ast.second.push_back(NO_NODE);
+			this->ast.third.push_back(NO_NODE);
+			this->ast.next.push_back(NO_NODE);
+			this->ast.end.push_back(NO_NODE);
+			this->ast.line_nums.push_back(line_num);
+			this->ast.column_nums.push_back(column_num);
+			this->ast.values.push_back(0);
+			this->ast.types.push_back(NO_TYPE);
+			this->ast.coerced_types.push_back(NO_TYPE);
+			this->ast.flags.push_back(0);
+
+			return id;
+		}
+
+		NodeId add_expr(const Expr& expr, NodeKind kind) {
+			NodeId id = this->add_node(kind, expr.get_line_num(), expr.get_column_num());
+			this->ast.types[id] = encode_type(expr.type);
+			this->ast.coerced_types[id] = encode_type(expr.coerced_type);
+			return id;
+		}
+
+		// Called once all of a node's children have been appended
+		void finish(NodeId id) {
+			this->ast.end[id] = this->ast.kinds.size();
+			this->result = id;
+		}
+
+		uint32_t intern(const std::string& name) {
+			auto it = this->name_ids.find(name);
+			if (it != this->name_ids.end()) {
+				return it->second;
+			}
+
+			uint32_t name_id = this->ast.names.size();
+			this->ast.names.push_back(name);
+			this->name_ids.insert({ name, name_id });
+			return name_id;
+		}
+
+		FlatAst& ast;
+		NodeId result = NO_NODE;
+		std::unordered_map<std::string, uint32_t> name_ids;
+	};
+
+	FlatAst flatten(const Program& program) {
+		FlatAst ast;
+		Flattener flattener(ast);
+		flattener.flatten(program);
+		return ast;
+	}
+
+}
+}
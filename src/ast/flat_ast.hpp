@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "ast.hpp"
+#include "declaration.hpp"
+
+namespace ast {
+namespace flat {
+
+	using NodeId = uint32_t;
+	const NodeId NO_NODE = UINT32_MAX;
+	const uint8_t NO_TYPE = UINT8_MAX;
+
+	// Bits of FlatAst::flags
+	const uint8_t FLAG_INLINE = 1; // a FuncDecl declared "inline"
+	const uint8_t FLAG_CONST = 2; // a VarDecl declared "const"
+
+	// Structure-of-arrays copy of a Program. Every node is identified by its index into the parallel
+	// arrays below, and nodes are numbered in pre-order, so the subtree rooted at n is exactly the
+	// contiguous range [n, end[n]). Whole-program passes can therefore scan a function (or the whole
+	// program) linearly instead of chasing pointers.
+	//
+	// Meaning of the per-node fields by kind:
+	//   Program          first: first extern, second: first declaration
+	//   ExternDecl       value: name, type: return type, first: first param
+	//   FuncDecl         value: name, type: return type, first: first param, second: body (if parsed)
+	//   VarDecl          value: name, type: variable type, first: first initializer expression,
+	//                    second: number of elements (arrays only)
+	//   Param            value: name, type: variable type
+	//   Block            first: first local declaration, second: first statement
+	//   IfElse           first: condition, second: if true block, third: if false block
+	//   While            first: condition, second: body
+	//   Return           first: return value
+	//   ExprStmt         first: expression
+	//   UnaryExpr        value: UnaryOp, first: operand
+	//   BinaryExpr       value: BinaryOp, first: lhs, second: rhs
+	//   AssignExpr       value: name, first: right hand side, second: index (element assignments only)
+	//   IdentifierExpr   value: name
+	//   IndexExpr        value: array name, first: index
+	//   FuncCallExpr     value: function name, first: first argument
+	//   Int/Float/BoolExpr  value: bit pattern of the literal
+	// Lists (params, declarations, statements, arguments) are chained through "next". Names are indices
+	// into "names". For expressions, "type" and "coerced_type" hold the TypeChecker's annotations. The
+	// qualifiers of declarations are bits in "flags".
+	struct FlatAst {
+		std::vector<NodeKind> kinds;
+		std::vector<NodeId> first;
+		std::vector<NodeId> second;
+		std::vector<NodeId> third;
+		std::vector<NodeId> next;
+		std::vector<NodeId> end;
+		std::vector<uint32_t> line_nums;
+		std::vector<uint32_t> column_nums;
+		std::vector<uint64_t> values;
+		std::vector<uint8_t> types;
+		std::vector<uint8_t> coerced_types;
+		std::vector<uint8_t> flags;
+
+		std::vector<std::string> names;
+
+		size_t size() const;
+		const std::string& name(NodeId node) const;
+		int64_t int_value(NodeId node) const;
+		double float_value(NodeId node) const;
+		bool bool_value(NodeId node) const;
+	};
+
+	FlatAst flatten(const ast::declaration::Program& program);
+
+}
+}
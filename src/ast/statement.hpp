@@ -17,9 +17,12 @@ namespace statement {
 	using namespace ast::declaration;
 
 	struct Statement : public ASTNode {
+		Statement(NodeKind kind) noexcept : ASTNode(kind) {}
 	};
 
 	struct Block : public Statement {
+		Block() noexcept : Statement(NodeKind::Block) {}
+
 		std::forward_list<std::unique_ptr<VarDecl>> var_decls;
 		std::forward_list<std::unique_ptr<Statement>> statements;
 
@@ -27,6 +30,8 @@ namespace statement {
 	};
 
 	struct IfElse : public Statement {
+		IfElse() noexcept : Statement(NodeKind::IfElse) {}
+
 		std::unique_ptr<Expr> cond;
 		std::unique_ptr<Block> if_true;
 		std::unique_ptr<Block> if_false; // potentially nullptr
@@ -37,6 +42,8 @@ namespace statement {
 	};
 
 	struct While : public Statement {
+		While() noexcept : Statement(NodeKind::While) {}
+
 		std::unique_ptr<Expr> cond;
 		std::unique_ptr<Statement> body;
 		unsigned int line_num;
@@ -46,6 +53,8 @@ namespace statement {
 	};
 
 	struct Return : public Statement {
+		Return() noexcept : Statement(NodeKind::Return) {}
+
 		std::unique_ptr<Expr> return_val; // potentially nullptr
 		unsigned int line_num;
 		unsigned int column_num;
@@ -54,6 +63,8 @@ namespace statement {
 	};
 
 	struct ExprStmt : public Statement {
+		ExprStmt() noexcept : Statement(NodeKind::ExprStmt) {}
+
 		std::unique_ptr<Expr> expr; //potentially nullptr
 
 		void accept_visitor(ASTVisitor& visitor) override;
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../ast/declaration.hpp"
+#include "../ast/statement.hpp"
+#include "../ast/expr.hpp"
+
+using namespace ast::declaration;
+using namespace ast::statement;
+using namespace ast::expr;
+
+// CRTP counterpart to ASTVisitor. Instead of the two virtual calls made by accept_visitor and visit_*,
+// dispatch() switches on the node's kind tag and calls Derived's (non-virtual) visit_* method directly,
+// so the compiler is free to inline the traversal. Derived must provide the same visit_* methods as an
+// ASTVisitor.
+template <typename Derived>
+class StaticVisitor {
+public:
+	void dispatch(const ASTNode& node) {
+		Derived& self = static_cast<Derived&>(*this);
+
+		switch (node.kind) {
+			case NodeKind::Program: return self.visit_program(static_cast<const Program&>(node));
+			case NodeKind::ExternDecl: return self.visit_extern_decl(static_cast<const ExternDecl&>(node));
+			case NodeKind::VarDecl: return self.visit_var_decl(static_cast<const VarDecl&>(node));
+			case NodeKind::FuncDecl: return self.visit_func_decl(static_cast<const FuncDecl&>(node));
+			case NodeKind::Param: return;
+			case NodeKind::Block: return self.visit_block(static_cast<const Block&>(node));
+			case NodeKind::IfElse: return self.visit_if_else_stmt(static_cast<const IfElse&>(node));
+			case NodeKind::While: return self.visit_while_stmt(static_cast<const While&>(node));
+			case NodeKind::Return: return self.visit_return_stmt(static_cast<const Return&>(node));
+			case NodeKind::ExprStmt: return self.visit_expr_stmt(static_cast<const ExprStmt&>(node));
+			case NodeKind::UnaryExpr: return self.visit_unary_expr(static_cast<const UnaryExpr&>(node));
+			case NodeKind::BinaryExpr: return self.visit_binary_expr(static_cast<const BinaryExpr&>(node));
+			case NodeKind::AssignExpr: return self.visit_assign_expr(static_cast<const AssignExpr&>(node));
+			case NodeKind::IdentifierExpr: return self.visit_identifier_expr(static_cast<const IdentifierExpr&>(node));
+			case NodeKind::IndexExpr: return self.visit_index_expr(static_cast<const IndexExpr&>(node));
+			case NodeKind::FuncCallExpr: return self.visit_func_call_expr(static_cast<const FuncCallExpr&>(node));
+			case NodeKind::IntExpr: return self.visit_int_expr(static_cast<const IntExpr&>(node));
+			case NodeKind::FloatExpr: return self.visit_float_expr(static_cast<const FloatExpr&>(node));
+			case NodeKind::BoolExpr: return self.visit_bool_expr(static_cast<const BoolExpr&>(node));
+		}
+	}
+};
@@ -1,5 +1,6 @@
 #include "tree_printer.hpp"
 #include "declaration.hpp"
+#include <iostream>
 
 using ast::declaration::var_type_to_str;
 using ast::declaration::return_type_to_str;
@@ -16,6 +17,28 @@ std::string TreePrinter::indent_str() const {
 	return result;
 }
 
+std::string TreePrinter::type_str(const Expr& expr) const {
+	// Only present once the TypeChecker has annotated the tree
+	if (!expr.type) {
+		return "";
+	}
+
+	std::string result = std::string(", type: ") + var_type_to_str(*expr.type);
+	if (expr.coerced_type && *expr.coerced_type != *expr.type) {
+		result += std::string(", coerced_to: ") + var_type_to_str(*expr.coerced_type);
+	}
+
+	return result;
+}
+
+std::string TreePrinter::array_size_str(const VarDecl& decl) const {
+	if (!is_array_type(decl.type)) {
+		return "";
+	}
+
+	return ", size: " + std::to_string(decl.array_size);
+}
+
 void TreePrinter::print_param(const Param& param) {
 	std::cout
 		<< this->indent_str()
@@ -38,11 +61,11 @@ void TreePrinter::visit_program(const Program& program) {
 	this->indent_level++;
 
 		for (auto& ext : program.externs) {
-			ext->accept_visitor(*this);
+			this->dispatch(*ext);
 		}
 
 		for (auto& decl : program.decls) {
-			decl->accept_visitor(*this);
+			this->dispatch(*decl);
 		}
 
 	this->indent_level--;
@@ -75,8 +98,18 @@ void TreePrinter::visit_var_decl(const VarDecl& decl) {
 		<< "+- var_decl { "
 		<< "type: " << var_type_to_str(decl.type) << ", "
 		<< "name: " << decl.name
+		<< this->array_size_str(decl)
+		<< (decl.is_const ? ", const" : "")
 		<< " }"
 		<< std::endl;
+
+	this->indent_level++;
+
+	for (auto& expr : decl.initializer) {
+		this->dispatch(*expr);
+	}
+
+	this->indent_level--;
 }
 
 void TreePrinter::visit_func_decl(const FuncDecl& decl) {
@@ -87,6 +120,7 @@ void TreePrinter::visit_func_decl(const FuncDecl& decl) {
 		<< "+- function { "
 		<< "name: " << decl.name << ", "
 		<< "return_type: " << return_type_to_str(decl.return_type)
+		<< (decl.is_inline ? ", inline" : "")
 		<< " }"
 		<< std::endl;
 
@@ -96,7 +130,9 @@ void TreePrinter::visit_func_decl(const FuncDecl& decl) {
 			this->print_param(*param);
 		}
 
-		decl.body->accept_visitor(*this);
+		if (decl.body != nullptr) {
+			this->dispatch(*decl.body);
+		}
 
 	this->indent_level--;
 }
@@ -112,11 +148,11 @@ void TreePrinter::visit_block(const Block& block) {
 	this->indent_level++;
 	
 	for (auto& var_decl : block.var_decls) {
-		var_decl->accept_visitor(*this);
+		this->dispatch(*var_decl);
 	}
 
 	for (auto& stmt : block.statements) {
-		stmt->accept_visitor(*this);
+		this->dispatch(*stmt);
 	}
 
 	this->indent_level--;
@@ -130,6 +166,7 @@ void TreePrinter::visit_local_decl(const VarDecl& decl) {
 		<< "+- var_decl { "
 		<< "type: " << var_type_to_str(decl.type) << ", "
 		<< "name: " << decl.name
+		<< this->array_size_str(decl)
 		<< " }"
 		<< std::endl;
 }
@@ -145,7 +182,7 @@ void TreePrinter::visit_expr_stmt(const ExprStmt& expr_stmt) {
 	this->indent_level++;
 
 	if (expr_stmt.expr != nullptr) {
-		expr_stmt.expr->accept_visitor(*this);
+		this->dispatch(*expr_stmt.expr);
 	}
 
 	this->indent_level--;
@@ -160,7 +197,7 @@ void TreePrinter::visit_return_stmt(const Return& ret_stmt) {
 	this->indent_level++;
 
 	if (ret_stmt.return_val != nullptr) {
-		ret_stmt.return_val->accept_visitor(*this);
+		this->dispatch(*ret_stmt.return_val);
 	}
 
 	this->indent_level--;
@@ -181,7 +218,7 @@ void TreePrinter::visit_if_else_stmt(const IfElse& if_else_stmt) {
 			<< std::endl;
 		
 		this->indent_level++;
-		if_else_stmt.cond->accept_visitor(*this);
+		this->dispatch(*if_else_stmt.cond);
 		this->indent_level--;
 
 		// If true
@@ -191,7 +228,7 @@ void TreePrinter::visit_if_else_stmt(const IfElse& if_else_stmt) {
 			<< std::endl;
 
 		this->indent_level++;
-		if_else_stmt.if_true->accept_visitor(*this);
+		this->dispatch(*if_else_stmt.if_true);
 		this->indent_level--;
 
 		// If false
@@ -202,7 +239,7 @@ void TreePrinter::visit_if_else_stmt(const IfElse& if_else_stmt) {
 				<< std::endl;
 
 			this->indent_level++;
-			if_else_stmt.if_false->accept_visitor(*this);
+			this->dispatch(*if_else_stmt.if_false);
 			this->indent_level--;
 		}
 
@@ -224,7 +261,7 @@ void TreePrinter::visit_while_stmt(const While& while_stmt) {
 			<< std::endl;
 
 		this->indent_level++;
-			while_stmt.cond->accept_visitor(*this);
+			this->dispatch(*while_stmt.cond);
 		this->indent_level--;
 
 		// Body
@@ -234,7 +271,7 @@ void TreePrinter::visit_while_stmt(const While& while_stmt) {
 			<< std::endl;
 
 		this->indent_level++;
-			while_stmt.body->accept_visitor(*this);
+			this->dispatch(*while_stmt.body);
 		this->indent_level--;
 
 	this->indent_level--;
@@ -246,11 +283,12 @@ void TreePrinter::visit_unary_expr(const UnaryExpr& unary_expr) {
 		<< "+- unary_expr"
 		<< " { "
 		<< "op: " << unary_op_to_str(unary_expr.op)
+		<< this->type_str(unary_expr)
 		<< " }"
 		<< std::endl;
 	
 	this->indent_level++;
-		unary_expr.operand->accept_visitor(*this);
+		this->dispatch(*unary_expr.operand);
 	this->indent_level--;
 }
 
@@ -260,12 +298,13 @@ void TreePrinter::visit_binary_expr(const BinaryExpr& binary_expr) {
 		<< "+- binary_expr"
 		<< " { "
 		<< "op: " << binary_op_to_str(binary_expr.op)
+		<< this->type_str(binary_expr)
 		<< " }"
 		<< std::endl;
 
 	this->indent_level++;
-		binary_expr.first_operand->accept_visitor(*this);
-		binary_expr.second_operand->accept_visitor(*this);
+		this->dispatch(*binary_expr.first_operand);
+		this->dispatch(*binary_expr.second_operand);
 	this->indent_level--;
 }
 
@@ -275,11 +314,15 @@ void TreePrinter::visit_assign_expr(const AssignExpr& assign_expr) {
 		<< "+- assignment"
 		<< " { "
 		<< "name: " << assign_expr.name
+		<< this->type_str(assign_expr)
 		<< " }"
 		<< std::endl;
 
 	this->indent_level++;
-		assign_expr.expr->accept_visitor(*this);
+		if (assign_expr.index != nullptr) {
+			this->dispatch(*assign_expr.index);
+		}
+		this->dispatch(*assign_expr.expr);
 	this->indent_level--;
 }
 
@@ -289,8 +332,24 @@ void TreePrinter::visit_identifier_expr(const IdentifierExpr& identifier_expr) {
 		<< "+- identifier"
 		<< " { "
 		<< "name: " << identifier_expr.name
+		<< this->type_str(identifier_expr)
+		<< " }"
+		<< std::endl;
+}
+
+void TreePrinter::visit_index_expr(const IndexExpr& index_expr) {
+	std::cout
+		<< this->indent_str()
+		<< "+- index"
+		<< " { "
+		<< "name: " << index_expr.name
+		<< this->type_str(index_expr)
 		<< " }"
 		<< std::endl;
+
+	this->indent_level++;
+		this->dispatch(*index_expr.index);
+	this->indent_level--;
 }
 
 void TreePrinter::visit_func_call_expr(const FuncCallExpr& func_call_expr) {
@@ -299,12 +358,13 @@ void TreePrinter::visit_func_call_expr(const FuncCallExpr& func_call_expr) {
 		<< "+- func_call"
 		<< " { "
 		<< "func_name: " << func_call_expr.func_name
+		<< this->type_str(func_call_expr)
 		<< " }"
 		<< std::endl;
 
 	this->indent_level++;
 		for (auto& param : func_call_expr.params) {
-			param->accept_visitor(*this);
+			this->dispatch(*param);
 		}
 	this->indent_level--;
 }
@@ -315,6 +375,7 @@ void TreePrinter::visit_int_expr(const IntExpr& int_expr) {
 		<< "+- int"
 		<< " { "
 		<< "value: " << int_expr.value
+		<< this->type_str(int_expr)
 		<< " }"
 		<< std::endl;
 }
@@ -325,6 +386,7 @@ void TreePrinter::visit_float_expr(const FloatExpr& float_expr) {
 		<< "+- float"
 		<< " { "
 		<< "value: " << float_expr.value
+		<< this->type_str(float_expr)
 		<< " }"
 		<< std::endl;
 }
@@ -335,6 +397,7 @@ void TreePrinter::visit_bool_expr(const BoolExpr& bool_expr) {
 		<< "+- bool"
 		<< " { "
 		<< "value: " << bool_expr.value
+		<< this->type_str(bool_expr)
 		<< " }"
 		<< std::endl;
 }
@@ -3,6 +3,38 @@
 namespace ast {
 namespace type {
 
+bool is_array_type(VarType type) {
+	return (static_cast<unsigned int>(type) & ARRAY_TYPE_BIT) != 0;
+}
+
+VarType element_type(VarType array_type) {
+	return static_cast<VarType>(static_cast<unsigned int>(array_type) & ~ARRAY_TYPE_BIT);
+}
+
+VarType array_type(VarType element_type) {
+	return static_cast<VarType>(static_cast<unsigned int>(element_type) | ARRAY_TYPE_BIT);
+}
+
+bool is_vector_type(VarType type) {
+	switch (type) {
+		case VarType::Int4:
+		case VarType::Int8:
+		case VarType::Float4:
+		case VarType::Float8:
+			return true;
+		default:
+			return false;
+	}
+}
+
+VarType lane_type(VarType vector_type) {
+	return vector_type == VarType::Int4 || vector_type == VarType::Int8 ? VarType::Int : VarType::Float;
+}
+
+unsigned int lane_count(VarType vector_type) {
+	return vector_type == VarType::Int4 || vector_type == VarType::Float4 ? 4 : 8;
+}
+
 FuncType::FuncType(std::vector<VarType> param_types, ReturnType ret_type) :
 	param_types(param_types),
 	ret_type(ret_type) { }
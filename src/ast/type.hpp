@@ -1,21 +1,70 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
 namespace ast {
 namespace type {
 
+	// Each type has the same value as the ReturnType of the same name
 	enum class VarType {
 		Int = 0,
 		Float = 1,
-		Bool = 2
+		Bool = 2,
+		Long = 4,
+		Double = 5,
+
+		// SIMD vectors of 4 or 8 lanes, which are values like the scalar types. Arithmetic applies to
+		// each lane, and a scalar is converted to a vector by copying it into every lane.
+		Int4 = 16,
+		Int8 = 17,
+		Float4 = 18,
+		Float8 = 19,
+
+		// Fixed-size arrays of the types above, which are the element type with ARRAY_TYPE_BIT set. Only
+		// variables and parameters have array types: an array can be indexed, or passed to an array
+		// parameter, but is never a value of its own.
+		IntArray = 8,
+		FloatArray = 9,
+		BoolArray = 10,
+		LongArray = 12,
+		DoubleArray = 13,
+		Int4Array = 24,
+		Int8Array = 25,
+		Float4Array = 26,
+		Float8Array = 27
 	};
 
+	const unsigned int ARRAY_TYPE_BIT = 8;
+
+	bool is_array_type(VarType type);
+	VarType element_type(VarType array_type);
+	VarType array_type(VarType element_type);
+
+	bool is_vector_type(VarType type);
+	// The type of each lane of a vector type, and the number of lanes
+	VarType lane_type(VarType vector_type);
+	unsigned int lane_count(VarType vector_type);
+
 	enum class ReturnType {
 		Int = 0,
 		Float = 1,
 		Bool = 2,
-		Void = 3
+		Void = 3,
+		Long = 4,
+		Double = 5,
+		Int4 = 16,
+		Int8 = 17,
+		Float4 = 18,
+		Float8 = 19
+	};
+
+	// The value of a constant expression, of one of the scalar types. An int, long or bool is held in i,
+	// and a float or double in f, a float having been rounded to float precision.
+	struct ConstantValue {
+		VarType type;
+		int64_t i = 0;
+		double f = 0;
 	};
 
 	struct FuncType {
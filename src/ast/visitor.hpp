@@ -24,6 +24,7 @@ public:
 	virtual void visit_binary_expr(const BinaryExpr&) = 0;
 	virtual void visit_assign_expr(const AssignExpr&) = 0;
 	virtual void visit_identifier_expr(const IdentifierExpr&) = 0;
+	virtual void visit_index_expr(const IndexExpr&) = 0;
 	virtual void visit_func_call_expr(const FuncCallExpr&) = 0;
 	virtual void visit_int_expr(const IntExpr&) = 0;
 	virtual void visit_float_expr(const FloatExpr&) = 0;
@@ -0,0 +1,237 @@
+#include "compile_cache.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/SHA1.h>
+
+// The Makefile defines MCCOMP_VERSION as a checksum of the compiler's sources, so any change to the
+// generated code changes every key without a version to bump by hand. A build without it falls back to
+// the time it was compiled, which never reuses the output of an earlier build.
+#ifndef MCCOMP_VERSION
+#define MCCOMP_VERSION __DATE__ " " __TIME__
+#endif
+
+const char* const COMPILER_VERSION = "mccomp " MCCOMP_VERSION " llvm " LLVM_VERSION_STRING;
+
+// A temporary file beside path, unique to this process and thread
+static std::string temp_path(const std::string& path) {
+	std::ostringstream name;
+	name << path << ".tmp" << getpid() << "." << std::this_thread::get_id();
+	return name.str();
+}
+
+static bool copy_file(const std::string& from, const std::string& to) {
+	std::ifstream in(from, std::ios::binary);
+	if (!in) {
+		return false;
+	}
+
+	std::ofstream out(to, std::ios::binary | std::ios::trunc);
+	out << in.rdbuf();
+	return static_cast<bool>(out);
+}
+
+CompileCache::CompileCache(const std::string& dir, uint64_t max_size, const std::string& suffix) :
+	dir(dir),
+	max_size(max_size),
+	suffix(suffix)
+{
+	llvm::sys::fs::create_directories(dir);
+}
+
+std::string CompileCache::make_key(boost::string_ref source, const std::string& options) {
+	// Each part is terminated by a null byte so that no two different inputs hash the same bytes
+	llvm::SHA1 hash;
+	hash.update(COMPILER_VERSION);
+	hash.update(llvm::StringRef("", 1));
+	hash.update(options);
+	hash.update(llvm::StringRef("", 1));
+	hash.update(llvm::StringRef(source.data(), source.size()));
+
+	return llvm::toHex(hash.final(), true);
+}
+
+std::string CompileCache::entry_path(const std::string& key) const {
+	return this->dir + "/" + key + this->suffix;
+}
+
+bool CompileCache::fetch(const std::string& key, const char* out_path) {
+	std::string path = this->entry_path(key);
+
+	// Copied beside out_path and renamed over it, as the compiler itself writes its output
+	std::string tmp_path = temp_path(out_path);
+	if (!copy_file(path, tmp_path) || std::rename(tmp_path.c_str(), out_path) != 0) {
+		std::remove(tmp_path.c_str());
+		this->record('m');
+		return false;
+	}
+
+	// Mark the entry as recently used. It may have been evicted by another process in the meantime,
+	// but the copy we already made is still complete.
+	utime(path.c_str(), nullptr);
+	this->record('h');
+	return true;
+}
+
+boost::optional<std::string> CompileCache::fetch_contents(const std::string& key) {
+	std::string path = this->entry_path(key);
+
+	std::ifstream in(path, std::ios::binary);
+	if (!in) {
+		this->record('m');
+		return boost::none;
+	}
+
+	std::ostringstream contents;
+	contents << in.rdbuf();
+
+	utime(path.c_str(), nullptr);
+	this->record('h');
+	return contents.str();
+}
+
+void CompileCache::store(const std::string& key, const char* in_path) {
+	std::string tmp_path = temp_path(this->entry_path(key));
+	this->commit(key, tmp_path, copy_file(in_path, tmp_path));
+}
+
+void CompileCache::store_contents(const std::string& key, const std::string& contents) {
+	std::string tmp_path = temp_path(this->entry_path(key));
+
+	std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+	out << contents;
+	out.close();
+
+	this->commit(key, tmp_path, static_cast<bool>(out));
+}
+
+// Move a fully written temporary file into place as the entry for key
+void CompileCache::commit(const std::string& key, const std::string& tmp_path, bool written) {
+	if (!written || std::rename(tmp_path.c_str(), this->entry_path(key).c_str()) != 0) {
+		std::remove(tmp_path.c_str());
+		return;
+	}
+
+	this->evict();
+}
+
+// The hit and miss counts, as two native 64 bit integers. A file of any other size (such as one being
+// created) counts as zero.
+static bool read_counts(int fd, uint64_t counts[2]) {
+	counts[0] = counts[1] = 0;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size != 2 * sizeof(uint64_t)) {
+		return false;
+	}
+	return pread(fd, counts, 2 * sizeof(uint64_t), 0) == 2 * sizeof(uint64_t);
+}
+
+// The counts are updated under an exclusive lock, so concurrent processes never lose each other's counts,
+// and the file stays the same size however many compiles use the cache
+void CompileCache::record(char event) {
+	int fd = open((this->dir + "/stats").c_str(), O_RDWR | O_CREAT, 0644);
+	if (fd < 0) {
+		return;
+	}
+
+	if (flock(fd, LOCK_EX) == 0) {
+		uint64_t counts[2];
+		read_counts(fd, counts);
+		counts[event == 'h' ? 0 : 1]++;
+		pwrite(fd, counts, sizeof(counts), 0);
+	}
+	close(fd);
+}
+
+namespace {
+	struct CacheEntry {
+		std::string path;
+		uint64_t size;
+		time_t last_used;
+	};
+}
+
+static std::vector<CacheEntry> list_entries(const std::string& dir, const std::string& suffix) {
+	std::vector<CacheEntry> entries;
+
+	DIR* d = opendir(dir.c_str());
+	if (d == nullptr) {
+		return entries;
+	}
+
+	while (dirent* ent = readdir(d)) {
+		std::string name(ent->d_name);
+		if (name.size() <= suffix.size() || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+			continue;
+		}
+
+		std::string path = dir + "/" + name;
+		struct stat st;
+		if (stat(path.c_str(), &st) == 0) {
+			entries.push_back({ path, static_cast<uint64_t>(st.st_size), st.st_mtime });
+		}
+	}
+
+	closedir(d);
+	return entries;
+}
+
+void CompileCache::evict() {
+	auto entries = list_entries(this->dir, this->suffix);
+
+	uint64_t total = 0;
+	for (auto& entry : entries) {
+		total += entry.size;
+	}
+
+	if (total <= this->max_size) {
+		return;
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const CacheEntry& a, const CacheEntry& b) {
+		return a.last_used < b.last_used;
+	});
+
+	// Another process may be evicting at the same time, in which case the unlink simply fails
+	for (auto& entry : entries) {
+		if (total <= this->max_size) {
+			break;
+		}
+		std::remove(entry.path.c_str());
+		total -= entry.size;
+	}
+}
+
+CompileCache::Stats CompileCache::stats() const {
+	Stats stats;
+
+	for (auto& entry : list_entries(this->dir, this->suffix)) {
+		stats.entries++;
+		stats.size += entry.size;
+	}
+
+	int fd = open((this->dir + "/stats").c_str(), O_RDONLY);
+	if (fd >= 0) {
+		uint64_t counts[2];
+		if (flock(fd, LOCK_SH) == 0 && read_counts(fd, counts)) {
+			stats.hits = counts[0];
+			stats.misses = counts[1];
+		}
+		close(fd);
+	}
+
+	return stats;
+}
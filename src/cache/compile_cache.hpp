@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <boost/optional.hpp>
+#include <boost/utility/string_ref.hpp>
+
+// Identifies the build of the compiler and the LLVM it links, so that cache entries written by any other
+// build are never returned.
+extern const char* const COMPILER_VERSION;
+
+// On-disk cache of compiled output, keyed on a hash of the source, the compiler version and every option
+// that affects the output. Entries are whole output files, stored as "<dir>/<key><suffix>".
+//
+// The cache can be shared by many processes at once: entries are written to a temporary file and renamed
+// into place, so readers only ever see complete entries, and each hit or miss is counted in "<dir>/stats",
+// a fixed size file updated under a lock. Once the entries exceed the size limit, the least recently used ones (by
+// modification time, which is refreshed on every hit) are evicted.
+class CompileCache {
+public:
+	struct Stats {
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t entries = 0;
+		uint64_t size = 0;
+	};
+
+	CompileCache(const std::string& dir, uint64_t max_size, const std::string& suffix = ".ll");
+
+	static std::string make_key(boost::string_ref source, const std::string& options);
+
+	// Copy the entry for key to out_path, returning false (and recording a miss) if there is none
+	bool fetch(const std::string& key, const char* out_path);
+	// Add the file at in_path as the entry for key, then evict entries until within the size limit
+	void store(const std::string& key, const char* in_path);
+
+	// As above, but for entries held in memory
+	boost::optional<std::string> fetch_contents(const std::string& key);
+	void store_contents(const std::string& key, const std::string& contents);
+
+	Stats stats() const;
+
+private:
+	std::string entry_path(const std::string& key) const;
+	void record(char event);
+	void commit(const std::string& key, const std::string& tmp_path, bool written);
+	void evict();
+
+	std::string dir;
+	uint64_t max_size;
+	std::string suffix;
+};
@@ -0,0 +1,144 @@
+#include "function_cache.hpp"
+#include "../compiler/optimizer.hpp"
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/raw_ostream.h>
+
+std::string signature_str(ReturnType return_type, const std::forward_list<std::unique_ptr<Param>>& params) {
+	std::string s = std::string(return_type_to_str(return_type)) + "(";
+
+	for (auto& param : params) {
+		s += std::string(var_type_to_str(param->type)) + " " + param->name + ",";
+	}
+
+	return s + ")";
+}
+
+SignatureMap collect_signatures(const Program& program, const TokenStream& ts) {
+	SignatureMap signatures;
+
+	for (auto& ext : program.externs) {
+		signatures[ext->name] = "extern " + signature_str(ext->return_type, ext->params);
+	}
+
+	for (auto& decl : program.decls) {
+		if (decl->kind == NodeKind::FuncDecl) {
+			auto& func_decl = static_cast<const FuncDecl&>(*decl);
+			signatures[func_decl.name] = signature_str(func_decl.return_type, func_decl.params);
+		} else if (decl->kind == NodeKind::VarDecl) {
+			auto& var_decl = static_cast<const VarDecl&>(*decl);
+			std::string signature = var_type_to_str(var_decl.type);
+			if (is_array_type(var_decl.type)) {
+				signature += std::to_string(var_decl.array_size);
+			}
+
+			// The value of a constant is folded into the functions that use it, so is part of its signature,
+			// as are those of the constants its initializer uses
+			if (var_decl.is_const) {
+				signature += " const =";
+				for (size_t i = var_decl.initializer_begin; i < var_decl.initializer_end; i++) {
+					const Token& tok = ts.tokens[i];
+					signature += " " + tok.lexeme.to_string();
+
+					auto it = tok.type == Token::Type::Identifier ? signatures.find(tok.lexeme.to_string()) : signatures.end();
+					if (it != signatures.end()) {
+						signature += " (" + it->second + ")";
+					}
+				}
+			}
+
+			signatures[var_decl.name] = signature;
+		}
+	}
+
+	return signatures;
+}
+
+std::string function_key(const FuncDecl& decl, const TokenStream& ts, const SignatureMap& signatures, const std::string& options) {
+	llvm::SHA1 hash;
+
+	// Every part is terminated by a null byte so that no two different inputs hash the same bytes
+	auto add = [&hash](llvm::StringRef part) {
+		hash.update(part);
+		hash.update(llvm::StringRef("", 1));
+	};
+
+	add(COMPILER_VERSION);
+	add(options);
+	add(decl.name);
+	add(signature_str(decl.return_type, decl.params));
+	add(decl.is_inline ? "inline" : "");
+
+	for (size_t i = decl.body_begin; i < decl.body_end; i++) {
+		const Token& tok = ts.tokens[i];
+		add(Token::type_to_str(tok.type));
+		add(llvm::StringRef(tok.lexeme.data(), tok.lexeme.size()));
+
+		if (tok.type == Token::Type::Identifier) {
+			auto it = signatures.find(tok.lexeme.to_string());
+			if (it != signatures.end()) {
+				add(it->second);
+			}
+		}
+	}
+
+	return llvm::toHex(hash.final(), true);
+}
+
+FunctionCache::FunctionCache(const std::string& dir, uint64_t max_size) :
+	cache(dir, max_size, ".bc") { }
+
+std::vector<FuncDecl*> FunctionCache::lookup(Program& program, const TokenStream& ts, CodeGenerator& cg, const std::string& options) {
+	SignatureMap signatures = collect_signatures(program, ts);
+	std::vector<FuncDecl*> to_parse;
+
+	for (auto& decl : program.decls) {
+		if (decl->kind != NodeKind::FuncDecl) {
+			continue;
+		}
+
+		auto& func_decl = static_cast<FuncDecl&>(*decl);
+		if (func_decl.body != nullptr) {
+			continue;
+		}
+
+		std::string key = function_key(func_decl, ts, signatures, options);
+		if (auto bitcode = this->cache.fetch_contents(key)) {
+			if (auto function_module = cg.load_function(*bitcode)) {
+				this->hits.push_back(std::move(function_module));
+				continue;
+			}
+		}
+
+		this->misses.push_back({ &func_decl, key });
+		to_parse.push_back(&func_decl);
+	}
+
+	return to_parse;
+}
+
+void FunctionCache::update(CodeGenerator& cg, unsigned int opt_level, llvm::TargetMachine* target_machine) {
+	for (auto& miss : this->misses) {
+		auto function_module = cg.function_module(miss.first->name);
+		optimize_functions(*function_module, opt_level, target_machine);
+
+		std::string bitcode;
+		llvm::raw_string_ostream os(bitcode);
+		llvm::WriteBitcodeToFile(*function_module, os);
+		this->cache.store_contents(miss.second, os.str());
+
+		this->hits.push_back(std::move(function_module));
+	}
+
+	for (auto& function_module : this->hits) {
+		cg.link_function(std::move(function_module));
+	}
+
+	this->misses.clear();
+	this->hits.clear();
+}
+
+CompileCache::Stats FunctionCache::stats() const {
+	return this->cache.stats();
+}
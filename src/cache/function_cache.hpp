@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "compile_cache.hpp"
+#include "../ast/declaration.hpp"
+#include "../parser/token_stream.hpp"
+#include "../codegen/codegen.hpp"
+#include <llvm/Target/TargetMachine.h>
+
+using namespace ast::declaration;
+
+// Map from the name of every extern, global variable and function in the program to a string describing
+// its signature (or type, for variables, and value, for constants)
+using SignatureMap = std::unordered_map<std::string, std::string>;
+
+SignatureMap collect_signatures(const Program& program, const TokenStream& ts);
+
+// Key of a function in the function-level IR cache. It hashes the compiler version, the options that
+// change the generated code (including the optimisation level), the function's own signature, the tokens of its body and the signature of every global it refers to, which together
+// determine the IR generated for it. Hashing tokens rather than text means that edits to whitespace and
+// comments (or to other functions, moving this one) keep the key the same. Only needs the body's token
+// range, so the body itself need not have been parsed.
+std::string function_key(const FuncDecl& decl, const TokenStream& ts, const SignatureMap& signatures, const std::string& options);
+
+// Cache of the IR generated for each function, used to only regenerate the functions that changed since
+// the last compile. Entries are bitcode modules holding a single function definition (see
+// CodeGenerator::function_module), stored under function_key in a CompileCache once they have been
+// through the per-function passes of the optimiser, so only the module's own passes are left to run over
+// the whole program (see optimize_module).
+class FunctionCache {
+public:
+	FunctionCache(const std::string& dir, uint64_t max_size);
+
+	// Load the cached IR of every function in the program whose body has not been parsed yet. Returns
+	// the functions that missed, whose bodies must be parsed before type checking and code generation.
+	// The others are left without a body, so are only declared by the CodeGenerator.
+	std::vector<FuncDecl*> lookup(Program& program, const TokenStream& ts, CodeGenerator& cg, const std::string& options);
+
+	// Once the program has been generated, optimise and cache the functions that missed, then splice every
+	// function back in from its optimised module, so that all of them have been through optimize_functions
+	// at opt_level, and none depend on attributes the cache key does not cover
+	void update(CodeGenerator& cg, unsigned int opt_level, llvm::TargetMachine* target_machine);
+
+	CompileCache::Stats stats() const;
+
+private:
+	CompileCache cache;
+	std::vector<std::pair<const FuncDecl*, std::string>> misses;
+	std::vector<std::unique_ptr<llvm::Module>> hits;
+};
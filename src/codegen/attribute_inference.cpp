@@ -0,0 +1,305 @@
+#include "attribute_inference.hpp"
+#include "builtins.hpp"
+#include "intrinsics.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+AttributeInference::AttributeInference(bool bounds_checks) : bounds_checks(bounds_checks) { }
+
+void AttributeInference::visit_program(const Program& program) {
+	for (auto& ext : program.externs) {
+		this->dispatch(*ext);
+	}
+
+	// Functions are numbered first, so that calls to those declared later can be followed, and constants
+	// are known before any function reads them
+	for (auto& decl : program.decls) {
+		if (decl->kind == NodeKind::VarDecl) {
+			this->dispatch(*decl);
+			continue;
+		}
+
+		auto& func_decl = static_cast<const FuncDecl&>(*decl);
+		if (func_decl.body != nullptr) {
+			this->function_indices[func_decl.name] = this->functions.size();
+			this->functions.push_back(&func_decl);
+		}
+	}
+
+	this->effects.resize(this->functions.size());
+	for (size_t i = 0; i < this->functions.size(); i++) {
+		this->current = &this->effects[i];
+		this->dispatch(*this->functions[i]);
+	}
+	this->current = nullptr;
+
+	this->propagate_effects();
+	std::vector<bool> recursive = this->find_recursion();
+
+	for (size_t i = 0; i < this->functions.size(); i++) {
+		const Effects& effects = this->effects[i];
+		FunctionAttributes& attributes = this->attributes[this->functions[i]->name];
+
+		attributes.nounwind = !effects.calls_unknown;
+		attributes.norecurse = !effects.calls_unknown && !recursive[i];
+		attributes.readonly = !effects.calls_unknown && !effects.may_trap && !effects.writes_globals && !effects.writes_params;
+		attributes.readnone = attributes.readonly && !effects.reads_globals && !effects.reads_params;
+	}
+}
+
+void AttributeInference::visit_extern_decl(const ExternDecl& extern_decl) {
+	if (math_intrinsic(extern_decl)) {
+		this->intrinsic_externs.insert(extern_decl.name);
+	}
+}
+
+void AttributeInference::visit_var_decl(const VarDecl& decl) {
+	if (decl.is_const) {
+		this->constant_globals.insert(decl.name);
+	}
+}
+
+void AttributeInference::visit_func_decl(const FuncDecl& decl) {
+	this->frames.clear();
+	this->frames.emplace_back();
+	for (auto& param : decl.params) {
+		this->frames.back()[param->name] = is_array_type(param->type) ? Storage::ArrayParam : Storage::Local;
+	}
+
+	this->dispatch(*decl.body);
+}
+
+void AttributeInference::visit_block(const Block& block) {
+	this->frames.emplace_back();
+
+	for (auto& local_decl : block.var_decls) {
+		this->visit_local_decl(*local_decl);
+	}
+
+	for (auto& stmt : block.statements) {
+		this->dispatch(*stmt);
+	}
+
+	this->frames.pop_back();
+}
+
+void AttributeInference::visit_local_decl(const VarDecl& local_decl) {
+	this->frames.back()[local_decl.name] = Storage::Local;
+}
+
+void AttributeInference::visit_expr_stmt(const ExprStmt& expr_stmt) {
+	if (expr_stmt.expr != nullptr) {
+		this->dispatch(*expr_stmt.expr);
+	}
+}
+
+void AttributeInference::visit_return_stmt(const Return& ret_stmt) {
+	if (ret_stmt.return_val != nullptr) {
+		this->dispatch(*ret_stmt.return_val);
+	}
+}
+
+void AttributeInference::visit_if_else_stmt(const IfElse& if_else_stmt) {
+	this->dispatch(*if_else_stmt.cond);
+	this->dispatch(*if_else_stmt.if_true);
+	if (if_else_stmt.if_false != nullptr) {
+		this->dispatch(*if_else_stmt.if_false);
+	}
+}
+
+void AttributeInference::visit_while_stmt(const While& while_stmt) {
+	this->dispatch(*while_stmt.cond);
+	this->dispatch(*while_stmt.body);
+}
+
+void AttributeInference::visit_unary_expr(const UnaryExpr& unary_expr) {
+	this->dispatch(*unary_expr.operand);
+}
+
+void AttributeInference::visit_binary_expr(const BinaryExpr& binary_expr) {
+	this->dispatch(*binary_expr.first_operand);
+	this->dispatch(*binary_expr.second_operand);
+}
+
+void AttributeInference::visit_assign_expr(const AssignExpr& assign_expr) {
+	if (assign_expr.index != nullptr) {
+		this->dispatch(*assign_expr.index);
+		this->current->may_trap |= this->bounds_checks;
+	}
+	this->dispatch(*assign_expr.expr);
+
+	switch (this->storage(assign_expr.name)) {
+		case Storage::Local: break;
+		case Storage::ArrayParam: this->current->writes_params = true; break;
+		case Storage::Global: this->current->writes_globals = true; break;
+		case Storage::Constant: break; // the TypeChecker allows no assignments to constants
+	}
+}
+
+void AttributeInference::visit_identifier_expr(const IdentifierExpr& identifier_expr) {
+	if (this->storage(identifier_expr.name) == Storage::Global) {
+		this->current->reads_globals = true;
+	}
+}
+
+void AttributeInference::visit_index_expr(const IndexExpr& index_expr) {
+	this->dispatch(*index_expr.index);
+	this->current->may_trap |= this->bounds_checks;
+
+	switch (this->storage(index_expr.name)) {
+		case Storage::Local: break;
+		case Storage::ArrayParam: this->current->reads_params = true; break;
+		case Storage::Global: this->current->reads_globals = true; break;
+		case Storage::Constant: break;
+	}
+}
+
+void AttributeInference::visit_func_call_expr(const FuncCallExpr& func_call_expr) {
+	Call call;
+	for (auto& param : func_call_expr.params) {
+		if (!is_array_type(*param->type)) {
+			this->dispatch(*param);
+			continue;
+		}
+
+		// What the callee does to the elements of an array parameter, it does to the array passed
+		Storage array = this->storage(static_cast<const IdentifierExpr&>(*param).name);
+		call.passes_globals |= array == Storage::Global;
+		call.passes_params |= array == Storage::ArrayParam;
+	}
+
+	auto& name = func_call_expr.func_name;
+	if (builtin_from_name(name) || this->intrinsic_externs.count(name) != 0) {
+		return;
+	}
+
+	auto callee = this->function_indices.find(name);
+	if (callee == this->function_indices.end()) {
+		this->current->calls_unknown = true;
+		return;
+	}
+
+	call.callee = callee->second;
+	this->current->calls.push_back(call);
+}
+
+void AttributeInference::visit_int_expr(const IntExpr& int_expr) { }
+
+void AttributeInference::visit_float_expr(const FloatExpr& float_expr) { }
+
+void AttributeInference::visit_bool_expr(const BoolExpr& bool_expr) { }
+
+AttributeInference::Storage AttributeInference::storage(const std::string& name) const {
+	for (auto frame = this->frames.rbegin(); frame != this->frames.rend(); frame++) {
+		auto it = frame->find(name);
+		if (it != frame->end()) {
+			return it->second;
+		}
+	}
+
+	return this->constant_globals.count(name) != 0 ? Storage::Constant : Storage::Global;
+}
+
+// Gives every function the effects of the functions it calls, until there are none left to add
+void AttributeInference::propagate_effects() {
+	bool changed = true;
+	auto add = [&changed](bool& effect, bool callee_effect) {
+		if (callee_effect && !effect) {
+			effect = true;
+			changed = true;
+		}
+	};
+
+	while (changed) {
+		changed = false;
+
+		for (auto& caller : this->effects) {
+			for (auto& call : caller.calls) {
+				const Effects& callee = this->effects[call.callee];
+
+				add(caller.reads_globals, callee.reads_globals || (call.passes_globals && callee.reads_params));
+				add(caller.writes_globals, callee.writes_globals || (call.passes_globals && callee.writes_params));
+				add(caller.reads_params, call.passes_params && callee.reads_params);
+				add(caller.writes_params, call.passes_params && callee.writes_params);
+				add(caller.may_trap, callee.may_trap);
+				add(caller.calls_unknown, callee.calls_unknown);
+			}
+		}
+	}
+}
+
+// Whether each function is in a cycle of calls: a strongly connected component of the call graph of
+// more than one function, or one that calls itself. Found with Tarjan's algorithm, kept iterative so
+// that long chains of calls do not run out of stack.
+std::vector<bool> AttributeInference::find_recursion() const {
+	const size_t unvisited = SIZE_MAX;
+	size_t num_functions = this->functions.size();
+
+	std::vector<size_t> index(num_functions, unvisited);
+	std::vector<size_t> lowlink(num_functions, 0);
+	std::vector<bool> on_stack(num_functions, false);
+	std::vector<bool> recursive(num_functions, false);
+	std::vector<size_t> stack;
+	size_t next_index = 0;
+
+	// The functions being visited, each with the next of its calls to follow
+	std::vector<std::pair<size_t, size_t>> path;
+	auto visit = [&](size_t function) {
+		index[function] = lowlink[function] = next_index++;
+		stack.push_back(function);
+		on_stack[function] = true;
+		path.push_back({ function, 0 });
+	};
+
+	for (size_t root = 0; root < num_functions; root++) {
+		if (index[root] != unvisited) {
+			continue;
+		}
+
+		visit(root);
+		while (!path.empty()) {
+			size_t function = path.back().first;
+			auto& calls = this->effects[function].calls;
+
+			if (path.back().second < calls.size()) {
+				size_t callee = calls[path.back().second++].callee;
+				if (callee == function) {
+					recursive[function] = true;
+				}
+
+				if (index[callee] == unvisited) {
+					visit(callee);
+				} else if (on_stack[callee]) {
+					lowlink[function] = std::min(lowlink[function], index[callee]);
+				}
+				continue;
+			}
+
+			path.pop_back();
+			if (!path.empty()) {
+				size_t caller = path.back().first;
+				lowlink[caller] = std::min(lowlink[caller], lowlink[function]);
+			}
+
+			if (lowlink[function] == index[function]) {
+				std::vector<size_t> component;
+				size_t member;
+				do {
+					member = stack.back();
+					stack.pop_back();
+					on_stack[member] = false;
+					component.push_back(member);
+				} while (member != function);
+
+				if (component.size() > 1) {
+					for (size_t in_cycle : component) {
+						recursive[in_cycle] = true;
+					}
+				}
+			}
+		}
+	}
+
+	return recursive;
+}
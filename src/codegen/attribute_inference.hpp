@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "../ast/static_visitor.hpp"
+
+using namespace ast::declaration;
+using namespace ast::statement;
+using namespace ast::expr;
+
+// What the optimizer may assume of a function, given every function it calls. A function that is
+// readnone (or readonly) and nounwind can have calls to it CSEd, hoisted out of loops and vectorized.
+struct FunctionAttributes {
+	bool readnone = false; // reads and writes no memory but its own locals
+	bool readonly = false; // writes no memory but its own locals
+	bool nounwind = false;
+	bool norecurse = false; // can never be running twice at once
+};
+
+// Infers the attributes of every function in the program from its body and those of the functions it
+// calls, once the TypeChecker has run. Only an extern can throw, or call back into the program, so a
+// function that calls one is assumed to do anything, unless the extern is a math function compiled as
+// an intrinsic (see math_intrinsic). So is a function that calls one whose body has not been parsed (see
+// FuncDecl::body), which gets no attributes itself. With bounds checks, a function that indexes an array
+// can trap, so is neither readnone nor readonly, which would let unused calls to it be removed.
+class AttributeInference : public StaticVisitor<AttributeInference> {
+public:
+	AttributeInference(bool bounds_checks = false);
+
+	void visit_program(const Program& program);
+	void visit_extern_decl(const ExternDecl& extern_decl);
+	void visit_var_decl(const VarDecl& decl);
+	void visit_func_decl(const FuncDecl& decl);
+	void visit_block(const Block& block);
+	void visit_local_decl(const VarDecl& local_decl);
+	void visit_expr_stmt(const ExprStmt& expr_stmt);
+	void visit_return_stmt(const Return& ret_stmt);
+	void visit_if_else_stmt(const IfElse& if_else_stmt);
+	void visit_while_stmt(const While& while_stmt);
+	void visit_unary_expr(const UnaryExpr& unary_expr);
+	void visit_binary_expr(const BinaryExpr& binary_expr);
+	void visit_assign_expr(const AssignExpr& assign_expr);
+	void visit_identifier_expr(const IdentifierExpr& identifier_expr);
+	void visit_index_expr(const IndexExpr& index_expr);
+	void visit_func_call_expr(const FuncCallExpr& func_call_expr);
+	void visit_int_expr(const IntExpr& int_expr);
+	void visit_float_expr(const FloatExpr& float_expr);
+	void visit_bool_expr(const BoolExpr& bool_expr);
+
+	// Filled in by visit_program, for every function whose body has been parsed
+	std::unordered_map<std::string, FunctionAttributes> attributes;
+
+private:
+	// Where the memory a name refers to lives. Scalars and vectors are values, so only the elements of an
+	// array parameter are the caller's. A constant global never changes, so reading it reads no memory
+	// that anything could write.
+	enum class Storage { Local, ArrayParam, Global, Constant };
+
+	struct Call {
+		size_t callee; // index into effects
+		bool passes_globals = false; // a global array, to one of the callee's array parameters
+		bool passes_params = false; // one of the caller's own array parameters
+	};
+
+	struct Effects {
+		bool reads_globals = false;
+		bool writes_globals = false;
+		bool reads_params = false; // elements of the function's array parameters
+		bool writes_params = false;
+		bool may_trap = false;
+		bool calls_unknown = false;
+		std::vector<Call> calls;
+	};
+
+	Storage storage(const std::string& name) const;
+	void propagate_effects();
+	std::vector<bool> find_recursion() const;
+
+	bool bounds_checks;
+	std::unordered_set<std::string> intrinsic_externs;
+	std::unordered_set<std::string> constant_globals;
+	std::unordered_map<std::string, size_t> function_indices; // of the functions whose bodies are parsed
+	std::vector<const FuncDecl*> functions;
+	std::vector<Effects> effects;
+
+	Effects* current = nullptr;
+	std::vector<std::unordered_map<std::string, Storage>> frames;
+};
@@ -0,0 +1,39 @@
+#include "builtins.hpp"
+#include <llvm/IR/Constants.h>
+#include <vector>
+
+boost::optional<Builtin> builtin_from_name(const std::string& name) {
+	if (name == "reduce_add") return Builtin::ReduceAdd;
+	if (name == "reduce_min") return Builtin::ReduceMin;
+	if (name == "reduce_max") return Builtin::ReduceMax;
+	return boost::none;
+}
+
+static llvm::Value* combine(llvm::IRBuilder<>& builder, Builtin builtin, bool is_float, llvm::Value* lhs, llvm::Value* rhs) {
+	switch (builtin) {
+		case Builtin::ReduceAdd:
+			return is_float ? builder.CreateFAdd(lhs, rhs) : builder.CreateAdd(lhs, rhs);
+		case Builtin::ReduceMin:
+			return builder.CreateSelect(is_float ? builder.CreateFCmpOLT(lhs, rhs) : builder.CreateICmpSLT(lhs, rhs), lhs, rhs);
+		case Builtin::ReduceMax:
+			return builder.CreateSelect(is_float ? builder.CreateFCmpOGT(lhs, rhs) : builder.CreateICmpSGT(lhs, rhs), lhs, rhs);
+	}
+}
+
+llvm::Value* cg_reduction(llvm::IRBuilder<>& builder, Builtin builtin, VarType vector_type, llvm::Value* vector) {
+	unsigned int lanes = lane_count(vector_type);
+	bool is_float = lane_type(vector_type) == VarType::Float;
+
+	for (unsigned int half = lanes / 2; half >= 1; half /= 2) {
+		// Lane i of the shuffle is lane i + half, for each of the lanes still in use
+		std::vector<llvm::Constant*> mask;
+		for (unsigned int i = 0; i < lanes; i++) {
+			mask.push_back(builder.getInt32(i < half ? i + half : i));
+		}
+
+		llvm::Value* upper = builder.CreateShuffleVector(vector, vector, llvm::ConstantVector::get(mask));
+		vector = combine(builder, builtin, is_float, vector, upper);
+	}
+
+	return builder.CreateExtractElement(vector, builder.getInt32(0));
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Value.h>
+#include <string>
+#include <boost/optional.hpp>
+#include "../ast/type.hpp"
+
+using namespace ast::type;
+
+// Functions every program can call without declaring them, and no program can declare. Each reduces
+// the lanes of a vector (see is_vector_type) to a single value of its lane type:
+//   reduce_add(v)  the sum of the lanes
+//   reduce_min(v)  the least lane
+//   reduce_max(v)  the greatest lane
+enum class Builtin {
+	ReduceAdd,
+	ReduceMin,
+	ReduceMax
+};
+
+boost::optional<Builtin> builtin_from_name(const std::string& name);
+
+// Combines the upper half of the lanes with the lower half until one is left, which the backend lowers
+// to the target's horizontal instructions. A float sum is therefore added pairwise, not in lane order.
+llvm::Value* cg_reduction(llvm::IRBuilder<>& builder, Builtin builtin, VarType vector_type, llvm::Value* vector);
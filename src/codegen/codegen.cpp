@@ -1,8 +1,12 @@
 #include "codegen.hpp"
+#include "attribute_inference.hpp"
+#include "builtins.hpp"
+#include "intrinsics.hpp"
 #include "ops.hpp"
 #include "type_coerce.hpp"
-#include "type_error.hpp"
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
 #include <vector>
 
 #include <llvm/IR/Type.h>
@@ -10,131 +14,213 @@
 #include <llvm/IR/Function.h>
 #include <llvm/IR/GlobalVariable.h>
 #include <llvm/IR/Constant.h>
+#include <llvm/IR/Constants.h>
 #include <llvm/IR/Instruction.h>
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/IR/Metadata.h>
 #include <llvm/IR/Verifier.h>
-#include <llvm/Support/FileSystem.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Transforms/IPO.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <llvm/Transforms/Utils/ValueMapper.h>
 
 using namespace ast::declaration;
 
-CodeGenerator::CodeGenerator() :
-	module("main_module", this->context),
+CodeGenerator::CodeGenerator(const std::string& module_name) :
+	owned_context(llvm::make_unique<llvm::LLVMContext>()),
+	owned_module(llvm::make_unique<llvm::Module>(module_name, *this->owned_context)),
+	context(*this->owned_context),
+	module(*this->owned_module),
 	builder(this->context) { }
 
+std::unique_ptr<llvm::LLVMContext> CodeGenerator::take_context() {
+	return std::move(this->owned_context);
+}
+
+std::unique_ptr<llvm::Module> CodeGenerator::take_module() {
+	return std::move(this->owned_module);
+}
+
+llvm::Module& CodeGenerator::generated_module() {
+	return this->module;
+}
+
 llvm::Type* CodeGenerator::convert_return_type(ReturnType rt) {
 	switch (rt) {
 		case ReturnType::Int: return llvm::Type::getInt32Ty(this->context);
 		case ReturnType::Float: return llvm::Type::getFloatTy(this->context);
 		case ReturnType::Bool: return llvm::Type::getInt1Ty(this->context);
 		case ReturnType::Void: return llvm::Type::getVoidTy(this->context);
+		case ReturnType::Long: return llvm::Type::getInt64Ty(this->context);
+		case ReturnType::Double: return llvm::Type::getDoubleTy(this->context);
+		case ReturnType::Int4:
+		case ReturnType::Int8:
+		case ReturnType::Float4:
+		case ReturnType::Float8:
+			return this->convert_var_type(static_cast<VarType>(rt));
 	}
 }
 
+// An array type converts to a pointer to its first element, which is how arrays are passed
 llvm::Type* CodeGenerator::convert_var_type(VarType vt) {
 	switch (vt) {
 		case VarType::Int: return llvm::Type::getInt32Ty(this->context);
 		case VarType::Float: return llvm::Type::getFloatTy(this->context);
 		case VarType::Bool: return llvm::Type::getInt1Ty(this->context);
+		case VarType::Long: return llvm::Type::getInt64Ty(this->context);
+		case VarType::Double: return llvm::Type::getDoubleTy(this->context);
+		case VarType::Int4:
+		case VarType::Int8:
+		case VarType::Float4:
+		case VarType::Float8:
+			return llvm::VectorType::get(this->convert_var_type(lane_type(vt)), lane_count(vt));
+		case VarType::IntArray:
+		case VarType::FloatArray:
+		case VarType::BoolArray:
+		case VarType::LongArray:
+		case VarType::DoubleArray:
+		case VarType::Int4Array:
+		case VarType::Int8Array:
+		case VarType::Float4Array:
+		case VarType::Float8Array:
+			return this->convert_var_type(element_type(vt))->getPointerTo();
 	}
 }
 
+// An array parameter is passed as two arguments, a pointer to its first element and its length
+std::vector<llvm::Type*> CodeGenerator::convert_param_types(const std::forward_list<std::unique_ptr<Param>>& params) {
+	std::vector<llvm::Type*> param_types;
+	for (auto& param : params) {
+		param_types.push_back(this->convert_var_type(param->type));
+		if (is_array_type(param->type)) {
+			param_types.push_back(llvm::Type::getInt32Ty(this->context));
+		}
+	}
+
+	return param_types;
+}
+
 void CodeGenerator::visit_program(const Program& program) {
+	AttributeInference attribute_inference(this->bounds_checks);
+	attribute_inference.dispatch(program);
+	this->inferred_attributes = std::move(attribute_inference.attributes);
+
 	for (auto& ext : program.externs) {
-		ext->accept_visitor(*this);
+		this->dispatch(*ext);
 	}
 
 	for (auto& decl : program.decls) {
-		decl->accept_visitor(*this);
+		this->dispatch(*decl);
 	}
+}
 
+void CodeGenerator::verify() {
 	llvm::verifyModule(this->module, &llvm::errs());
 }
 
 void CodeGenerator::visit_extern_decl(const ExternDecl& extern_decl) {
-	if (this->scope.function_exists(extern_decl.name)) {
-		throw TypeError(
-			extern_decl.line_num,
-			extern_decl.column_num,
-			std::string("a function called \"") + extern_decl.name + "\" has already been declared"
-		);
-	}
-
 	auto return_type = this->convert_return_type(extern_decl.return_type);
+	auto param_types = this->convert_param_types(extern_decl.params);
 
-	std::vector<llvm::Type*> param_types;
-	for (auto& param : extern_decl.params) {
-		auto param_type = convert_var_type(param->type);
-		param_types.push_back(param_type);
+	if (auto intrinsic = math_intrinsic(extern_decl)) {
+		this->intrinsic_externs[extern_decl.name] = llvm::Intrinsic::getDeclaration(&this->module, *intrinsic, { return_type });
+		return;
 	}
 
 	auto func_type = llvm::FunctionType::get(return_type, param_types, false);
 
 	llvm::Function::Create(func_type, llvm::Function::ExternalLinkage, extern_decl.name, this->module);
+}
 
+// A global is zero unless it has an initializer, whose values the TypeChecker has already folded. Those of a
+// constant are emitted as constant globals, which the optimizer can fold into every load.
+void CodeGenerator::visit_var_decl(const VarDecl& var_decl) {
+	if (is_array_type(var_decl.type)) {
+		auto element_llvm_type = this->convert_var_type(element_type(var_decl.type));
+		auto array_type = llvm::ArrayType::get(element_llvm_type, var_decl.array_size);
 
-	// Register func type
-	{
-		std::forward_list<VarType> param_type_fl;
-		for (auto& param : extern_decl.params) {
-			param_type_fl.push_front(param->type);
+		std::vector<llvm::Constant*> elements(var_decl.array_size, llvm::Constant::getNullValue(element_llvm_type));
+		for (size_t i = 0; i < var_decl.initial_values.size(); i++) {
+			elements[i] = this->convert_constant(var_decl.initial_values[i]);
 		}
-		param_type_fl.reverse();
-		this->scope.register_func_type(extern_decl.name, extern_decl.return_type, param_type_fl);
+
+		llvm::Value* gv = new llvm::GlobalVariable(
+			this->module,
+			array_type,
+			var_decl.is_const,
+			llvm::GlobalVariable::InternalLinkage,
+			llvm::ConstantArray::get(array_type, elements),
+			var_decl.name
+		);
+
+		this->scope.register_var(var_decl.name, gv, var_decl.type, this->builder.getInt32(var_decl.array_size));
+		return;
 	}
-}
 
-void CodeGenerator::visit_var_decl(const VarDecl& var_decl) {
 	auto var_type = this->convert_var_type(var_decl.type);
+	llvm::Constant* initial_value = var_decl.initial_values.empty()
+		? llvm::Constant::getNullValue(var_type)
+		: this->convert_constant(var_decl.initial_values.front());
 
 	llvm::Value* gv = new llvm::GlobalVariable(
 		this->module,
 		var_type,
-		false,
+		var_decl.is_const,
 		llvm::GlobalVariable::InternalLinkage,
-		llvm::Constant::getNullValue(var_type),
+		initial_value,
 		var_decl.name
 	);
 
 	this->scope.register_var(var_decl.name, gv, var_decl.type);
 }
 
-void CodeGenerator::visit_func_decl(const FuncDecl& func_decl) {
-	if (this->scope.function_exists(func_decl.name)) {
-		throw TypeError(
-			func_decl.line_num,
-			func_decl.column_num,
-			std::string("a function called \"") + func_decl.name + "\" has already been declared"
-		);
+llvm::Constant* CodeGenerator::convert_constant(const ConstantValue& value) {
+	switch (value.type) {
+		case VarType::Int: return this->builder.getInt32(static_cast<uint32_t>(value.i));
+		case VarType::Long: return this->builder.getInt64(static_cast<uint64_t>(value.i));
+		case VarType::Bool: return this->builder.getInt1(value.i != 0);
+		case VarType::Float: return llvm::ConstantFP::get(this->builder.getFloatTy(), value.f);
+		case VarType::Double: return llvm::ConstantFP::get(this->builder.getDoubleTy(), value.f);
+		default: break;
 	}
 
-	// Register func type
-	{
-		std::forward_list<VarType> param_type_fl;
-		for (auto& param : func_decl.params) {
-			param_type_fl.push_front(param->type);
-		}
-		param_type_fl.reverse();
-		this->scope.register_func_type(func_decl.name, func_decl.return_type, param_type_fl);
-	}
+	throw std::logic_error(std::string("no constant of type ") + var_type_to_str(value.type));
+}
 
+void CodeGenerator::visit_func_decl(const FuncDecl& func_decl) {
+	// The name is only copied when a report is being made
+	TimeScope timer(this->time_report, this->time_report != nullptr ? func_decl.name : std::string(), "function");
 
-	// CG func
 	auto return_type = this->convert_return_type(func_decl.return_type);
-
-	std::vector<llvm::Type*> param_types;
-	for (auto& param : func_decl.params) {
-		auto param_type = convert_var_type(param->type);
-		param_types.push_back(param_type);
-	}
+	auto param_types = this->convert_param_types(func_decl.params);
 
 	auto func_type = llvm::FunctionType::get(return_type, param_types, false);
 
 	this->current_function = llvm::Function::Create(func_type, llvm::Function::ExternalLinkage, func_decl.name, this->module);
 
+	// A body that was never parsed is emitted as a declaration only
+	if (func_decl.body == nullptr) {
+		return;
+	}
+
+	this->add_inferred_attributes(*this->current_function);
+	// Inlined even without optimisation, by the AlwaysInliner optimize_module runs at -O0
+	if (this->inline_costs.is_inlined(func_decl.name)) {
+		this->current_function->addFnAttr(llvm::Attribute::AlwaysInline);
+	} else if (func_decl.is_inline) {
+		this->current_function->addFnAttr(llvm::Attribute::InlineHint);
+	}
+
 	auto body = llvm::BasicBlock::Create(this->context, func_decl.name + ":entry_point", this->current_function);
 	this->builder.SetInsertPoint(body);
+	this->bounds_check_failed_block = nullptr;
 
 	// Create return block and return alloca
-	this->current_return_type = func_decl.return_type;
 	this->return_block = llvm::BasicBlock::Create(this->context, func_decl.name + ":return_block");
 	if (func_decl.return_type != ReturnType::Void) { // If the function is non-void, make a variable to store the result
 		this->return_alloca = this->builder.CreateAlloca(return_type);
@@ -145,6 +231,16 @@ void CodeGenerator::visit_func_decl(const FuncDecl& func_decl) {
 	auto llvm_arg = this->current_function->arg_begin();
 	for (auto& param : func_decl.params) {
 		llvm_arg->setName(param->name);
+
+		// Array parameters cannot be assigned, so are used straight from their arguments
+		if (is_array_type(param->type)) {
+			llvm::Value* pointer = &*llvm_arg++;
+			llvm_arg->setName(param->name + ".length");
+			this->scope.register_var(param->name, pointer, param->type, &*llvm_arg);
+			llvm_arg++;
+			continue;
+		}
+
 		llvm::Value* alloca = this->builder.CreateAlloca(this->convert_var_type(param->type));
 		this->builder.CreateStore(llvm_arg, alloca);
 		this->scope.register_var(param->name, alloca, param->type);
@@ -153,39 +249,55 @@ void CodeGenerator::visit_func_decl(const FuncDecl& func_decl) {
 
 	this->cg_block(*func_decl.body);
 	
-	// Handle return block
-	if (this->return_called || func_decl.return_type == ReturnType::Void) {
-		if (!this->return_called && func_decl.return_type == ReturnType::Void) {
-			this->builder.CreateBr(this->return_block);
-		}
-		return_called = false;
-		this->builder.SetInsertPoint(this->return_block);
-		if (func_decl.return_type == ReturnType::Void) {
-			this->builder.CreateRetVoid();
-		} else {
-			llvm::Value* ret_val = this->builder.CreateLoad(this->return_alloca);
-			this->builder.CreateRet(ret_val);
-		}
-
-		auto& block_list = this->current_function->getBasicBlockList();
-		block_list.push_back(this->return_block);
+	// Handle return block. The TypeChecker guarantees non-void functions end in a return.
+	if (!this->return_called) {
+		this->builder.CreateBr(this->return_block);
+	}
+	this->return_called = false;
+	this->builder.SetInsertPoint(this->return_block);
+	if (func_decl.return_type == ReturnType::Void) {
+		this->builder.CreateRetVoid();
 	} else {
-		throw std::runtime_error(std::string("semantic error: The non-void function \"") + func_decl.name + "\" does not end in a return statement.");
+		llvm::Value* ret_val = this->builder.CreateLoad(this->return_alloca);
+		this->builder.CreateRet(ret_val);
 	}
 
+	auto& block_list = this->current_function->getBasicBlockList();
+	block_list.push_back(this->return_block);
+
 
 	this->scope.pop_scope();
 
 	llvm::verifyFunction(*this->current_function, &llvm::errs());
 }
 
+void CodeGenerator::add_inferred_attributes(llvm::Function& function) {
+	auto inferred = this->inferred_attributes.find(function.getName().str());
+	if (inferred == this->inferred_attributes.end()) {
+		return;
+	}
+
+	const FunctionAttributes& attributes = inferred->second;
+	if (attributes.readnone) {
+		function.addFnAttr(llvm::Attribute::ReadNone);
+	} else if (attributes.readonly) {
+		function.addFnAttr(llvm::Attribute::ReadOnly);
+	}
+	if (attributes.nounwind) {
+		function.addFnAttr(llvm::Attribute::NoUnwind);
+	}
+	if (attributes.norecurse) {
+		function.addFnAttr(llvm::Attribute::NoRecurse);
+	}
+}
+
 void CodeGenerator::cg_block(const Block& block) {
 	for (auto& local_decl : block.var_decls) {
 		this->visit_local_decl(*local_decl);
 	}
 
 	for (auto& stmt : block.statements) {
-		stmt->accept_visitor(*this);
+		this->dispatch(*stmt);
 		if (this->return_called) {
 			break;
 		}
@@ -200,67 +312,81 @@ void CodeGenerator::visit_block(const Block& block) {
 	this->scope.pop_scope();
 }
 
+// Locals are allocated in the entry block wherever they are declared, so that a declaration inside a
+// loop does not grow the stack on every iteration, and so that scalars can be promoted to registers
 void CodeGenerator::visit_local_decl(const VarDecl& local_decl) {
+	llvm::BasicBlock& entry = this->current_function->getEntryBlock();
+	llvm::IRBuilder<> entry_builder(&entry, entry.begin());
+
+	if (is_array_type(local_decl.type)) {
+		auto array_type = llvm::ArrayType::get(this->convert_var_type(element_type(local_decl.type)), local_decl.array_size);
+		llvm::Value* array = entry_builder.CreateAlloca(array_type, nullptr, local_decl.name);
+		this->scope.register_var(local_decl.name, array, local_decl.type, this->builder.getInt32(local_decl.array_size));
+		return;
+	}
+
 	auto type = this->convert_var_type(local_decl.type);
 
-	llvm::Value* var = this->builder.CreateAlloca(type);
+	llvm::Value* var = entry_builder.CreateAlloca(type);
 	this->scope.register_var(local_decl.name, var, local_decl.type);
 }
 
 void CodeGenerator::visit_expr_stmt(const ExprStmt& expr_stmt) {
 	if (expr_stmt.expr == nullptr) return;
 
-	expr_stmt.expr->accept_visitor(*this);
+	this->dispatch(*expr_stmt.expr);
 }
 
 void CodeGenerator::visit_return_stmt(const Return& ret_stmt) {
 	if (ret_stmt.return_val == nullptr) {
-		if (this->current_return_type != ReturnType::Void) {
-			throw TypeError(ret_stmt.line_num, ret_stmt.column_num, "return statements for non-void functions must have an associated return value");
-		}
 		this->builder.CreateBr(this->return_block);
 	} else {
-		ret_stmt.return_val->accept_visitor(*this);
-		if ((size_t)this->current_return_type != (size_t)this->get_current_expr_type(ret_stmt.line_num, ret_stmt.column_num, "as a return value")) {
-			throw TypeError(
-				ret_stmt.line_num,
-				ret_stmt.column_num,
-				std::string("return value of type ")
-					+ var_type_to_str(this->get_current_expr_type(ret_stmt.line_num, ret_stmt.column_num, "as a return value"))
-					+ " does not match the return type "
-					+ return_type_to_str(this->current_return_type)
-					+ " of the function"
-			);
+		llvm::Value* ret_val = this->cg_expr(*ret_stmt.return_val);
+		if (auto call = this->tail_call(ret_val)) {
+			// Returned straight from, rather than through the return block, so that the call stays in tail position
+			this->builder.CreateRet(call);
+		} else {
+			this->builder.CreateStore(ret_val, this->return_alloca);
+			this->builder.CreateBr(this->return_block);
 		}
-		this->builder.CreateStore(this->current_expr, this->return_alloca);
-		this->builder.CreateBr(this->return_block);
 	}
 
 	this->return_called = true;
 }
 
+// The call that a returned value is, marked as a tail call, if nothing was generated after it. A call
+// the function makes to itself is a guaranteed tail call (musttail), which reuses the caller's frame
+// even when unoptimised. Returns nullptr if the value is not a call or the call cannot be a tail call.
+llvm::CallInst* CodeGenerator::tail_call(llvm::Value* value) {
+	auto call = llvm::dyn_cast<llvm::CallInst>(value);
+	if (call == nullptr || call != &this->builder.GetInsertBlock()->back()) {
+		return nullptr;
+	}
+
+	// A tail call must not be given anything on the caller's stack, as a local array is
+	for (unsigned int i = 0; i < call->arg_size(); i++) {
+		if (llvm::isa<llvm::AllocaInst>(call->getArgOperand(i)->stripInBoundsOffsets())) {
+			return nullptr;
+		}
+	}
+
+	call->setTailCallKind(call->getCalledFunction() == this->current_function ? llvm::CallInst::TCK_MustTail : llvm::CallInst::TCK_Tail);
+	return call;
+}
+
 void CodeGenerator::visit_if_else_stmt(const IfElse& if_else_stmt) {
 	auto if_true_block = llvm::BasicBlock::Create(this->context, "if_true");
 	auto if_false_block = llvm::BasicBlock::Create(this->context, "if_false");
 	auto if_cont_block = llvm::BasicBlock::Create(this->context, "if_cont");
 
 	// Gen condition
-	if_else_stmt.cond->accept_visitor(*this);
-	VarType cond_type = this->get_current_expr_type(if_else_stmt.line_num, if_else_stmt.column_num, "as an if statement condition") ;
-	if (cond_type != VarType::Bool) {
-		throw TypeError(
-			if_else_stmt.line_num,
-			if_else_stmt.column_num,
-			std::string("if statement condition must be of type bool, but an expression of type ") + var_type_to_str(cond_type) + " was given"
-		);
-	}
-	this->builder.CreateCondBr(this->current_expr, if_true_block, if_false_block);
+	this->builder.CreateCondBr(this->cg_expr(*if_else_stmt.cond), if_true_block, if_false_block);
 
 	// Gen 'if_true'
 	this->scope.push_scope();
 
 	this->builder.SetInsertPoint(if_true_block);
-	if_else_stmt.if_true->accept_visitor(*this);
+	this->dispatch(*if_else_stmt.if_true);
 	if (this->return_called) {
 		this->return_called = false;
 	} else {
@@ -274,7 +400,7 @@ void CodeGenerator::visit_if_else_stmt(const IfElse& if_else_stmt) {
 
 	this->builder.SetInsertPoint(if_false_block);
 	if (if_else_stmt.if_false != nullptr) {
-		if_else_stmt.if_false->accept_visitor(*this);
+		this->dispatch(*if_else_stmt.if_false);
 	}
 	if (this->return_called) {
 		this->return_called = false;
@@ -294,279 +420,349 @@ void CodeGenerator::visit_if_else_stmt(const IfElse& if_else_stmt) {
 	this->builder.SetInsertPoint(if_cont_block);
 }
 
+// Loops are generated in the rotated form the optimiser's loop passes work on: the condition is checked
+// once before the loop, by a guard, and then at the end of every iteration, by the latch. Each loop so
+// has a preheader, a single latch and an exit that only the loop branches to.
 void CodeGenerator::visit_while_stmt(const While& while_stmt) {
-	auto current_block = this->builder.GetInsertBlock();
-	auto cond_check_block = llvm::BasicBlock::Create(this->context, "while_cond_check");
+	auto preheader_block = llvm::BasicBlock::Create(this->context, "while_preheader");
 	auto body_block = llvm::BasicBlock::Create(this->context, "while_body");
+	llvm::BasicBlock* exit_block = nullptr;
 	auto cont_block = llvm::BasicBlock::Create(this->context, "while_cont");
 
-	// Jmp into loop
-	this->builder.CreateBr(cond_check_block);
+	// Gen guard
+	this->builder.CreateCondBr(this->cg_expr(*while_stmt.cond), preheader_block, cont_block);
 
-	// Gen condition
-	this->builder.SetInsertPoint(cond_check_block);
-	while_stmt.cond->accept_visitor(*this);
-	VarType cond_type = this->get_current_expr_type(while_stmt.line_num, while_stmt.column_num, "as a while statement condition") ;
-	if (cond_type != VarType::Bool) {
-		throw TypeError(
-			while_stmt.line_num,
-			while_stmt.column_num,
-			std::string("while statement condition must be of type bool, but an expression of type ") + var_type_to_str(cond_type) + " was given"
-		);
-	}
-
-	this->builder.CreateCondBr(this->current_expr, body_block, cont_block);
+	this->builder.SetInsertPoint(preheader_block);
+	this->builder.CreateBr(body_block);
 
 	// Gen body
 	this->scope.push_scope();
 
 	this->builder.SetInsertPoint(body_block);
-	while_stmt.body->accept_visitor(*this);
+	this->dispatch(*while_stmt.body);
+
+	this->scope.pop_scope();
+
+	// Gen latch. A body that always returns never loops.
 	if (this->return_called) {
 		this->return_called = false;
 	} else {
-		this->builder.CreateBr(cond_check_block);
-	}
+		exit_block = llvm::BasicBlock::Create(this->context, "while_exit");
+		auto latch = this->builder.CreateCondBr(this->cg_expr(*while_stmt.cond), body_block, exit_block);
+		latch->setMetadata(llvm::LLVMContext::MD_loop, this->loop_id(while_stmt));
 
-	this->scope.pop_scope();
+		this->builder.SetInsertPoint(exit_block);
+		this->builder.CreateBr(cont_block);
+	}
 
 	// Link together
 	auto& block_list = this->current_function->getBasicBlockList();
-	block_list.push_back(cond_check_block);
+	block_list.push_back(preheader_block);
 	block_list.push_back(body_block);
+	if (exit_block != nullptr) {
+		block_list.push_back(exit_block);
+	}
 	block_list.push_back(cont_block);
 
 	this->builder.SetInsertPoint(cont_block);
 }
 
+// A distinct node for each loop, which refers to itself as the LangRef requires, holding the loop's
+// MiniC line and the hints in loop_hints
+llvm::MDNode* CodeGenerator::loop_id(const While& while_stmt) {
+	auto property = [this](const char* name, llvm::Constant* value) {
+		return llvm::MDNode::get(this->context, { llvm::MDString::get(this->context, name), llvm::ConstantAsMetadata::get(value) });
+	};
+
+	llvm::SmallVector<llvm::Metadata*, 5> properties;
+	properties.push_back(nullptr);
+	properties.push_back(property(LOOP_LINE_METADATA, this->builder.getInt32(while_stmt.line_num)));
+	if (this->loop_hints.vectorize_width != 0) {
+		properties.push_back(property("llvm.loop.vectorize.enable", this->builder.getInt1(this->loop_hints.vectorize_width > 1)));
+		properties.push_back(property("llvm.loop.vectorize.width", this->builder.getInt32(this->loop_hints.vectorize_width)));
+	}
+	if (this->loop_hints.interleave_count != 0) {
+		properties.push_back(property("llvm.loop.interleave.count", this->builder.getInt32(this->loop_hints.interleave_count)));
+	}
+	if (this->loop_hints.unroll_count != 0) {
+		properties.push_back(property("llvm.loop.unroll.count", this->builder.getInt32(this->loop_hints.unroll_count)));
+	}
+
+	auto id = llvm::MDNode::getDistinct(this->context, properties);
+	id->replaceOperandWith(0, id);
+	return id;
+}
+
 void CodeGenerator::print() {
 	this->module.print(llvm::outs(), nullptr);
 }
 
-void CodeGenerator::write_to_file(const char* filepath) {
-	std::error_code ec;
-	llvm::raw_fd_ostream dest(filepath, ec, llvm::sys::fs::F_None);
-	if (ec) {
-		std::cerr << "Failed to open file for output: " << ec.message();
-		return;
+std::unique_ptr<llvm::Module> CodeGenerator::function_module(const std::string& name) {
+	const llvm::Function* func = this->module.getFunction(name);
+
+	llvm::ValueToValueMapTy vmap;
+	auto function_module = llvm::CloneModule(this->module, vmap, [func](const llvm::GlobalValue* gv) {
+		return gv == func;
+	});
+
+	// The inferred attributes, and whether the function is inlined, depend on the bodies of the functions it
+	// calls, which the cache key does not cover, so a cached function has none. Nor do the functions it
+	// calls, so that the optimiser cannot rely on theirs either.
+	for (auto& cached_func : *function_module) {
+		for (auto kind : { llvm::Attribute::ReadNone, llvm::Attribute::ReadOnly, llvm::Attribute::NoUnwind, llvm::Attribute::NoRecurse, llvm::Attribute::AlwaysInline }) {
+			cached_func.removeFnAttr(kind);
+		}
 	}
 
-	this->module.print(dest, nullptr);
+	return function_module;
 }
 
+// Returns nullptr if the bitcode cannot be read, in which case the function should be generated instead
+std::unique_ptr<llvm::Module> CodeGenerator::load_function(const std::string& bitcode) {
+	auto function_module = llvm::parseBitcodeFile(llvm::MemoryBufferRef(bitcode, "cached function"), this->context);
+	if (!function_module) {
+		llvm::consumeError(function_module.takeError());
+		return nullptr;
+	}
 
-void CodeGenerator::visit_unary_expr(const UnaryExpr& unary_expr) {
-	unary_expr.operand->accept_visitor(*this);
+	return std::move(*function_module);
+}
 
-	VarType expr_type = this->get_current_expr_type(unary_expr.line_num, unary_expr.column_num, "as an argument to a unary operator");
+void CodeGenerator::link_function(std::unique_ptr<llvm::Module> function_module) {
+	// The linker never resolves a declaration to a global with internal linkage, so globals the function
+	// uses are made external for the duration of the link
+	std::vector<llvm::GlobalValue*> internal_globals;
+	for (auto& gv : function_module->global_values()) {
+		auto dest_gv = this->module.getNamedValue(gv.getName());
+		if (gv.isDeclaration() && dest_gv != nullptr && dest_gv->hasLocalLinkage()) {
+			dest_gv->setLinkage(llvm::GlobalValue::ExternalLinkage);
+			internal_globals.push_back(dest_gv);
+		}
+	}
 
-	if (unary_expr.op == UnaryOp::Not) {
-		if (expr_type == VarType::Bool) {
-			this->current_expr = this->builder.CreateNot(this->current_expr);
-			this->current_expr_type = VarType::Bool;
-		} else {
-			throw TypeError(unary_expr.line_num, unary_expr.column_num, std::string("Operand to '!' should be a bool, instead encountered a ") + var_type_to_str(expr_type));
+	// The linker only replaces declarations
+	for (auto& function : *function_module) {
+		auto dest_function = this->module.getFunction(function.getName());
+		if (!function.isDeclaration() && dest_function != nullptr) {
+			dest_function->deleteBody();
 		}
-	} else if (unary_expr.op == UnaryOp::Negate) {
-		std::cerr << (int)expr_type << std::endl;
-		switch (expr_type) {
-			case VarType::Int:
-				this->current_expr = this->builder.CreateNeg(this->current_expr);
-				this->current_expr_type = VarType::Int;
-				break;
-
-			case VarType::Float:
-				this->current_expr = this->builder.CreateFNeg(this->current_expr);
-				this->current_expr_type = VarType::Float;
-				break;
-
-			case VarType::Bool:
-				throw TypeError(unary_expr.line_num, unary_expr.column_num, "Operand to '-' should be a numeric type, instead encountered a bool");
+	}
+
+	bool failed = llvm::Linker::linkModules(this->module, std::move(function_module));
+
+	for (auto dest_gv : internal_globals) {
+		dest_gv->setLinkage(llvm::GlobalValue::InternalLinkage);
+	}
+
+	if (failed) {
+		throw std::runtime_error("failed to link a cached function into the module");
+	}
+}
+
+void CodeGenerator::internalize(const std::vector<std::string>& exports) {
+	for (auto& name : exports) {
+		auto func = this->module.getFunction(name);
+		if (func == nullptr || func->isDeclaration()) {
+			throw std::runtime_error("cannot export \"" + name + "\", as the program defines no function of that name");
+		}
+	}
+
+	for (auto& function : this->module) {
+		bool exported = std::find(exports.begin(), exports.end(), function.getName().str()) != exports.end();
+		if (!function.isDeclaration() && !exported) {
+			function.setLinkage(llvm::GlobalValue::InternalLinkage);
 		}
 	}
+
+	llvm::legacy::PassManager passes;
+	passes.add(llvm::createGlobalDCEPass());
+	passes.run(this->module);
 }
 
-void CodeGenerator::visit_binary_expr(const BinaryExpr& binary_expr) {
-	binary_expr.first_operand->accept_visitor(*this);
-	llvm::Value* lhs = this->current_expr;
-	VarType lhs_type = this->get_current_expr_type(binary_expr.line_num, binary_expr.column_num, "as an operand to a binary operator");
+void CodeGenerator::visit_unary_expr(const UnaryExpr& unary_expr) {
+	llvm::Value* operand = this->cg_expr(*unary_expr.operand);
+
+	// A vector is negated lane by lane, as its lane type would be
+	VarType type = *unary_expr.operand->type;
+	if (is_vector_type(type)) {
+		type = lane_type(type);
+	}
+
+	if (unary_expr.op == UnaryOp::Not) {
+		this->current_expr = this->builder.CreateNot(operand);
+	} else if (type == VarType::Float || type == VarType::Double) {
+		this->current_expr = this->builder.CreateFNeg(operand);
+	} else {
+		this->current_expr = this->builder.CreateNeg(operand);
+	}
+}
 
-	binary_expr.second_operand->accept_visitor(*this);
-	llvm::Value* rhs = this->current_expr;
-	VarType rhs_type = this->get_current_expr_type(binary_expr.line_num, binary_expr.column_num, "as an operand to a binary operator");
+void CodeGenerator::visit_binary_expr(const BinaryExpr& binary_expr) {
+	llvm::Value* lhs = this->cg_expr(*binary_expr.first_operand);
+	llvm::Value* rhs = this->cg_expr(*binary_expr.second_operand);
 
+	// The operands have already been coerced to the parameter types of the entry the TypeChecker chose
 	const OpTable& op_table = OpTable::for_op(binary_expr.op);
-	std::vector<VarType> actual_operand_types { lhs_type, rhs_type };
+	std::vector<VarType> operand_types { *binary_expr.first_operand->coerced_type, *binary_expr.second_operand->coerced_type };
 
-	// Check for exact match
 	for (auto& pair : op_table.entries) {
-		if (pair.first.param_types == actual_operand_types) {
+		if (pair.first.param_types == operand_types) {
 			this->current_expr = pair.second(this->builder, lhs, rhs);
-			this->set_expr_type(pair.first.ret_type);
 			return;
 		}
 	}
+}
 
-	// Check if can coerce to an available type
-	for (auto& pair : op_table.entries) {
-		auto maybe_coerce_funcs = coerce_list(actual_operand_types, pair.first.param_types);
-
-		if (maybe_coerce_funcs) {
-			llvm::Value* new_lhs = (*maybe_coerce_funcs)[0](this->context, this->builder, lhs);
-			llvm::Value* new_rhs = (*maybe_coerce_funcs)[1](this->context, this->builder, rhs);
+void CodeGenerator::visit_assign_expr(const AssignExpr& assign_expr) {
+	if (assign_expr.index != nullptr && is_vector_type(*this->scope.lookup_variable_type(assign_expr.name))) {
+		llvm::Value* lane = this->lane_index(assign_expr.name, *assign_expr.index);
+		llvm::Value* val = this->cg_expr(*assign_expr.expr);
 
-			this->current_expr = pair.second(this->builder, new_lhs, new_rhs);
-			this->set_expr_type(pair.first.ret_type);
-			return;
-		}
+		llvm::Value* var = this->scope.lookup_variable_val(assign_expr.name);
+		this->builder.CreateStore(this->builder.CreateInsertElement(this->builder.CreateLoad(var), val, lane), var);
+		this->current_expr = val;
+		return;
 	}
 
-	throw TypeError(
-		binary_expr.line_num,
-		binary_expr.column_num,
-		std::string("operator \"") + ast::expr::binary_op_symbol(binary_expr.op) + "\"",
-		op_table.valid_param_types(),
-		std::vector<VarType> { lhs_type, rhs_type }
-	);
-}
-
-void CodeGenerator::visit_assign_expr(const AssignExpr& assign_expr) {
-	assign_expr.expr->accept_visitor(*this);
-
-	VarType actual_type = this->get_current_expr_type(assign_expr.line_num, assign_expr.column_num, "as the right hand side of an assignment");
-	if (auto variable_type = this->scope.lookup_variable_type(assign_expr.name)) {
-		if (actual_type != *variable_type) {
-			throw TypeError(
-				assign_expr.line_num,
-				assign_expr.column_num,
-				std::string("cannot assign a value of type ") + var_type_to_str(actual_type) + " to the variable " + assign_expr.name + " of type " + var_type_to_str(*variable_type)
-			);
-		}
-	} else {
-		throw TypeError(
-			assign_expr.line_num,
-			assign_expr.column_num,
-			std::string("in assignment, undefined variable \"") + assign_expr.name + "\""
-		);
+	if (assign_expr.index != nullptr) {
+		llvm::Value* element = this->element_pointer(assign_expr.name, *assign_expr.index);
+		llvm::Value* val = this->cg_expr(*assign_expr.expr);
+		this->builder.CreateStore(val, element);
+		this->current_expr = val;
+		return;
 	}
 
+	llvm::Value* val = this->cg_expr(*assign_expr.expr);
+
 	llvm::Value* var = this->scope.lookup_variable_val(assign_expr.name);
-	this->builder.CreateStore(this->current_expr, var);
+	this->builder.CreateStore(val, var);
+	// The value of an assignment is the value stored, after any coercion
+	this->current_expr = val;
 }
 
 void CodeGenerator::visit_identifier_expr(const IdentifierExpr& identifier_expr) {
 	auto var = this->scope.lookup_variable_val(identifier_expr.name);
-	if (var == nullptr) {
-		throw TypeError(
-			identifier_expr.line_num,
-			identifier_expr.column_num,
-			std::string("undefined variable \"") + identifier_expr.name + "\""
-		);
+
+	// A constant is folded into its uses, even without optimisation
+	auto global = llvm::dyn_cast<llvm::GlobalVariable>(var);
+	if (global != nullptr && global->isConstant() && !global->getValueType()->isArrayTy()) {
+		this->current_expr = global->getInitializer();
+		return;
 	}
+
 	this->current_expr = this->builder.CreateLoad(var);
-	this->current_expr_type = this->scope.lookup_variable_type(identifier_expr.name);
 }
 
-void CodeGenerator::visit_func_call_expr(const FuncCallExpr& func_call_expr) {
-	if (auto func_type = this->scope.lookup_func_type(func_call_expr.func_name)) {
-		auto func_ret_type = func_type->first;
-		auto func_param_types = func_type->second;
-
-		std::vector<llvm::Value*> params;
-		std::vector<VarType> actual_param_types;
-
-		for (auto& param_expr : func_call_expr.params) {
-			param_expr->accept_visitor(*this);
-			params.push_back(this->current_expr);
-			auto actual_param_type = this->get_current_expr_type(param_expr->get_line_num(), param_expr->get_column_num(), "as parameter");
-			actual_param_types.push_back(actual_param_type);
-		}
+void CodeGenerator::visit_index_expr(const IndexExpr& index_expr) {
+	if (is_vector_type(*this->scope.lookup_variable_type(index_expr.name))) {
+		llvm::Value* lane = this->lane_index(index_expr.name, *index_expr.index);
+		llvm::Value* vector = this->builder.CreateLoad(this->scope.lookup_variable_val(index_expr.name));
+		this->current_expr = this->builder.CreateExtractElement(vector, lane);
+		return;
+	}
 
-		// Typecheck and coerce
-		{
-			std::vector<VarType> expected_param_types;
-			for (auto vt : func_param_types) {
-				expected_param_types.push_back(vt);
-			}
-
-			if (expected_param_types.size() != actual_param_types.size()) {
-				throw TypeError(
-					func_call_expr.line_num,
-					func_call_expr.column_num,
-					std::string("the function \"")
-						+ func_call_expr.func_name
-						+ "\" takes "
-						+ std::to_string(expected_param_types.size())
-						+ " parameters, but "
-						+ std::to_string(actual_param_types.size())
-						+ " were supplied"
-				);
-			}
-
-			auto maybe_coerce_funcs = coerce_list(actual_param_types, expected_param_types);
-			if (maybe_coerce_funcs) {
-				for (size_t i = 0; i < params.size(); i++) {
-					llvm::Value* new_param = (*maybe_coerce_funcs)[i](this->context, this->builder, params[i]);
-					params[i] = new_param;
-				}
-			} else {
-				throw TypeError(
-					func_call_expr.line_num,
-					func_call_expr.column_num,
-					std::string("the function \"") + func_call_expr.func_name + "\"",
-					std::vector<std::vector<VarType>> { expected_param_types },
-					actual_param_types
-				);
-			}
-		}
+	llvm::Value* element = this->element_pointer(index_expr.name, *index_expr.index);
+	this->current_expr = this->builder.CreateLoad(element);
+}
 
-		llvm::Function* func = this->module.getFunction(func_call_expr.func_name);
-		this->current_expr = this->builder.CreateCall(func, params);
+// Arrays are only ever indexed, or passed to array parameters, which take a pointer and a length
+void CodeGenerator::visit_func_call_expr(const FuncCallExpr& func_call_expr) {
+	if (auto builtin = builtin_from_name(func_call_expr.func_name)) {
+		auto& vector = *func_call_expr.params.front();
+		this->current_expr = cg_reduction(this->builder, *builtin, *vector.type, this->cg_expr(vector));
+		return;
+	}
 
-		this->set_expr_type(func_ret_type);
-	} else {
-		throw TypeError(
-			func_call_expr.line_num,
-			func_call_expr.column_num,
-			std::string("undefined function \"") + func_call_expr.func_name + "\""
-		);
+	std::vector<llvm::Value*> params;
+	for (auto& param_expr : func_call_expr.params) {
+		if (is_array_type(*param_expr->type)) {
+			auto& name = static_cast<const IdentifierExpr&>(*param_expr).name;
+			params.push_back(this->array_pointer(name));
+			params.push_back(this->scope.lookup_array_length(name));
+		} else {
+			params.push_back(this->cg_expr(*param_expr));
+		}
 	}
+
+	auto intrinsic = this->intrinsic_externs.find(func_call_expr.func_name);
+	llvm::Function* func = intrinsic != this->intrinsic_externs.end() ? intrinsic->second : this->module.getFunction(func_call_expr.func_name);
+	this->current_expr = this->builder.CreateCall(func, params);
 }
 
 void CodeGenerator::visit_int_expr(const IntExpr& int_expr) {
-	this->current_expr = llvm::ConstantInt::get(llvm::Type::getInt32Ty(this->context), int_expr.value);
-	this->current_expr_type = VarType::Int;
+	this->current_expr = llvm::ConstantInt::get(this->convert_var_type(*int_expr.type), int_expr.value, true);
 }
 
 void CodeGenerator::visit_float_expr(const FloatExpr& float_expr) {
-	this->current_expr = llvm::ConstantFP::get(llvm::Type::getFloatTy(this->context), float_expr.value);
-	this->current_expr_type = VarType::Float;
+	this->current_expr = llvm::ConstantFP::get(this->convert_var_type(*float_expr.type), float_expr.value);
 }
 
 void CodeGenerator::visit_bool_expr(const BoolExpr& bool_expr) {
 	llvm::Type* type = llvm::Type::getInt1Ty(this->context);
 	this->current_expr = bool_expr.value ? llvm::ConstantInt::getTrue(type) : llvm::ConstantInt::getFalse(type);
-	this->current_expr_type = VarType::Bool;
 }
 
-VarType CodeGenerator::get_current_expr_type(unsigned int line_num, unsigned int column_num, const char* context) {
-	if (this->current_expr_type) {
-		return *this->current_expr_type;
+// A pointer to the first element of an array variable. Array parameters already are one, while local
+// and global arrays are stored whole.
+llvm::Value* CodeGenerator::array_pointer(const std::string& name) {
+	llvm::Value* array = this->scope.lookup_variable_val(name);
+	if (llvm::isa<llvm::Argument>(array)) {
+		return array;
 	}
 
-	throw TypeError(
-		line_num,
-		column_num,
-		std::string("cannot use an expression of type void ") + context
-	);
-	throw std::runtime_error("Cannot operate on something of type void");
+	auto array_type = llvm::cast<llvm::PointerType>(array->getType())->getElementType();
+	return this->builder.CreateConstInBoundsGEP2_32(array_type, array, 0, 0);
+}
+
+llvm::Value* CodeGenerator::element_pointer(const std::string& name, const Expr& index) {
+	llvm::Value* first = this->array_pointer(name);
+	llvm::Value* i = this->cg_expr(index);
+
+	if (this->bounds_checks) {
+		this->cg_bounds_check(i, this->scope.lookup_array_length(name));
+	}
+
+	auto element_type = llvm::cast<llvm::PointerType>(first->getType())->getElementType();
+	return this->builder.CreateInBoundsGEP(element_type, first, i);
 }
 
-void CodeGenerator::set_expr_type(ReturnType ret_type) {
-	switch (ret_type) {
-		case ReturnType::Void: this->current_expr_type = boost::none; break;
-		case ReturnType::Int: this->current_expr_type = VarType::Int; break;
-		case ReturnType::Float: this->current_expr_type = VarType::Float; break;
-		case ReturnType::Bool: this->current_expr_type = VarType::Bool; break;
+// The index of a lane of a vector variable, checked as an array index would be
+llvm::Value* CodeGenerator::lane_index(const std::string& name, const Expr& index) {
+	llvm::Value* i = this->cg_expr(index);
+
+	if (this->bounds_checks) {
+		this->cg_bounds_check(i, this->builder.getInt32(lane_count(*this->scope.lookup_variable_type(name))));
+	}
+
+	return i;
+}
+
+// Continues in a new block if 0 <= index < length, and otherwise traps. A single unsigned comparison
+// checks both bounds, which is the form induction variable simplification can prove redundant from a
+// loop's own condition. Every failed check in a function branches to the same block, which is marked
+// as unlikely, so the checks that remain keep the loop body small.
+void CodeGenerator::cg_bounds_check(llvm::Value* index, llvm::Value* length) {
+	if (this->bounds_check_failed_block == nullptr) {
+		this->bounds_check_failed_block = llvm::BasicBlock::Create(this->context, "bounds_check_failed", this->current_function);
+
+		llvm::IRBuilder<> trap_builder(this->bounds_check_failed_block);
+		trap_builder.CreateCall(llvm::Intrinsic::getDeclaration(&this->module, llvm::Intrinsic::trap));
+		trap_builder.CreateUnreachable();
 	}
+
+	auto in_bounds_block = llvm::BasicBlock::Create(this->context, "in_bounds", this->current_function);
+	llvm::Value* in_bounds = this->builder.CreateICmpULT(index, length);
+	this->builder.CreateCondBr(in_bounds, in_bounds_block, this->bounds_check_failed_block, llvm::MDBuilder(this->context).createBranchWeights(1 << 20, 1));
+	this->builder.SetInsertPoint(in_bounds_block);
+}
+
+llvm::Value* CodeGenerator::cg_expr(const Expr& expr) {
+	this->dispatch(expr);
+
+	if (expr.coerced_type && *expr.coerced_type != *expr.type) {
+		auto coerce_func = coerce_type(*expr.type, *expr.coerced_type);
+		return (*coerce_func)(this->context, this->builder, this->current_expr);
+	}
+
+	return this->current_expr;
 }
@@ -1,66 +1,120 @@
 #pragma once
 
 #include "scope.hpp"
-#include "../ast/visitor.hpp"
+#include "attribute_inference.hpp"
+#include "inline_cost.hpp"
+#include "loop_hints.hpp"
+#include "../timing/time_report.hpp"
+#include "../ast/static_visitor.hpp"
 #include "../ast/declaration.hpp"
 #include "../ast/statement.hpp"
 
+#include <llvm/ADT/SmallVector.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/BasicBlock.h>
 #include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <forward_list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 using namespace ast::declaration;
 using namespace ast::statement;
 
-class CodeGenerator : public ASTVisitor {
+class CodeGenerator : public StaticVisitor<CodeGenerator> {
 public:
-	CodeGenerator();
-
-	void visit_program(const Program& program) override;
-	void visit_extern_decl(const ExternDecl& extern_decl) override;
-	void visit_var_decl(const VarDecl& decl) override;
-	void visit_func_decl(const FuncDecl& decl) override;
-	void visit_block(const Block& block) override;
-	void visit_local_decl(const VarDecl& local_decl) override;
-	void visit_expr_stmt(const ExprStmt& expr_stmt) override;
-	void visit_return_stmt(const Return& ret_stmt) override;
-	void visit_if_else_stmt(const IfElse& if_else_stmt) override;
-	void visit_while_stmt(const While& while_stmt) override;
-	void visit_unary_expr(const UnaryExpr& unary_expr) override;
-	void visit_binary_expr(const BinaryExpr& binary_expr) override;
-	void visit_assign_expr(const AssignExpr& assign_expr) override;
-	void visit_identifier_expr(const IdentifierExpr& identifier_expr) override;
-	void visit_func_call_expr(const FuncCallExpr& func_call_expr) override;
-	void visit_int_expr(const IntExpr& int_expr) override;
-	void visit_float_expr(const FloatExpr& float_expr) override;
-	void visit_bool_expr(const BoolExpr& bool_expr) override;
+	CodeGenerator(const std::string& module_name = "main_module");
+
+	void visit_program(const Program& program);
+	void visit_extern_decl(const ExternDecl& extern_decl);
+	void visit_var_decl(const VarDecl& decl);
+	void visit_func_decl(const FuncDecl& decl);
+	void visit_block(const Block& block);
+	void visit_local_decl(const VarDecl& local_decl);
+	void visit_expr_stmt(const ExprStmt& expr_stmt);
+	void visit_return_stmt(const Return& ret_stmt);
+	void visit_if_else_stmt(const IfElse& if_else_stmt);
+	void visit_while_stmt(const While& while_stmt);
+	void visit_unary_expr(const UnaryExpr& unary_expr);
+	void visit_binary_expr(const BinaryExpr& binary_expr);
+	void visit_assign_expr(const AssignExpr& assign_expr);
+	void visit_identifier_expr(const IdentifierExpr& identifier_expr);
+	void visit_index_expr(const IndexExpr& index_expr);
+	void visit_func_call_expr(const FuncCallExpr& func_call_expr);
+	void visit_int_expr(const IntExpr& int_expr);
+	void visit_float_expr(const FloatExpr& float_expr);
+	void visit_bool_expr(const BoolExpr& bool_expr);
 
 	void cg_block(const Block& block);
+	llvm::Value* cg_expr(const Expr& expr);
 
 	llvm::Type* convert_return_type(ReturnType rt);
 	llvm::Type* convert_var_type(VarType vt);
+	std::vector<llvm::Type*> convert_param_types(const std::forward_list<std::unique_ptr<Param>>& params);
+	llvm::Constant* convert_constant(const ConstantValue& value);
+	void verify();
 	void print();
-	void write_to_file(const char* filepath);
 
-private:
-	VarType get_current_expr_type(unsigned int line_num, unsigned int column_num, const char* context);
-	void set_expr_type(ReturnType ret_type);
+	// Function-level IR caching. function_module returns a module holding just the definition of the
+	// named function (and declarations of everything it uses), and link_function splices the function
+	// from such a module back into this one, replacing its definition here if it has one.
+	std::unique_ptr<llvm::Module> function_module(const std::string& name);
+	std::unique_ptr<llvm::Module> load_function(const std::string& bitcode);
+	void link_function(std::unique_ptr<llvm::Module> function_module);
+
+	// Gives every function but those exported internal linkage, as globals already have, then removes the
+	// functions and globals that no exported function uses. Throws std::runtime_error if an exported
+	// function is not defined in the module.
+	void internalize(const std::vector<std::string>& exports);
+
+	// When set, code generation is timed per function
+	TimeReport* time_report = nullptr;
+
+	// When set, every array index is checked against the array's length, and indexing out of bounds traps
+	bool bounds_checks = false;
 
+	LoopHints loop_hints;
+
+	// The functions to inline into every call, analysed by the caller once the program is type checked, so
+	// that it only flattens the program once for every consumer. Without it, no function is inlined.
+	InlineCostModel inline_costs;
+
+	// Hand the generated module (and the context it lives in) to the caller. The module must be destroyed
+	// before its context, and the CodeGenerator must not be used afterwards.
+	std::unique_ptr<llvm::LLVMContext> take_context();
+	std::unique_ptr<llvm::Module> take_module();
+	// The module as generated so far, e.g. to optimise it before it is written
+	llvm::Module& generated_module();
+
+private:
+	llvm::Value* array_pointer(const std::string& name);
+	llvm::Value* element_pointer(const std::string& name, const Expr& index);
+	llvm::Value* lane_index(const std::string& name, const Expr& index);
+	void cg_bounds_check(llvm::Value* index, llvm::Value* length);
+	llvm::CallInst* tail_call(llvm::Value* value);
+	void add_inferred_attributes(llvm::Function& function);
+	llvm::MDNode* loop_id(const While& while_stmt);
 
-	llvm::LLVMContext context;
-	llvm::Module module;
+	std::unique_ptr<llvm::LLVMContext> owned_context;
+	std::unique_ptr<llvm::Module> owned_module;
+	llvm::LLVMContext& context;
+	llvm::Module& module;
 	llvm::IRBuilder<> builder;
 
 	Scope scope;
+	// Externs that are called as the LLVM intrinsic for the same math function (see math_intrinsic)
+	std::unordered_map<std::string, llvm::Function*> intrinsic_externs;
+	std::unordered_map<std::string, FunctionAttributes> inferred_attributes;
 
 	llvm::Function* current_function;
 	llvm::Value* current_expr;
-	boost::optional<VarType> current_expr_type;
 	// Variables for managing returns
 	llvm::BasicBlock* return_block;
 	llvm::Value* return_alloca;
-	ReturnType current_return_type;
 	bool return_called = false;
+	llvm::BasicBlock* bounds_check_failed_block; // created by the first bounds check in each function
 };
@@ -0,0 +1,164 @@
+#include "constant_fold.hpp"
+#include "type_error.hpp"
+#include <cstdint>
+#include <stdexcept>
+
+// Wraps a result to 32 bits, as int arithmetic does
+static int64_t wrap_int(uint64_t value) {
+	return static_cast<int32_t>(static_cast<uint32_t>(value));
+}
+
+static ConstantValue int_value(VarType type, int64_t i) {
+	ConstantValue value;
+	value.type = type;
+	value.i = type == VarType::Int ? wrap_int(i) : i;
+	return value;
+}
+
+static ConstantValue float_value(VarType type, double f) {
+	ConstantValue value;
+	value.type = type;
+	value.f = type == VarType::Float ? static_cast<float>(f) : f;
+	return value;
+}
+
+static ConstantValue bool_value(bool b) {
+	return int_value(VarType::Bool, b ? 1 : 0);
+}
+
+// The conversions coerce_type allows between scalar types
+static ConstantValue convert(const ConstantValue& value, VarType to) {
+	if (value.type == to) {
+		return value;
+	}
+
+	switch (to) {
+		case VarType::Long: return int_value(to, value.i);
+		// Converted straight to a float, as rounding to a double first could round differently
+		case VarType::Float: return float_value(to, static_cast<float>(value.i));
+		case VarType::Double: return float_value(to, value.type == VarType::Float ? value.f : static_cast<double>(value.i));
+		default: break;
+	}
+
+	throw std::logic_error(std::string("no constant conversion from ") + var_type_to_str(value.type) + " to " + var_type_to_str(to));
+}
+
+static ConstantValue fold_integer_op(const BinaryExpr& expr, VarType type, int64_t lhs, int64_t rhs) {
+	// Unsigned, so that overflow wraps, as it does in the generated code
+	uint64_t a = static_cast<uint64_t>(lhs);
+	uint64_t b = static_cast<uint64_t>(rhs);
+	int64_t min = type == VarType::Int ? INT32_MIN : INT64_MIN;
+
+	switch (expr.op) {
+		case BinaryOp::Multiply: return int_value(type, static_cast<int64_t>(a * b));
+		case BinaryOp::Plus: return int_value(type, static_cast<int64_t>(a + b));
+		case BinaryOp::Minus: return int_value(type, static_cast<int64_t>(a - b));
+		case BinaryOp::Divide:
+		case BinaryOp::Modulo:
+			if (rhs == 0) {
+				throw TypeError(expr.line_num, expr.column_num, "division by zero in a constant expression");
+			}
+			if (lhs == min && rhs == -1) {
+				throw TypeError(expr.line_num, expr.column_num, std::string("the division in a constant expression overflows the type ") + var_type_to_str(type));
+			}
+			return int_value(type, expr.op == BinaryOp::Divide ? lhs / rhs : lhs % rhs);
+		case BinaryOp::Less: return bool_value(lhs < rhs);
+		case BinaryOp::LessEqual: return bool_value(lhs <= rhs);
+		case BinaryOp::Greater: return bool_value(lhs > rhs);
+		case BinaryOp::GreaterEqual: return bool_value(lhs >= rhs);
+		case BinaryOp::Equals: return bool_value(lhs == rhs);
+		case BinaryOp::NotEquals: return bool_value(lhs != rhs);
+		case BinaryOp::And: return bool_value(lhs != 0 && rhs != 0);
+		case BinaryOp::Or: return bool_value(lhs != 0 || rhs != 0);
+	}
+
+	throw std::logic_error(std::string("no constant folding for the operator ") + binary_op_to_str(expr.op));
+}
+
+// A float operation is done in float precision, so that it rounds as the generated code does
+static ConstantValue fold_floating_op(const BinaryExpr& expr, VarType type, double lhs, double rhs) {
+	if (type == VarType::Float) {
+		float a = static_cast<float>(lhs);
+		float b = static_cast<float>(rhs);
+		switch (expr.op) {
+			case BinaryOp::Multiply: return float_value(type, a * b);
+			case BinaryOp::Divide: return float_value(type, a / b);
+			case BinaryOp::Plus: return float_value(type, a + b);
+			case BinaryOp::Minus: return float_value(type, a - b);
+			default: break;
+		}
+	}
+
+	switch (expr.op) {
+		case BinaryOp::Multiply: return float_value(type, lhs * rhs);
+		case BinaryOp::Divide: return float_value(type, lhs / rhs);
+		case BinaryOp::Plus: return float_value(type, lhs + rhs);
+		case BinaryOp::Minus: return float_value(type, lhs - rhs);
+		// Ordered comparisons, so any comparison with NaN is false, "!=" included
+		case BinaryOp::Less: return bool_value(lhs < rhs);
+		case BinaryOp::LessEqual: return bool_value(lhs <= rhs);
+		case BinaryOp::Greater: return bool_value(lhs > rhs);
+		case BinaryOp::GreaterEqual: return bool_value(lhs >= rhs);
+		case BinaryOp::Equals: return bool_value(lhs == rhs);
+		case BinaryOp::NotEquals: return bool_value(lhs < rhs || lhs > rhs);
+		default: break;
+	}
+
+	throw std::logic_error(std::string("no constant folding for the operator ") + binary_op_to_str(expr.op));
+}
+
+static ConstantValue fold(const Expr& expr, const ConstantMap& constants) {
+	switch (expr.kind) {
+		case NodeKind::IntExpr:
+			return int_value(*expr.type, static_cast<const IntExpr&>(expr).value);
+
+		case NodeKind::FloatExpr:
+			return float_value(*expr.type, static_cast<const FloatExpr&>(expr).value);
+
+		case NodeKind::BoolExpr:
+			return bool_value(static_cast<const BoolExpr&>(expr).value);
+
+		case NodeKind::IdentifierExpr: {
+			auto& identifier_expr = static_cast<const IdentifierExpr&>(expr);
+			auto constant = constants.find(identifier_expr.name);
+			if (constant == constants.end()) {
+				throw TypeError(
+					identifier_expr.line_num,
+					identifier_expr.column_num,
+					"\"" + identifier_expr.name + "\" is not a constant, so cannot be used in a constant expression"
+				);
+			}
+			return constant->second;
+		}
+
+		case NodeKind::UnaryExpr: {
+			auto& unary_expr = static_cast<const UnaryExpr&>(expr);
+			ConstantValue operand = fold_constant(*unary_expr.operand, constants);
+			if (unary_expr.op == UnaryOp::Not) {
+				return bool_value(operand.i == 0);
+			}
+			if (operand.type == VarType::Float || operand.type == VarType::Double) {
+				return float_value(operand.type, -operand.f);
+			}
+			return int_value(operand.type, static_cast<int64_t>(0 - static_cast<uint64_t>(operand.i)));
+		}
+
+		case NodeKind::BinaryExpr: {
+			auto& binary_expr = static_cast<const BinaryExpr&>(expr);
+			ConstantValue lhs = fold_constant(*binary_expr.first_operand, constants);
+			ConstantValue rhs = fold_constant(*binary_expr.second_operand, constants);
+			if (lhs.type == VarType::Float || lhs.type == VarType::Double) {
+				return fold_floating_op(binary_expr, lhs.type, lhs.f, rhs.f);
+			}
+			return fold_integer_op(binary_expr, lhs.type, lhs.i, rhs.i);
+		}
+
+		default:
+			throw TypeError(expr.get_line_num(), expr.get_column_num(), "only literals, constants and operators can be used in a constant expression");
+	}
+}
+
+ConstantValue fold_constant(const Expr& expr, const ConstantMap& constants) {
+	ConstantValue value = fold(expr, constants);
+	return convert(value, expr.coerced_type ? *expr.coerced_type : *expr.type);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include "../ast/declaration.hpp"
+
+using namespace ast::declaration;
+
+// The value of every scalar constant in scope, by name
+using ConstantMap = std::unordered_map<std::string, ConstantValue>;
+
+// Evaluates a type checked expression at compile time, as the type it is coerced to, giving the same value
+// the generated code and the bytecode would. Only literals, the constants in the map and the operators
+// applied to them are constant. Throws TypeError if the expression is not constant, or if it divides by
+// zero or overflows a division, which would be undefined behaviour at run time.
+ConstantValue fold_constant(const Expr& expr, const ConstantMap& constants);
@@ -0,0 +1,78 @@
+#include "inline_cost.hpp"
+
+using namespace ast::flat;
+
+void InlineCostModel::analyse(const FlatAst& ast) {
+	// The program is the first node, with its declarations chained from "second"
+	for (NodeId decl = ast.second[0]; decl != NO_NODE; decl = ast.next[decl]) {
+		if (ast.kinds[decl] == NodeKind::FuncDecl) {
+			this->analyse_function(ast, decl);
+		}
+	}
+}
+
+void InlineCostModel::analyse_function(const FlatAst& ast, NodeId func_decl) {
+	const std::string& name = ast.name(func_decl);
+	this->functions.push_back(name);
+	InlineDecision& decision = this->decisions[name];
+
+	NodeId body = ast.second[func_decl];
+	if (body == NO_NODE) {
+		decision.reason = "its body was not parsed";
+		return;
+	}
+
+	bool calls_itself = false;
+	for (NodeId node = body; node < ast.end[body]; node++) {
+		switch (ast.kinds[node]) {
+			// Only what they contain is counted
+			case NodeKind::Block:
+			case NodeKind::ExprStmt:
+				break;
+
+			case NodeKind::FuncCallExpr: {
+				const std::string& callee_name = ast.name(node);
+				if (callee_name == name) {
+					calls_itself = true;
+				}
+
+				auto callee = this->decisions.find(callee_name);
+				if (callee != this->decisions.end() && callee->second.inlined) {
+					decision.cost += callee->second.cost;
+				} else {
+					decision.cost++;
+				}
+				break;
+			}
+
+			// Every other statement, expression and local declaration
+			default:
+				decision.cost++;
+				break;
+		}
+	}
+
+	bool is_inline = (ast.flags[func_decl] & FLAG_INLINE) != 0;
+	unsigned int limit = is_inline ? INLINE_FUNCTION_COST : SMALL_FUNCTION_COST;
+	if (calls_itself) {
+		decision.reason = "it calls itself";
+	} else if (decision.cost > limit) {
+		decision.reason = "it costs more than " + std::to_string(limit);
+	} else {
+		decision.inlined = true;
+		decision.reason = is_inline ? "it is declared inline" : "it is small";
+	}
+}
+
+bool InlineCostModel::is_inlined(const std::string& name) const {
+	auto decision = this->decisions.find(name);
+	return decision != this->decisions.end() && decision->second.inlined;
+}
+
+void InlineCostModel::print_report(std::ostream& os) const {
+	for (auto& name : this->functions) {
+		const InlineDecision& decision = this->decisions.at(name);
+		os << "inline: " << name << " (cost " << decision.cost << "): "
+			<< (decision.inlined ? "inlined" : "not inlined") << ", as " << decision.reason << std::endl;
+	}
+}
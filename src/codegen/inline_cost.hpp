@@ -0,0 +1,48 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../ast/flat_ast.hpp"
+
+// A function no larger than this is inlined whether or not it is declared inline, and one declared inline
+// is inlined up to the larger limit
+const unsigned int SMALL_FUNCTION_COST = 16;
+const unsigned int INLINE_FUNCTION_COST = 128;
+
+struct InlineDecision {
+	bool inlined = false;
+	unsigned int cost = 0;
+	std::string reason;
+};
+
+// Decides which functions have their body copied into every call, once the TypeChecker has run. Both the
+// CodeGenerator (as alwaysinline) and the BytecodeCompiler follow the same decisions, so calls to small
+// functions cost nothing at any optimisation level, and in the interpreter. The caller analyses the
+// program once and gives both the result.
+//
+// The cost of a function is the number of statements and expressions in its body, with a call to a
+// function that is itself inlined costing as much as that function. A function can only call those
+// declared before it, so the cost of every callee is known by the time it is called. A function that
+// calls itself is never inlined, nor is one whose body has not been parsed (see FuncDecl::body).
+//
+// Works on the flat AST, where the body of a function is a contiguous range of nodes, so each cost is a
+// single linear scan.
+class InlineCostModel {
+public:
+	void analyse(const ast::flat::FlatAst& ast);
+
+	bool is_inlined(const std::string& name) const;
+
+	// Prints the decision for every function, in the order they are declared, one per line
+	void print_report(std::ostream& os) const;
+
+	// Filled in by analyse, for every function
+	std::unordered_map<std::string, InlineDecision> decisions;
+
+private:
+	void analyse_function(const ast::flat::FlatAst& ast, ast::flat::NodeId func_decl);
+
+	std::vector<std::string> functions; // in the order they are declared
+};
@@ -0,0 +1,75 @@
+#include "intrinsics.hpp"
+
+struct MathFunction {
+	const char* name;
+	ReturnType type; // of the result and every parameter
+	unsigned int num_params;
+	llvm::Intrinsic::ID intrinsic;
+};
+
+// fmin and fmax return the other operand if one is NaN, as minnum and maxnum do
+static const MathFunction MATH_FUNCTIONS[] = {
+	{ "sqrtf",      ReturnType::Float,  1, llvm::Intrinsic::sqrt },
+	{ "sqrt",       ReturnType::Double, 1, llvm::Intrinsic::sqrt },
+	{ "fabsf",      ReturnType::Float,  1, llvm::Intrinsic::fabs },
+	{ "fabs",       ReturnType::Double, 1, llvm::Intrinsic::fabs },
+	{ "sinf",       ReturnType::Float,  1, llvm::Intrinsic::sin },
+	{ "sin",        ReturnType::Double, 1, llvm::Intrinsic::sin },
+	{ "cosf",       ReturnType::Float,  1, llvm::Intrinsic::cos },
+	{ "cos",        ReturnType::Double, 1, llvm::Intrinsic::cos },
+	{ "expf",       ReturnType::Float,  1, llvm::Intrinsic::exp },
+	{ "exp",        ReturnType::Double, 1, llvm::Intrinsic::exp },
+	{ "exp2f",      ReturnType::Float,  1, llvm::Intrinsic::exp2 },
+	{ "exp2",       ReturnType::Double, 1, llvm::Intrinsic::exp2 },
+	{ "logf",       ReturnType::Float,  1, llvm::Intrinsic::log },
+	{ "log",        ReturnType::Double, 1, llvm::Intrinsic::log },
+	{ "log2f",      ReturnType::Float,  1, llvm::Intrinsic::log2 },
+	{ "log2",       ReturnType::Double, 1, llvm::Intrinsic::log2 },
+	{ "log10f",     ReturnType::Float,  1, llvm::Intrinsic::log10 },
+	{ "log10",      ReturnType::Double, 1, llvm::Intrinsic::log10 },
+	{ "floorf",     ReturnType::Float,  1, llvm::Intrinsic::floor },
+	{ "floor",      ReturnType::Double, 1, llvm::Intrinsic::floor },
+	{ "ceilf",      ReturnType::Float,  1, llvm::Intrinsic::ceil },
+	{ "ceil",       ReturnType::Double, 1, llvm::Intrinsic::ceil },
+	{ "truncf",     ReturnType::Float,  1, llvm::Intrinsic::trunc },
+	{ "trunc",      ReturnType::Double, 1, llvm::Intrinsic::trunc },
+	{ "roundf",     ReturnType::Float,  1, llvm::Intrinsic::round },
+	{ "round",      ReturnType::Double, 1, llvm::Intrinsic::round },
+	{ "rintf",      ReturnType::Float,  1, llvm::Intrinsic::rint },
+	{ "rint",       ReturnType::Double, 1, llvm::Intrinsic::rint },
+	{ "nearbyintf", ReturnType::Float,  1, llvm::Intrinsic::nearbyint },
+	{ "nearbyint",  ReturnType::Double, 1, llvm::Intrinsic::nearbyint },
+	{ "powf",       ReturnType::Float,  2, llvm::Intrinsic::pow },
+	{ "pow",        ReturnType::Double, 2, llvm::Intrinsic::pow },
+	{ "fminf",      ReturnType::Float,  2, llvm::Intrinsic::minnum },
+	{ "fmin",       ReturnType::Double, 2, llvm::Intrinsic::minnum },
+	{ "fmaxf",      ReturnType::Float,  2, llvm::Intrinsic::maxnum },
+	{ "fmax",       ReturnType::Double, 2, llvm::Intrinsic::maxnum },
+	{ "copysignf",  ReturnType::Float,  2, llvm::Intrinsic::copysign },
+	{ "copysign",   ReturnType::Double, 2, llvm::Intrinsic::copysign },
+	{ "fmaf",       ReturnType::Float,  3, llvm::Intrinsic::fma },
+	{ "fma",        ReturnType::Double, 3, llvm::Intrinsic::fma },
+};
+
+boost::optional<llvm::Intrinsic::ID> math_intrinsic(const ExternDecl& extern_decl) {
+	for (auto& function : MATH_FUNCTIONS) {
+		if (extern_decl.name != function.name || extern_decl.return_type != function.type) {
+			continue;
+		}
+
+		unsigned int num_params = 0;
+		for (auto& param : extern_decl.params) {
+			if (param->type != static_cast<VarType>(function.type)) {
+				return boost::none;
+			}
+			num_params++;
+		}
+
+		if (num_params != function.num_params) {
+			return boost::none;
+		}
+		return function.intrinsic;
+	}
+
+	return boost::none;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <llvm/IR/Intrinsics.h>
+#include <boost/optional.hpp>
+#include "../ast/declaration.hpp"
+
+using namespace ast::declaration;
+
+// The LLVM intrinsic that computes the same as an extern, if the extern is one of the C math library's
+// functions (sqrtf, fabs, fminf, ...) declared with its C signature, in float or double. Calls to such an
+// extern are made to the intrinsic instead, which the optimizer can constant fold and vectorize, and the
+// backend lowers to an instruction where the target has one, or else to a call to the same function.
+boost::optional<llvm::Intrinsic::ID> math_intrinsic(const ExternDecl& extern_decl);
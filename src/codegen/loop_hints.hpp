@@ -0,0 +1,12 @@
+#pragma once
+
+// Name of the property of a loop's ID that holds the line of its while statement, for remarks
+const char* const LOOP_LINE_METADATA = "minic.loop.line";
+
+// Hints for the optimiser, attached to every loop's ID. 0 leaves the choice to the optimiser, and a
+// vectorize_width of 1 disables vectorization.
+struct LoopHints {
+	unsigned int vectorize_width = 0;
+	unsigned int interleave_count = 0;
+	unsigned int unroll_count = 0;
+};
@@ -8,76 +8,128 @@ using llvm::Value;
 
 // Common Types
 const FuncType T_ALL_INT = FuncType::binary(VarType::Int, VarType::Int, ReturnType::Int);
+const FuncType T_ALL_LONG = FuncType::binary(VarType::Long, VarType::Long, ReturnType::Long);
 const FuncType T_ALL_FLOAT = FuncType::binary(VarType::Float, VarType::Float, ReturnType::Float);
+const FuncType T_ALL_DOUBLE = FuncType::binary(VarType::Double, VarType::Double, ReturnType::Double);
 const FuncType T_ALL_BOOL = FuncType::binary(VarType::Bool, VarType::Bool, ReturnType::Bool);
 const FuncType T_INT_CMP = FuncType::binary(VarType::Int, VarType::Int, ReturnType::Bool);
+const FuncType T_LONG_CMP = FuncType::binary(VarType::Long, VarType::Long, ReturnType::Bool);
 const FuncType T_FLOAT_CMP = FuncType::binary(VarType::Float, VarType::Float, ReturnType::Bool);
+const FuncType T_DOUBLE_CMP = FuncType::binary(VarType::Double, VarType::Double, ReturnType::Bool);
+const FuncType T_ALL_INT4 = FuncType::binary(VarType::Int4, VarType::Int4, ReturnType::Int4);
+const FuncType T_ALL_INT8 = FuncType::binary(VarType::Int8, VarType::Int8, ReturnType::Int8);
+const FuncType T_ALL_FLOAT4 = FuncType::binary(VarType::Float4, VarType::Float4, ReturnType::Float4);
+const FuncType T_ALL_FLOAT8 = FuncType::binary(VarType::Float8, VarType::Float8, ReturnType::Float8);
+
+// The entries of each table are in order of preference: when no entry matches the operand types exactly,
+// the TypeChecker takes the first one they can be widened to, so the narrowest types come first. Vector
+// arithmetic applies the scalar instruction to every lane, and comes after the scalar types, so that a
+// scalar operand is only made into a vector when the other is one.
 
 
 // BinaryOp::Multiply
 const OpTable MULTIPLY_OP_TABLE({
-	{ T_ALL_INT,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateMul(lhs, rhs); } },
-	{ T_ALL_FLOAT, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFMul(lhs, rhs); } }
+	{ T_ALL_INT,    [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateMul(lhs, rhs); } },
+	{ T_ALL_LONG,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateMul(lhs, rhs); } },
+	{ T_ALL_FLOAT,  [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFMul(lhs, rhs); } },
+	{ T_ALL_DOUBLE, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFMul(lhs, rhs); } },
+	{ T_ALL_INT4,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateMul(lhs, rhs); } },
+	{ T_ALL_INT8,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateMul(lhs, rhs); } },
+	{ T_ALL_FLOAT4, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFMul(lhs, rhs); } },
+	{ T_ALL_FLOAT8, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFMul(lhs, rhs); } }
 });
 
 // BinaryOp::Divide
 const OpTable DIVIDE_OP_TABLE({
-	{ T_ALL_INT,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateSDiv(lhs, rhs); } },
-	{ T_ALL_FLOAT, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFDiv(lhs, rhs); } }
+	{ T_ALL_INT,    [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateSDiv(lhs, rhs); } },
+	{ T_ALL_LONG,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateSDiv(lhs, rhs); } },
+	{ T_ALL_FLOAT,  [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFDiv(lhs, rhs); } },
+	{ T_ALL_DOUBLE, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFDiv(lhs, rhs); } },
+	{ T_ALL_INT4,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateSDiv(lhs, rhs); } },
+	{ T_ALL_INT8,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateSDiv(lhs, rhs); } },
+	{ T_ALL_FLOAT4, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFDiv(lhs, rhs); } },
+	{ T_ALL_FLOAT8, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFDiv(lhs, rhs); } }
 });
 
 // BinaryOp::Modulo
 const OpTable MODULO_OP_TABLE({
-	{ T_ALL_INT, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateSRem(lhs, rhs); } }
+	{ T_ALL_INT,    [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateSRem(lhs, rhs); } },
+	{ T_ALL_LONG,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateSRem(lhs, rhs); } },
+	{ T_ALL_INT4,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateSRem(lhs, rhs); } },
+	{ T_ALL_INT8,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateSRem(lhs, rhs); } }
 });
 
 // BinaryOp::Plus
 const OpTable PLUS_OP_TABLE({
-	{ T_ALL_INT,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateAdd(lhs, rhs); } },
-	{ T_ALL_FLOAT, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFAdd(lhs, rhs); } }
+	{ T_ALL_INT,    [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateAdd(lhs, rhs); } },
+	{ T_ALL_LONG,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateAdd(lhs, rhs); } },
+	{ T_ALL_FLOAT,  [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFAdd(lhs, rhs); } },
+	{ T_ALL_DOUBLE, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFAdd(lhs, rhs); } },
+	{ T_ALL_INT4,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateAdd(lhs, rhs); } },
+	{ T_ALL_INT8,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateAdd(lhs, rhs); } },
+	{ T_ALL_FLOAT4, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFAdd(lhs, rhs); } },
+	{ T_ALL_FLOAT8, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFAdd(lhs, rhs); } }
 });
 
 // BinaryOp::Minus
 const OpTable MINUS_OP_TABLE({
-	{ T_ALL_INT,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateSub(lhs, rhs); } },
-	{ T_ALL_FLOAT, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFSub(lhs, rhs); } }
+	{ T_ALL_INT,    [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateSub(lhs, rhs); } },
+	{ T_ALL_LONG,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateSub(lhs, rhs); } },
+	{ T_ALL_FLOAT,  [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFSub(lhs, rhs); } },
+	{ T_ALL_DOUBLE, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFSub(lhs, rhs); } },
+	{ T_ALL_INT4,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateSub(lhs, rhs); } },
+	{ T_ALL_INT8,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateSub(lhs, rhs); } },
+	{ T_ALL_FLOAT4, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFSub(lhs, rhs); } },
+	{ T_ALL_FLOAT8, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFSub(lhs, rhs); } }
 });
 
 // BinaryOp::Less
 const OpTable LESS_OP_TABLE({
-	{ T_INT_CMP,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpSLT(lhs, rhs); } },
-	{ T_FLOAT_CMP, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFCmpOLT(lhs, rhs); } }
+	{ T_INT_CMP,    [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpSLT(lhs, rhs); } },
+	{ T_LONG_CMP,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpSLT(lhs, rhs); } },
+	{ T_FLOAT_CMP,  [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFCmpOLT(lhs, rhs); } },
+	{ T_DOUBLE_CMP, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFCmpOLT(lhs, rhs); } }
 });
 
 // BinaryOp::LessEqual
 const OpTable LESS_EQUAL_OP_TABLE({
-	{ T_INT_CMP,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpSLE(lhs, rhs); } },
-	{ T_FLOAT_CMP, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFCmpOLE(lhs, rhs); } }
+	{ T_INT_CMP,    [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpSLE(lhs, rhs); } },
+	{ T_LONG_CMP,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpSLE(lhs, rhs); } },
+	{ T_FLOAT_CMP,  [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFCmpOLE(lhs, rhs); } },
+	{ T_DOUBLE_CMP, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFCmpOLE(lhs, rhs); } }
 });
 
 // BinaryOp::Greater
 const OpTable GREATER_OP_TABLE({
-	{ T_INT_CMP,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpSGT(lhs, rhs); } },
-	{ T_FLOAT_CMP, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFCmpOGT(lhs, rhs); } }
+	{ T_INT_CMP,    [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpSGT(lhs, rhs); } },
+	{ T_LONG_CMP,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpSGT(lhs, rhs); } },
+	{ T_FLOAT_CMP,  [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFCmpOGT(lhs, rhs); } },
+	{ T_DOUBLE_CMP, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFCmpOGT(lhs, rhs); } }
 });
 
 // BinaryOp::GreaterEqual
 const OpTable GREATER_EQUAL_OP_TABLE({
-	{ T_INT_CMP,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpSGE(lhs, rhs); } },
-	{ T_FLOAT_CMP, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFCmpOGE(lhs, rhs); } }
+	{ T_INT_CMP,    [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpSGE(lhs, rhs); } },
+	{ T_LONG_CMP,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpSGE(lhs, rhs); } },
+	{ T_FLOAT_CMP,  [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFCmpOGE(lhs, rhs); } },
+	{ T_DOUBLE_CMP, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFCmpOGE(lhs, rhs); } }
 });
 
 // BinaryOp::Equals
 const OpTable EQUALS_OP_TABLE({
-	{ T_INT_CMP,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpEQ(lhs, rhs); } },
-	{ T_FLOAT_CMP, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFCmpOEQ(lhs, rhs); } },
+	{ T_INT_CMP,    [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpEQ(lhs, rhs); } },
+	{ T_LONG_CMP,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpEQ(lhs, rhs); } },
+	{ T_FLOAT_CMP,  [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFCmpOEQ(lhs, rhs); } },
+	{ T_DOUBLE_CMP, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFCmpOEQ(lhs, rhs); } },
 	{ T_ALL_BOOL,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpEQ(lhs, rhs); } }
 });
 
 // BinaryOp::NotEquals
 const OpTable NOT_EQUALS_OP_TABLE({
-	{ T_INT_CMP,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpNE(lhs, rhs); } },
-	{ T_FLOAT_CMP, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFCmpONE(lhs, rhs); } },
+	{ T_INT_CMP,    [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpNE(lhs, rhs); } },
+	{ T_LONG_CMP,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpNE(lhs, rhs); } },
+	{ T_FLOAT_CMP,  [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFCmpONE(lhs, rhs); } },
+	{ T_DOUBLE_CMP, [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateFCmpONE(lhs, rhs); } },
 	{ T_ALL_BOOL,   [](Builder builder, Value* lhs, Value* rhs) { return builder.CreateICmpNE(lhs, rhs); } }
 });
 
@@ -32,6 +32,34 @@ boost::optional<VarType> Scope::lookup_variable_type(const std::string& s) {
 	return boost::none;
 }
 
+llvm::Value* Scope::lookup_array_length(const std::string& s) {
+	for (auto it = this->frames.rbegin();
+	          it != this->frames.rend();
+		  it++) {
+		
+		auto map_iter = it->find(s);
+		if (map_iter != it->end()) {
+			return map_iter->second.length;
+		}
+	}
+
+	return nullptr;
+}
+
+bool Scope::lookup_is_const(const std::string& s) {
+	for (auto it = this->frames.rbegin();
+	          it != this->frames.rend();
+		  it++) {
+		
+		auto map_iter = it->find(s);
+		if (map_iter != it->end()) {
+			return map_iter->second.is_const;
+		}
+	}
+
+	return false;
+}
+
 boost::optional<std::pair<ReturnType, std::forward_list<VarType>>> Scope::lookup_func_type(const std::string& s) {
 	auto map_iter = this->func_types.find(s);
 	if (map_iter != this->func_types.end()) {
@@ -49,8 +77,12 @@ void Scope::pop_scope() {
 	this->frames.pop_back();
 }
 
-void Scope::register_var(const std::string& name, llvm::Value* value, VarType type) {
-	this->frames.back().insert({ name, { value, type } });
+size_t Scope::depth() const {
+	return this->frames.size();
+}
+
+void Scope::register_var(const std::string& name, llvm::Value* value, VarType type, llvm::Value* length, bool is_const) {
+	this->frames.back().insert({ name, { value, type, length, is_const } });
 }
 
 void Scope::register_func_type(const std::string& name, ReturnType ret_type, std::forward_list<VarType> param_types) {
@@ -14,6 +14,8 @@ using namespace ast::declaration;
 struct VariableEntry {
 	llvm::Value* val;
 	VarType type;
+	llvm::Value* length; // the number of elements, for arrays
+	bool is_const; // a global declared "const", which cannot be assigned
 };
 
 class Scope {
@@ -21,10 +23,13 @@ public:
 	Scope();
 	llvm::Value* lookup_variable_val(const std::string& s);
 	boost::optional<VarType> lookup_variable_type(const std::string& s);
+	llvm::Value* lookup_array_length(const std::string& s);
+	bool lookup_is_const(const std::string& s);
 	boost::optional<std::pair<ReturnType, std::forward_list<VarType>>> lookup_func_type(const std::string& s);
 	void push_scope();
 	void pop_scope();
-	void register_var(const std::string& name, llvm::Value* value, VarType);
+	size_t depth() const;
+	void register_var(const std::string& name, llvm::Value* value, VarType, llvm::Value* length = nullptr, bool is_const = false);
 	void register_func_type(const std::string& name, ReturnType ret_type, std::forward_list<VarType> param_types);
 	bool function_exists(const std::string& name);
 
@@ -0,0 +1,595 @@
+#include "type_checker.hpp"
+#include "builtins.hpp"
+#include "ops.hpp"
+#include "type_coerce.hpp"
+#include "type_error.hpp"
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+using namespace ast::declaration;
+
+boost::optional<VarType> return_type_to_var_type(ReturnType ret_type) {
+	switch (ret_type) {
+		case ReturnType::Void: return boost::none;
+		case ReturnType::Int: return VarType::Int;
+		case ReturnType::Float: return VarType::Float;
+		case ReturnType::Bool: return VarType::Bool;
+		case ReturnType::Long: return VarType::Long;
+		case ReturnType::Double: return VarType::Double;
+		case ReturnType::Int4: return VarType::Int4;
+		case ReturnType::Int8: return VarType::Int8;
+		case ReturnType::Float4: return VarType::Float4;
+		case ReturnType::Float8: return VarType::Float8;
+	}
+}
+
+// Whether an expression is made only of number literals, negation and arithmetic
+static bool is_literal_arithmetic(const Expr& expr) {
+	switch (expr.kind) {
+		case NodeKind::IntExpr:
+		case NodeKind::FloatExpr:
+			return true;
+
+		case NodeKind::UnaryExpr: {
+			auto& unary_expr = static_cast<const UnaryExpr&>(expr);
+			return unary_expr.op == UnaryOp::Negate && is_literal_arithmetic(*unary_expr.operand);
+		}
+
+		case NodeKind::BinaryExpr: {
+			auto& binary_expr = static_cast<const BinaryExpr&>(expr);
+			switch (binary_expr.op) {
+				case BinaryOp::Multiply:
+				case BinaryOp::Divide:
+				case BinaryOp::Plus:
+				case BinaryOp::Minus:
+					return is_literal_arithmetic(*binary_expr.first_operand) && is_literal_arithmetic(*binary_expr.second_operand);
+				default:
+					return false;
+			}
+		}
+
+		default:
+			return false;
+	}
+}
+
+// Retypes a float expression of literals as double, with its integer parts converted to double instead
+static void widen_literal_arithmetic(const Expr& expr) {
+	if (*expr.type != VarType::Float) {
+		expr.coerced_type = VarType::Double;
+		return;
+	}
+
+	expr.type = VarType::Double;
+	expr.coerced_type = VarType::Double;
+	if (expr.kind == NodeKind::UnaryExpr) {
+		widen_literal_arithmetic(*static_cast<const UnaryExpr&>(expr).operand);
+	} else if (expr.kind == NodeKind::BinaryExpr) {
+		auto& binary_expr = static_cast<const BinaryExpr&>(expr);
+		widen_literal_arithmetic(*binary_expr.first_operand);
+		widen_literal_arithmetic(*binary_expr.second_operand);
+	}
+}
+
+// Gives a float literal, or arithmetic on nothing but literals, the type double, so that one used as a
+// double keeps the precision it was written with rather than being computed as a float first. Anything
+// that reads a float variable or calls a function is still computed as a float and only then widened,
+// so "f * 0.1" used as a double multiplies two floats; declare f double for a double result.
+static bool make_double_literal(const Expr& expr) {
+	if (*expr.type != VarType::Float || !is_literal_arithmetic(expr)) {
+		return false;
+	}
+
+	widen_literal_arithmetic(expr);
+	return true;
+}
+
+void TypeChecker::visit_program(const Program& program) {
+	for (auto& ext : program.externs) {
+		this->check_decl(*ext);
+	}
+
+	for (auto& decl : program.decls) {
+		this->check_decl(*decl);
+	}
+}
+
+void TypeChecker::check_decl(const Declaration& decl) {
+	size_t global_depth = this->scope.depth();
+
+	try {
+		this->dispatch(decl);
+	} catch (const TypeError& e) {
+		this->errors.push_back(e);
+
+		// Unwind whatever the failed declaration left behind
+		while (this->scope.depth() > global_depth) {
+			this->scope.pop_scope();
+		}
+		this->return_called = false;
+	}
+}
+
+void TypeChecker::register_func(const std::string& name, ReturnType return_type, const std::forward_list<std::unique_ptr<Param>>& params, unsigned int line_num, unsigned int column_num) {
+	if (builtin_from_name(name)) {
+		throw TypeError(
+			line_num,
+			column_num,
+			std::string("\"") + name + "\" is a builtin function, so cannot be declared"
+		);
+	}
+	if (this->scope.function_exists(name)) {
+		throw TypeError(
+			line_num,
+			column_num,
+			std::string("a function called \"") + name + "\" has already been declared"
+		);
+	}
+
+	std::forward_list<VarType> param_type_fl;
+	for (auto& param : params) {
+		param_type_fl.push_front(param->type);
+	}
+	param_type_fl.reverse();
+	this->scope.register_func_type(name, return_type, param_type_fl);
+}
+
+void TypeChecker::visit_extern_decl(const ExternDecl& extern_decl) {
+	this->register_func(extern_decl.name, extern_decl.return_type, extern_decl.params, extern_decl.line_num, extern_decl.column_num);
+}
+
+void TypeChecker::visit_var_decl(const VarDecl& var_decl) {
+	// Registered afterwards, so that the initializer cannot refer to the variable itself
+	this->check_initializer(var_decl);
+	this->scope.register_var(var_decl.name, nullptr, var_decl.type, nullptr, var_decl.is_const);
+
+	if (var_decl.is_const && !is_array_type(var_decl.type)) {
+		this->constants[var_decl.name] = var_decl.initial_values.front();
+	}
+}
+
+// Checks and folds each expression in a global's initializer, as the type of the variable or its elements
+void TypeChecker::check_initializer(const VarDecl& var_decl) {
+	var_decl.initial_values.clear();
+	if (var_decl.initializer.empty()) {
+		return;
+	}
+
+	auto& first = *var_decl.initializer.front();
+	VarType type = is_array_type(var_decl.type) ? element_type(var_decl.type) : var_decl.type;
+	if (is_vector_type(type)) {
+		throw TypeError(
+			first.get_line_num(),
+			first.get_column_num(),
+			std::string("the global \"") + var_decl.name + "\" is of the vector type " + var_type_to_str(var_decl.type) + ", which cannot be initialized"
+		);
+	}
+
+	for (auto& expr : var_decl.initializer) {
+		if (is_array_type(var_decl.type) && var_decl.initial_values.size() == var_decl.array_size) {
+			throw TypeError(
+				expr->get_line_num(),
+				expr->get_column_num(),
+				std::string("the array \"") + var_decl.name + "\" has " + std::to_string(var_decl.array_size) + " elements, but is initialized with more"
+			);
+		}
+
+		this->dispatch(*expr);
+		VarType actual_type = this->check_value(*expr, expr->get_line_num(), expr->get_column_num(), "as an initializer");
+		if (!coerce_type(actual_type, type)) {
+			throw TypeError(
+				expr->get_line_num(),
+				expr->get_column_num(),
+				std::string("cannot initialize the global \"") + var_decl.name + "\" of type " + var_type_to_str(var_decl.type) + " with a value of type " + var_type_to_str(actual_type)
+			);
+		}
+
+		this->coerce(*expr, type);
+		var_decl.initial_values.push_back(fold_constant(*expr, this->constants));
+	}
+}
+
+void TypeChecker::visit_func_decl(const FuncDecl& func_decl) {
+	this->register_func(func_decl.name, func_decl.return_type, func_decl.params, func_decl.line_num, func_decl.column_num);
+
+	// Only the signature is known for a deferred body that was never parsed
+	if (func_decl.body == nullptr) {
+		return;
+	}
+
+	this->current_return_type = func_decl.return_type;
+
+	this->scope.push_scope();
+	for (auto& param : func_decl.params) {
+		this->scope.register_var(param->name, nullptr, param->type);
+	}
+
+	this->check_block(*func_decl.body);
+
+	if (!this->return_called && func_decl.return_type != ReturnType::Void) {
+		throw TypeError(func_decl.line_num, func_decl.column_num, std::string("the non-void function \"") + func_decl.name + "\" does not end in a return statement");
+	}
+	this->return_called = false;
+
+	this->scope.pop_scope();
+}
+
+void TypeChecker::check_block(const Block& block) {
+	for (auto& local_decl : block.var_decls) {
+		this->visit_local_decl(*local_decl);
+	}
+
+	// Statements after a return are never generated, so they are not checked either
+	for (auto& stmt : block.statements) {
+		this->dispatch(*stmt);
+		if (this->return_called) {
+			break;
+		}
+	}
+}
+
+void TypeChecker::visit_block(const Block& block) {
+	this->scope.push_scope();
+
+	this->check_block(block);
+
+	this->scope.pop_scope();
+}
+
+void TypeChecker::visit_local_decl(const VarDecl& local_decl) {
+	this->scope.register_var(local_decl.name, nullptr, local_decl.type);
+}
+
+void TypeChecker::visit_expr_stmt(const ExprStmt& expr_stmt) {
+	if (expr_stmt.expr == nullptr) return;
+
+	this->dispatch(*expr_stmt.expr);
+}
+
+void TypeChecker::visit_return_stmt(const Return& ret_stmt) {
+	if (ret_stmt.return_val == nullptr) {
+		if (this->current_return_type != ReturnType::Void) {
+			throw TypeError(ret_stmt.line_num, ret_stmt.column_num, "return statements for non-void functions must have an associated return value");
+		}
+	} else {
+		this->dispatch(*ret_stmt.return_val);
+		VarType return_val_type = this->check_value(*ret_stmt.return_val, ret_stmt.line_num, ret_stmt.column_num, "as a return value");
+		auto return_type = return_type_to_var_type(this->current_return_type);
+		if (!return_type || !coerce_type(return_val_type, *return_type)) {
+			throw TypeError(
+				ret_stmt.line_num,
+				ret_stmt.column_num,
+				std::string("return value of type ")
+					+ var_type_to_str(return_val_type)
+					+ " does not match the return type "
+					+ return_type_to_str(this->current_return_type)
+					+ " of the function"
+			);
+		}
+		this->coerce(*ret_stmt.return_val, *return_type);
+	}
+
+	this->return_called = true;
+}
+
+void TypeChecker::visit_if_else_stmt(const IfElse& if_else_stmt) {
+	this->dispatch(*if_else_stmt.cond);
+	VarType cond_type = this->check_value(*if_else_stmt.cond, if_else_stmt.line_num, if_else_stmt.column_num, "as an if statement condition");
+	if (cond_type != VarType::Bool) {
+		throw TypeError(
+			if_else_stmt.line_num,
+			if_else_stmt.column_num,
+			std::string("if statement condition must be of type bool, but an expression of type ") + var_type_to_str(cond_type) + " was given"
+		);
+	}
+
+	this->scope.push_scope();
+	this->dispatch(*if_else_stmt.if_true);
+	this->return_called = false;
+	this->scope.pop_scope();
+
+	if (if_else_stmt.if_false != nullptr) {
+		this->scope.push_scope();
+		this->dispatch(*if_else_stmt.if_false);
+		this->return_called = false;
+		this->scope.pop_scope();
+	}
+}
+
+void TypeChecker::visit_while_stmt(const While& while_stmt) {
+	this->dispatch(*while_stmt.cond);
+	VarType cond_type = this->check_value(*while_stmt.cond, while_stmt.line_num, while_stmt.column_num, "as a while statement condition");
+	if (cond_type != VarType::Bool) {
+		throw TypeError(
+			while_stmt.line_num,
+			while_stmt.column_num,
+			std::string("while statement condition must be of type bool, but an expression of type ") + var_type_to_str(cond_type) + " was given"
+		);
+	}
+
+	this->scope.push_scope();
+	this->dispatch(*while_stmt.body);
+	this->return_called = false;
+	this->scope.pop_scope();
+}
+
+void TypeChecker::visit_unary_expr(const UnaryExpr& unary_expr) {
+	this->dispatch(*unary_expr.operand);
+
+	VarType expr_type = this->check_value(*unary_expr.operand, unary_expr.line_num, unary_expr.column_num, "as an argument to a unary operator");
+
+	if (unary_expr.op == UnaryOp::Not) {
+		if (expr_type != VarType::Bool) {
+			throw TypeError(unary_expr.line_num, unary_expr.column_num, std::string("Operand to '!' should be a bool, instead encountered a ") + var_type_to_str(expr_type));
+		}
+	} else if (unary_expr.op == UnaryOp::Negate) {
+		if (expr_type == VarType::Bool) {
+			throw TypeError(unary_expr.line_num, unary_expr.column_num, "Operand to '-' should be a numeric type, instead encountered a bool");
+		}
+	}
+
+	unary_expr.type = expr_type;
+}
+
+void TypeChecker::visit_binary_expr(const BinaryExpr& binary_expr) {
+	this->dispatch(*binary_expr.first_operand);
+	VarType lhs_type = this->check_value(*binary_expr.first_operand, binary_expr.line_num, binary_expr.column_num, "as an operand to a binary operator");
+
+	this->dispatch(*binary_expr.second_operand);
+	VarType rhs_type = this->check_value(*binary_expr.second_operand, binary_expr.line_num, binary_expr.column_num, "as an operand to a binary operator");
+
+	const OpTable& op_table = OpTable::for_op(binary_expr.op);
+	std::vector<VarType> actual_operand_types { lhs_type, rhs_type };
+
+	// Prefer an exact match, otherwise take the first entry the operands can be coerced to
+	const FuncType* match = nullptr;
+	for (auto& pair : op_table.entries) {
+		if (pair.first.param_types == actual_operand_types) {
+			match = &pair.first;
+			break;
+		}
+	}
+
+	if (match == nullptr) {
+		for (auto& pair : op_table.entries) {
+			if (coerce_list(actual_operand_types, pair.first.param_types)) {
+				match = &pair.first;
+				break;
+			}
+		}
+	}
+
+	if (match == nullptr) {
+		throw TypeError(
+			binary_expr.line_num,
+			binary_expr.column_num,
+			std::string("operator \"") + ast::expr::binary_op_symbol(binary_expr.op) + "\"",
+			op_table.valid_param_types(),
+			actual_operand_types
+		);
+	}
+
+	this->coerce(*binary_expr.first_operand, match->param_types[0]);
+	this->coerce(*binary_expr.second_operand, match->param_types[1]);
+	binary_expr.type = return_type_to_var_type(match->ret_type);
+}
+
+void TypeChecker::visit_assign_expr(const AssignExpr& assign_expr) {
+	if (this->scope.lookup_is_const(assign_expr.name)) {
+		throw TypeError(
+			assign_expr.line_num,
+			assign_expr.column_num,
+			std::string("cannot assign to the constant ") + assign_expr.name
+		);
+	}
+
+	// The index of an element is evaluated before the value assigned to it
+	if (assign_expr.index != nullptr) {
+		VarType element_type = this->check_array_element(assign_expr.name, *assign_expr.index, assign_expr.line_num, assign_expr.column_num);
+
+		this->dispatch(*assign_expr.expr);
+		VarType actual_type = this->check_value(*assign_expr.expr, assign_expr.line_num, assign_expr.column_num, "as the right hand side of an assignment");
+		if (!coerce_type(actual_type, element_type)) {
+			throw TypeError(
+				assign_expr.line_num,
+				assign_expr.column_num,
+				std::string("cannot assign a value of type ") + var_type_to_str(actual_type) + " to an element of the array " + assign_expr.name + " of type " + var_type_to_str(element_type)
+			);
+		}
+
+		this->coerce(*assign_expr.expr, element_type);
+		assign_expr.type = element_type;
+		return;
+	}
+
+	this->dispatch(*assign_expr.expr);
+
+	VarType actual_type = this->check_value(*assign_expr.expr, assign_expr.line_num, assign_expr.column_num, "as the right hand side of an assignment");
+	if (auto variable_type = this->scope.lookup_variable_type(assign_expr.name)) {
+		if (is_array_type(*variable_type)) {
+			throw TypeError(
+				assign_expr.line_num,
+				assign_expr.column_num,
+				std::string("cannot assign to the array ") + assign_expr.name + ", only to its elements"
+			);
+		}
+		if (!coerce_type(actual_type, *variable_type)) {
+			throw TypeError(
+				assign_expr.line_num,
+				assign_expr.column_num,
+				std::string("cannot assign a value of type ") + var_type_to_str(actual_type) + " to the variable " + assign_expr.name + " of type " + var_type_to_str(*variable_type)
+			);
+		}
+
+		this->coerce(*assign_expr.expr, *variable_type);
+		assign_expr.type = *variable_type;
+	} else {
+		throw TypeError(
+			assign_expr.line_num,
+			assign_expr.column_num,
+			std::string("in assignment, undefined variable \"") + assign_expr.name + "\""
+		);
+	}
+}
+
+void TypeChecker::visit_identifier_expr(const IdentifierExpr& identifier_expr) {
+	auto var_type = this->scope.lookup_variable_type(identifier_expr.name);
+	if (!var_type) {
+		throw TypeError(
+			identifier_expr.line_num,
+			identifier_expr.column_num,
+			std::string("undefined variable \"") + identifier_expr.name + "\""
+		);
+	}
+
+	identifier_expr.type = var_type;
+}
+
+void TypeChecker::visit_index_expr(const IndexExpr& index_expr) {
+	index_expr.type = this->check_array_element(index_expr.name, *index_expr.index, index_expr.line_num, index_expr.column_num);
+}
+
+// Checks the array variable and the index of an element, returning the type of the element. The lanes
+// of a vector variable are indexed in the same way.
+VarType TypeChecker::check_array_element(const std::string& name, const Expr& index, unsigned int line_num, unsigned int column_num) {
+	auto var_type = this->scope.lookup_variable_type(name);
+	if (!var_type) {
+		throw TypeError(line_num, column_num, std::string("undefined array \"") + name + "\"");
+	}
+	if (!is_array_type(*var_type) && !is_vector_type(*var_type)) {
+		throw TypeError(line_num, column_num, std::string("the variable \"") + name + "\" of type " + var_type_to_str(*var_type) + " is not an array or a vector, so cannot be indexed");
+	}
+
+	this->dispatch(index);
+	VarType index_type = this->check_value(index, line_num, column_num, "as an array index");
+	if (index_type != VarType::Int) {
+		throw TypeError(line_num, column_num, std::string("an array index must be of type int, but an expression of type ") + var_type_to_str(index_type) + " was given");
+	}
+
+	return is_vector_type(*var_type) ? lane_type(*var_type) : element_type(*var_type);
+}
+
+void TypeChecker::visit_func_call_expr(const FuncCallExpr& func_call_expr) {
+	// A builtin takes a vector of any type, so it has no single signature in the scope
+	if (builtin_from_name(func_call_expr.func_name)) {
+		auto vector = func_call_expr.params.begin();
+		VarType vector_type = VarType::Int;
+		if (vector != func_call_expr.params.end()) {
+			this->dispatch(**vector);
+			vector_type = this->check_value(**vector, (*vector)->get_line_num(), (*vector)->get_column_num(), "as parameter");
+		}
+
+		if (vector == func_call_expr.params.end() || std::next(vector) != func_call_expr.params.end() || !is_vector_type(vector_type)) {
+			throw TypeError(
+				func_call_expr.line_num,
+				func_call_expr.column_num,
+				std::string("the builtin function \"") + func_call_expr.func_name + "\" takes a single vector"
+			);
+		}
+
+		func_call_expr.type = lane_type(vector_type);
+		return;
+	}
+
+	auto func_type = this->scope.lookup_func_type(func_call_expr.func_name);
+	if (!func_type) {
+		throw TypeError(
+			func_call_expr.line_num,
+			func_call_expr.column_num,
+			std::string("undefined function \"") + func_call_expr.func_name + "\""
+		);
+	}
+
+	std::vector<VarType> actual_param_types;
+	for (auto& param_expr : func_call_expr.params) {
+		this->dispatch(*param_expr);
+		actual_param_types.push_back(this->check_value(*param_expr, param_expr->get_line_num(), param_expr->get_column_num(), "as parameter", true));
+
+		// Array parameters are not const, so the callee could assign the elements
+		if (is_array_type(actual_param_types.back()) && this->scope.lookup_is_const(static_cast<const IdentifierExpr&>(*param_expr).name)) {
+			throw TypeError(
+				param_expr->get_line_num(),
+				param_expr->get_column_num(),
+				std::string("cannot pass the constant array ") + static_cast<const IdentifierExpr&>(*param_expr).name + " to a function, which could assign its elements"
+			);
+		}
+	}
+
+	std::vector<VarType> expected_param_types(func_type->second.begin(), func_type->second.end());
+
+	if (expected_param_types.size() != actual_param_types.size()) {
+		throw TypeError(
+			func_call_expr.line_num,
+			func_call_expr.column_num,
+			std::string("the function \"")
+				+ func_call_expr.func_name
+				+ "\" takes "
+				+ std::to_string(expected_param_types.size())
+				+ " parameters, but "
+				+ std::to_string(actual_param_types.size())
+				+ " were supplied"
+		);
+	}
+
+	if (!coerce_list(actual_param_types, expected_param_types)) {
+		throw TypeError(
+			func_call_expr.line_num,
+			func_call_expr.column_num,
+			std::string("the function \"") + func_call_expr.func_name + "\"",
+			std::vector<std::vector<VarType>> { expected_param_types },
+			actual_param_types
+		);
+	}
+
+	size_t i = 0;
+	for (auto& param_expr : func_call_expr.params) {
+		this->coerce(*param_expr, expected_param_types[i++]);
+	}
+
+	func_call_expr.type = return_type_to_var_type(func_type->first);
+}
+
+void TypeChecker::visit_int_expr(const IntExpr& int_expr) {
+	// A literal too large for an int is a long
+	int_expr.type = int_expr.value >= INT32_MIN && int_expr.value <= INT32_MAX ? VarType::Int : VarType::Long;
+}
+
+void TypeChecker::visit_float_expr(const FloatExpr& float_expr) {
+	float_expr.type = VarType::Float;
+}
+
+void TypeChecker::visit_bool_expr(const BoolExpr& bool_expr) {
+	bool_expr.type = VarType::Bool;
+}
+
+// Arrays are only allowed as arguments, where allow_array is set
+VarType TypeChecker::check_value(const Expr& expr, unsigned int line_num, unsigned int column_num, const char* context, bool allow_array) {
+	if (!expr.type) {
+		throw TypeError(
+			line_num,
+			column_num,
+			std::string("cannot use an expression of type void ") + context
+		);
+	}
+	if (is_array_type(*expr.type) && !allow_array) {
+		throw TypeError(
+			line_num,
+			column_num,
+			std::string("cannot use an array of type ") + var_type_to_str(*expr.type) + " " + context + ", only its elements"
+		);
+	}
+
+	// Until a parent says otherwise, an expression is used as its own type
+	expr.coerced_type = expr.type;
+	return *expr.type;
+}
+
+// Uses a checked expression as the given type, which coerce_type must be able to convert it to
+void TypeChecker::coerce(const Expr& expr, VarType type) {
+	if (type == VarType::Double && make_double_literal(expr)) {
+		return;
+	}
+
+	expr.coerced_type = type;
+}
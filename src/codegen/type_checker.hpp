@@ -0,0 +1,58 @@
+#pragma once
+
+#include "constant_fold.hpp"
+#include "scope.hpp"
+#include "type_error.hpp"
+#include "../ast/static_visitor.hpp"
+#include "../ast/declaration.hpp"
+#include "../ast/statement.hpp"
+
+using namespace ast::declaration;
+using namespace ast::statement;
+
+// Resolves the type of every expression in the program and records it on the AST (see Expr::type and
+// Expr::coerced_type). Checking a declaration stops at its first error, which is recorded in "errors"
+// before moving on to the next declaration. No LLVM state is needed, so this can be run on its own for
+// check-only compiles, and the CodeGenerator relies on it having run first without errors.
+class TypeChecker : public StaticVisitor<TypeChecker> {
+public:
+	TypeChecker() = default;
+
+	void visit_program(const Program& program);
+	void visit_extern_decl(const ExternDecl& extern_decl);
+	void visit_var_decl(const VarDecl& decl);
+	void visit_func_decl(const FuncDecl& decl);
+	void visit_block(const Block& block);
+	void visit_local_decl(const VarDecl& local_decl);
+	void visit_expr_stmt(const ExprStmt& expr_stmt);
+	void visit_return_stmt(const Return& ret_stmt);
+	void visit_if_else_stmt(const IfElse& if_else_stmt);
+	void visit_while_stmt(const While& while_stmt);
+	void visit_unary_expr(const UnaryExpr& unary_expr);
+	void visit_binary_expr(const BinaryExpr& binary_expr);
+	void visit_assign_expr(const AssignExpr& assign_expr);
+	void visit_identifier_expr(const IdentifierExpr& identifier_expr);
+	void visit_index_expr(const IndexExpr& index_expr);
+	void visit_func_call_expr(const FuncCallExpr& func_call_expr);
+	void visit_int_expr(const IntExpr& int_expr);
+	void visit_float_expr(const FloatExpr& float_expr);
+	void visit_bool_expr(const BoolExpr& bool_expr);
+
+	void check_block(const Block& block);
+
+	std::vector<TypeError> errors;
+
+private:
+	void check_decl(const Declaration& decl);
+	void check_initializer(const VarDecl& decl);
+	VarType check_value(const Expr& expr, unsigned int line_num, unsigned int column_num, const char* context, bool allow_array = false);
+	void coerce(const Expr& expr, VarType type);
+	VarType check_array_element(const std::string& name, const Expr& index, unsigned int line_num, unsigned int column_num);
+	void register_func(const std::string& name, ReturnType return_type, const std::forward_list<std::unique_ptr<Param>>& params, unsigned int line_num, unsigned int column_num);
+
+	Scope scope;
+	ConstantMap constants; // the scalar globals declared const
+
+	ReturnType current_return_type;
+	bool return_called = false;
+};
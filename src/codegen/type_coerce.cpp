@@ -6,13 +6,59 @@ boost::optional<ConversionFunc> coerce_type(VarType from, VarType to) {
 		return res;
 	}
 
-	if (from == VarType::Int && to == VarType::Float) {
+	// Only widening conversions are implicit, from int to long, from either integer type to either
+	// floating point type, and from float to double. A float expression is computed as a float before it
+	// is widened, unless it is made only of literals (see make_double_literal in the TypeChecker).
+	if (from == VarType::Int && to == VarType::Long) {
+		ConversionFunc res = [](Context ctx, Builder builder, Value val) {
+			return builder.CreateSExt(val, llvm::Type::getInt64Ty(ctx));
+		};
+		return res;
+	}
+
+	if ((from == VarType::Int || from == VarType::Long) && to == VarType::Float) {
 		ConversionFunc res = [](Context ctx, Builder builder, Value val) {
 			return builder.CreateSIToFP(val, llvm::Type::getFloatTy(ctx));
 		};
 		return res;
 	}
 
+	if ((from == VarType::Int || from == VarType::Long) && to == VarType::Double) {
+		ConversionFunc res = [](Context ctx, Builder builder, Value val) {
+			return builder.CreateSIToFP(val, llvm::Type::getDoubleTy(ctx));
+		};
+		return res;
+	}
+
+	if (from == VarType::Float && to == VarType::Double) {
+		ConversionFunc res = [](Context ctx, Builder builder, Value val) {
+			return builder.CreateFPExt(val, llvm::Type::getDoubleTy(ctx));
+		};
+		return res;
+	}
+
+	// A scalar becomes a vector of copies of itself, first converting an int to float for a float vector,
+	// and an int vector converts lane by lane to the float vector of the same width
+	if (is_vector_type(to) && (from == lane_type(to) || (from == VarType::Int && lane_type(to) == VarType::Float))) {
+		unsigned int lanes = lane_count(to);
+		bool to_float = from != lane_type(to);
+		ConversionFunc res = [lanes, to_float](Context ctx, Builder builder, Value val) {
+			if (to_float) {
+				val = builder.CreateSIToFP(val, llvm::Type::getFloatTy(ctx));
+			}
+			return builder.CreateVectorSplat(lanes, val);
+		};
+		return res;
+	}
+
+	if ((from == VarType::Int4 && to == VarType::Float4) || (from == VarType::Int8 && to == VarType::Float8)) {
+		unsigned int lanes = lane_count(to);
+		ConversionFunc res = [lanes](Context ctx, Builder builder, Value val) {
+			return builder.CreateSIToFP(val, llvm::VectorType::get(llvm::Type::getFloatTy(ctx), lanes));
+		};
+		return res;
+	}
+
 	return boost::none;
 }
 
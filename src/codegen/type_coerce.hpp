@@ -14,4 +14,5 @@ using Value = llvm::Value*;
 // A function to convert one type to another
 using ConversionFunc = std::function<Value(Context, Builder, Value)>;
 
+boost::optional<ConversionFunc> coerce_type(VarType from, VarType to);
 boost::optional<std::vector<ConversionFunc>> coerce_list(std::vector<VarType>, std::vector<VarType>);
@@ -41,7 +41,9 @@ TypeError::TypeError(
 		const std::string& callee_name,
 		const std::vector<std::vector<VarType>>& expected_types,
 		const std::vector<VarType>& actual_type
-	) {
+	) :
+	line_num(line_num),
+	column_num(column_num) {
 	this->err_string = "type error:\nline "
 		+ std::to_string(line_num)
 		+ " column "
@@ -57,7 +59,9 @@ TypeError::TypeError(
 }
 
 
-TypeError::TypeError(unsigned int line_num, unsigned int column_num, const std::string& msg) {
+TypeError::TypeError(unsigned int line_num, unsigned int column_num, const std::string& msg) :
+	line_num(line_num),
+	column_num(column_num) {
 	this->err_string = "type error:\nline "
 		+ std::to_string(line_num)
 		+ " column "
@@ -70,3 +74,11 @@ TypeError::TypeError(unsigned int line_num, unsigned int column_num, const std::
 const char* TypeError::what() const noexcept {
 	return this->err_string.c_str();
 }
+
+unsigned int TypeError::line() const noexcept {
+	return this->line_num;
+}
+
+unsigned int TypeError::column() const noexcept {
+	return this->column_num;
+}
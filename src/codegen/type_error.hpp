@@ -18,8 +18,12 @@ public:
 	);
 	TypeError(unsigned int line_num, unsigned int column_num, const std::string& msg);
 	const char* what() const noexcept override;
+	unsigned int line() const noexcept;
+	unsigned int column() const noexcept;
 
 private:
 	std::string err_string;
+	unsigned int line_num;
+	unsigned int column_num;
 
 };
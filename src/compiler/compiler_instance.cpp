@@ -0,0 +1,377 @@
+#include "compiler_instance.hpp"
+#include "../lexer/lexer.hpp"
+#include "../lexer/lexical_error.hpp"
+#include "../parser/parse.hpp"
+#include "../parser/token_stream.hpp"
+#include "../ast/tree_printer.hpp"
+#include "../codegen/codegen.hpp"
+#include "../codegen/type_checker.hpp"
+#include "../interp/bytecode_compiler.hpp"
+#include "../cache/function_cache.hpp"
+#include "../timing/time_report.hpp"
+#include "optimizer.hpp"
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ExecutionEngine/MCJIT.h>
+#include <llvm/ExecutionEngine/SectionMemoryManager.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/TargetRegistry.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetOptions.h>
+
+// Output is written in 1MB chunks, rather than one system call per block of the default size
+static const size_t OUTPUT_BUFFER_SIZE = 1 << 20;
+
+// Resolves a JIT compiled program's externs from its own map before the host process, so that programs
+// loaded side by side can each be given different implementations of the same extern
+class ExternMemoryManager : public llvm::SectionMemoryManager {
+public:
+	ExternMemoryManager(const std::map<std::string, void*>& externs) : externs(externs) { }
+
+	uint64_t getSymbolAddress(const std::string& name) override {
+		auto it = this->externs.find(name);
+		// Some platforms prefix C symbols with an underscore
+		if (it == this->externs.end() && !name.empty() && name[0] == '_') {
+			it = this->externs.find(name.substr(1));
+		}
+
+		if (it != this->externs.end()) {
+			return reinterpret_cast<uint64_t>(it->second);
+		}
+		return llvm::SectionMemoryManager::getSymbolAddress(name);
+	}
+
+private:
+	std::map<std::string, void*> externs;
+};
+
+JitProgram::JitProgram(std::unique_ptr<llvm::LLVMContext> context, std::unique_ptr<llvm::ExecutionEngine> engine) :
+	context(std::move(context)),
+	engine(std::move(engine)) { }
+
+uint64_t JitProgram::address(const std::string& name) {
+	return this->engine->getFunctionAddress(name);
+}
+
+bool Compilation::succeeded() const {
+	return this->diags.empty();
+}
+
+const std::vector<Diagnostic>& Compilation::diagnostics() const {
+	return this->diags;
+}
+
+const bytecode::Module* Compilation::bytecode() const {
+	return this->bytecode_module.get();
+}
+
+llvm::Module* Compilation::module() {
+	return this->mod.get();
+}
+
+std::unique_ptr<llvm::Module> Compilation::take_module() {
+	return std::move(this->mod);
+}
+
+std::string Compilation::emit_ir() const {
+	std::string ir;
+	if (this->mod != nullptr) {
+		llvm::raw_string_ostream os(ir);
+		this->mod->print(os, nullptr);
+	}
+	return ir;
+}
+
+void Compilation::emit_ir(llvm::SmallVectorImpl<char>& buffer) const {
+	if (this->mod != nullptr) {
+		llvm::raw_svector_ostream os(buffer);
+		this->mod->print(os, nullptr);
+	}
+}
+
+void Compilation::write_ir(const std::string& path) const {
+	if (this->mod == nullptr) {
+		throw std::runtime_error("no module to write");
+	}
+
+	if (path == "-") {
+		this->mod->print(llvm::outs(), nullptr);
+		llvm::outs().flush();
+		return;
+	}
+
+	// Written to a temporary file beside it and renamed into place, so that a reader never sees a partial
+	// file and concurrent compiles to the same path (from any process or thread) leave one complete output
+	llvm::SmallString<128> tmp_path;
+	int fd;
+	std::error_code open_error = llvm::sys::fs::createUniqueFile(path + ".%%%%%%%%.tmp", fd, tmp_path);
+	if (open_error) {
+		throw std::runtime_error("Failed to open file for output \"" + path + "\": " + open_error.message());
+	}
+
+	{
+		llvm::raw_fd_ostream dest(fd, true);
+		dest.SetBufferSize(OUTPUT_BUFFER_SIZE);
+		this->mod->print(dest, nullptr);
+		dest.close();
+		if (dest.has_error()) {
+			dest.clear_error();
+			llvm::sys::fs::remove(tmp_path);
+			throw std::runtime_error("Failed to write output to \"" + path + "\"");
+		}
+	}
+
+	std::error_code ec = llvm::sys::fs::rename(tmp_path, path);
+	if (ec) {
+		llvm::sys::fs::remove(tmp_path);
+		throw std::runtime_error("Failed to write output to \"" + path + "\": " + ec.message());
+	}
+}
+
+std::string Compilation::emit_object(const std::string& target_triple) {
+	if (this->mod == nullptr) {
+		throw std::runtime_error("no module to emit object code for");
+	}
+
+	initialize_targets();
+
+	std::string triple = target_triple.empty() ? llvm::sys::getDefaultTargetTriple() : target_triple;
+	std::string error;
+	auto target = llvm::TargetRegistry::lookupTarget(triple, error);
+	if (target == nullptr) {
+		throw std::runtime_error("unavailable target \"" + triple + "\": " + error);
+	}
+
+	std::unique_ptr<llvm::TargetMachine> target_machine(target->createTargetMachine(
+		triple,
+		"generic",
+		"",
+		llvm::TargetOptions(),
+		llvm::Optional<llvm::Reloc::Model>(llvm::Reloc::PIC_)
+	));
+	this->mod->setTargetTriple(triple);
+	this->mod->setDataLayout(target_machine->createDataLayout());
+
+	llvm::SmallVector<char, 0> buffer;
+	llvm::raw_svector_ostream os(buffer);
+	llvm::legacy::PassManager pass_manager;
+	if (target_machine->addPassesToEmitFile(pass_manager, os, nullptr, llvm::TargetMachine::CGFT_ObjectFile)) {
+		throw std::runtime_error("target \"" + triple + "\" cannot emit object files");
+	}
+	pass_manager.run(*this->mod);
+
+	return std::string(buffer.begin(), buffer.end());
+}
+
+std::unique_ptr<JitProgram> Compilation::jit(const std::map<std::string, void*>& externs, unsigned int opt_level) {
+	if (this->mod == nullptr) {
+		throw std::runtime_error("no module to JIT compile");
+	}
+
+	initialize_targets();
+
+	llvm::Module* module = this->mod.get();
+	std::string error;
+	std::unique_ptr<llvm::ExecutionEngine> engine(
+		llvm::EngineBuilder(std::move(this->mod))
+			.setEngineKind(llvm::EngineKind::JIT)
+			.setErrorStr(&error)
+			.setOptLevel(codegen_opt_level(opt_level))
+			.setMCPU(llvm::sys::getHostCPUName())
+			.setMAttrs(host_cpu_features())
+			.setMCJITMemoryManager(llvm::make_unique<ExternMemoryManager>(externs))
+			.create()
+	);
+	if (engine == nullptr) {
+		throw std::runtime_error("failed to create JIT: " + error);
+	}
+
+	// MCJIT generates machine code on first use, so the module can still be optimised here, once the
+	// engine has given it the target's data layout
+	optimize_module(*module, opt_level, engine->getTargetMachine());
+
+	return llvm::make_unique<JitProgram>(std::move(this->context), std::move(engine));
+}
+
+CompilerInstance::CompilerInstance(CompilerOptions options) :
+	options(std::move(options)) { }
+
+// Adds the errors from a pass, returning whether there were any
+template <typename T>
+static bool add_diagnostics(std::vector<Diagnostic>& diags, Diagnostic::Phase phase, const std::vector<T>& errors) {
+	for (auto& error : errors) {
+		diags.push_back({ phase, error.line(), error.column(), error.what() });
+	}
+	return !errors.empty();
+}
+
+// The pipeline mccomp runs, which collects errors as diagnostics rather than printing them
+Compilation CompilerInstance::compile(boost::string_ref source) const {
+	Compilation result;
+	TimeReport* time_report = this->options.time_report;
+
+	TokenStream ts;
+	try {
+		TimeScope timer(time_report, "Lex");
+		lexer::Lexer l(source);
+		l.lex(ts.tokens);
+	} catch (const LexicalError& e) {
+		result.diags.push_back({ Diagnostic::Phase::Lexing, e.line(), e.column(), e.what() });
+		return result;
+	}
+
+	// The function cache loads the functions it has into the context of the module they are spliced into,
+	// so the CodeGenerator is made before any function body is parsed
+	std::unique_ptr<CodeGenerator> cg;
+	FunctionCache* function_cache = nullptr;
+	if (this->options.generate_llvm) {
+		cg = llvm::make_unique<CodeGenerator>(this->options.module_name);
+		cg->bounds_checks = this->options.bounds_checks;
+		cg->loop_hints = this->options.loop_hints;
+		cg->time_report = time_report;
+		function_cache = this->options.function_cache;
+	}
+
+	// Function bodies are deferred until all declarations are known when they are parsed in parallel, or
+	// when unchanged functions can be taken from the function cache
+	Parser p(ts, this->options.parse_jobs != 0 || function_cache != nullptr);
+	std::unique_ptr<Program> prog;
+	try {
+		{
+			TimeScope timer(time_report, "Parse");
+			prog = p.parse_program();
+		}
+
+		if (function_cache != nullptr) {
+			std::vector<FuncDecl*> to_parse;
+			{
+				TimeScope timer(time_report, "Function cache lookup");
+				to_parse = function_cache->lookup(*prog, ts, *cg, this->options.cache_options);
+			}
+
+			TimeScope timer(time_report, "Parse function bodies");
+			p.parse_deferred_bodies(to_parse, std::max(this->options.parse_jobs, 1u));
+		} else if (this->options.parse_jobs != 0) {
+			TimeScope timer(time_report, "Parse function bodies");
+			p.parse_deferred_bodies(*prog, this->options.parse_jobs);
+		}
+	} catch (const ParseError& e) {
+		p.errors.push_back(e);
+	}
+	if (add_diagnostics(result.diags, Diagnostic::Phase::Parsing, p.errors)) {
+		return result;
+	}
+
+	// Resolve and record the type of every expression
+	TypeChecker tc;
+	{
+		TimeScope timer(time_report, "Type check");
+		tc.dispatch(*prog);
+	}
+	if (add_diagnostics(result.diags, Diagnostic::Phase::TypeChecking, tc.errors)) {
+		return result;
+	}
+
+	if (this->options.print_ast) {
+		TimeScope timer(time_report, "Print AST");
+		TreePrinter tp;
+		tp.dispatch(*prog);
+	}
+
+	// A compile that only checks the program stops here, before any LLVM state is created, unless it
+	// reports on inlining
+	if (!this->options.generate_llvm && !this->options.generate_bytecode && this->options.inline_report == nullptr) {
+		return result;
+	}
+
+	// The flat AST is made once, for the report and both backends
+	InlineCostModel inline_costs;
+	{
+		TimeScope timer(time_report, "Inline costs");
+		inline_costs.analyse(ast::flat::flatten(*prog));
+	}
+	if (this->options.inline_report != nullptr) {
+		inline_costs.print_report(*this->options.inline_report);
+	}
+
+	if (this->options.generate_bytecode) {
+		try {
+			TimeScope timer(time_report, "Bytecode compile");
+			BytecodeCompiler bc;
+			bc.inline_costs = inline_costs;
+			bc.dispatch(*prog);
+			result.bytecode_module = llvm::make_unique<bytecode::Module>(bc.take_module());
+		} catch (const std::exception& e) {
+			result.diags.push_back({ Diagnostic::Phase::CodeGeneration, 0, 0, e.what() });
+			return result;
+		}
+	}
+
+	if (cg == nullptr) {
+		return result;
+	}
+
+	try {
+		cg->inline_costs = std::move(inline_costs);
+		{
+			TimeScope timer(time_report, "Codegen");
+			cg->dispatch(*prog);
+		}
+
+		// The function cache optimises the functions it caches, so the target and remarks are set up first
+		llvm::Module& module = cg->generated_module();
+		const RemarkFilters& remarks = this->options.remarks;
+		if (this->options.optimize && (!remarks.passed.empty() || !remarks.missed.empty() || !remarks.analysis.empty())) {
+			print_remarks(module.getContext(), remarks, llvm::errs());
+		}
+		std::unique_ptr<llvm::TargetMachine> target_machine;
+		if (this->options.optimize && this->options.target_native) {
+			initialize_targets();
+			target_machine = create_host_target_machine(this->options.opt_level);
+			target_host(module, *target_machine);
+		}
+		unsigned int opt_level = this->options.optimize ? this->options.opt_level : 0;
+
+		if (function_cache != nullptr) {
+			TimeScope timer(time_report, "Function cache update");
+			function_cache->update(*cg, opt_level, target_machine.get());
+		}
+		if (!this->options.exports.empty()) {
+			TimeScope timer(time_report, "Internalize");
+			cg->internalize(this->options.exports);
+		}
+
+		// A module that fails verification would only fail later, in a less helpful way
+		{
+			TimeScope timer(time_report, "Verify module");
+			std::string verifier_errors;
+			llvm::raw_string_ostream os(verifier_errors);
+			if (llvm::verifyModule(module, &os)) {
+				result.diags.push_back({ Diagnostic::Phase::CodeGeneration, 0, 0, "internal error: generated module is invalid: " + os.str() });
+				return result;
+			}
+		}
+
+		if (this->options.optimize) {
+			TimeScope timer(time_report, "Optimize");
+			// Every function the function cache saw has been through the per-function passes already
+			optimize_module(module, opt_level, target_machine.get(), function_cache != nullptr);
+		}
+
+		result.mod = cg->take_module();
+		result.context = cg->take_context();
+	} catch (const std::exception& e) {
+		result.diags.push_back({ Diagnostic::Phase::CodeGeneration, 0, 0, e.what() });
+	}
+
+	return result;
+}
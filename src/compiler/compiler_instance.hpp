@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <boost/utility/string_ref.hpp>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ExecutionEngine/ExecutionEngine.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include "../codegen/loop_hints.hpp"
+#include "../interp/bytecode.hpp"
+#include "optimizer.hpp"
+
+class FunctionCache;
+class TimeReport;
+
+// The compiler as a library (libminic), which mccomp is built on too. A CompilerInstance holds only its
+// options, and every compile owns all of its state (including its own LLVMContext), so one instance can be
+// used for any number of compiles, from any number of threads at once, unless it is given a TimeReport or
+// a FunctionCache, which only one compile can use at a time.
+
+struct Diagnostic {
+	enum class Phase {
+		Lexing,
+		Parsing,
+		TypeChecking,
+		CodeGeneration
+	};
+
+	Phase phase;
+	unsigned int line_num; // 0 if the error has no location
+	unsigned int column_num;
+	std::string message; // the full message, as mccomp prints it
+};
+
+struct CompilerOptions {
+	std::string module_name = "main_module";
+	unsigned int parse_jobs = 0; // when non-zero, function bodies are parsed on this many threads
+	bool print_ast = false; // print the AST to std::cout, as mccomp does
+	bool generate_llvm = true;
+	bool generate_bytecode = false; // compile to bytecode for the Interpreter as well
+	bool bounds_checks = false; // trap on array indices out of bounds (the Interpreter always checks them)
+	LoopHints loop_hints;
+	// When not empty, the only functions the module exports, as mccomp's --export (see
+	// CodeGenerator::internalize)
+	std::vector<std::string> exports;
+
+	// When set, the module is optimised at opt_level (0 to 3, as for opt) before compile returns, as by
+	// mccomp's -O. Otherwise it is left as generated, for Compilation::jit to optimise.
+	bool optimize = false;
+	unsigned int opt_level = 0;
+	bool target_native = false; // optimise for the host's CPU and its features, as mccomp's -march=native
+	RemarkFilters remarks; // the optimiser's remarks to print to stderr
+
+	std::ostream* inline_report = nullptr; // when set, the InlineCostModel's decisions are printed to it
+	TimeReport* time_report = nullptr; // when set, every phase (and the generation of each function) is timed
+	// When set, only the functions that changed since the last compile are parsed and generated, and the
+	// others are taken from the cache, under keys that include cache_options (see FunctionCache)
+	FunctionCache* function_cache = nullptr;
+	std::string cache_options;
+};
+
+// A program loaded into the JIT. Externs are resolved from the map given to Compilation::jit first, then
+// from the symbols of the host process.
+class JitProgram {
+public:
+	JitProgram(std::unique_ptr<llvm::LLVMContext> context, std::unique_ptr<llvm::ExecutionEngine> engine);
+
+	// Address of a function in the program, or 0 if there is no such function
+	uint64_t address(const std::string& name);
+
+	template <typename T>
+	T* function(const std::string& name) {
+		return reinterpret_cast<T*>(this->address(name));
+	}
+
+private:
+	std::unique_ptr<llvm::LLVMContext> context;
+	std::unique_ptr<llvm::ExecutionEngine> engine;
+};
+
+// The outcome of compiling one program: its diagnostics and, if there were no errors, its module and/or
+// bytecode. The module can be taken as is, emitted as IR or object code, or loaded into the JIT. The
+// bytecode can be run by an Interpreter, which the Compilation must outlive.
+class Compilation {
+public:
+	bool succeeded() const;
+	const std::vector<Diagnostic>& diagnostics() const;
+
+	const bytecode::Module* bytecode() const; // nullptr unless generate_bytecode was set
+
+	llvm::Module* module(); // nullptr if there were errors, generate_llvm was not set or the module was taken
+	// The module's context stays owned by the Compilation, which must outlive the module
+	std::unique_ptr<llvm::Module> take_module();
+
+	std::string emit_ir() const;
+	// Appends the IR to the buffer, which can be reused between compiles to save on allocation
+	void emit_ir(llvm::SmallVectorImpl<char>& buffer) const;
+	// Writes the IR to a file, or to stdout if the path is "-". Throws std::runtime_error if the file
+	// cannot be written, in which case any existing file at the path is left as it was.
+	void write_ir(const std::string& path) const;
+	// Object code for the given target triple (the host's if empty). Throws std::runtime_error if the
+	// target is unavailable.
+	std::string emit_object(const std::string& target_triple = "");
+	// Moves the module into a new JIT, optimising it at opt_level (0 to 3, as for opt and llc) first.
+	// Throws std::runtime_error if the JIT cannot be created.
+	std::unique_ptr<JitProgram> jit(const std::map<std::string, void*>& externs = {}, unsigned int opt_level = 0);
+
+private:
+	friend class CompilerInstance;
+
+	std::vector<Diagnostic> diags;
+	std::unique_ptr<llvm::LLVMContext> context;
+	std::unique_ptr<llvm::Module> mod;
+	std::unique_ptr<bytecode::Module> bytecode_module;
+};
+
+class CompilerInstance {
+public:
+	CompilerInstance(CompilerOptions options = CompilerOptions());
+
+	Compilation compile(boost::string_ref source) const;
+
+private:
+	CompilerOptions options;
+};
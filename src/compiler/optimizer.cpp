@@ -0,0 +1,292 @@
+#include "optimizer.hpp"
+#include "../codegen/loop_hints.hpp"
+#include <mutex>
+#include <stdexcept>
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Analysis/TargetLibraryInfo.h>
+#include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/IR/CFG.h>
+#include <llvm/IR/DiagnosticHandler.h>
+#include <llvm/IR/DiagnosticInfo.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/Metadata.h>
+#include <llvm/Support/DynamicLibrary.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/Regex.h>
+#include <llvm/Support/TargetRegistry.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Target/TargetOptions.h>
+#include <llvm/Transforms/IPO.h>
+#include <llvm/Transforms/IPO/AlwaysInliner.h>
+#include <llvm/Transforms/IPO/PassManagerBuilder.h>
+#include <llvm/Transforms/Scalar.h>
+
+// LLVM's target registry is global, so it is set up once, by whichever compile needs it first
+void initialize_targets() {
+	static std::once_flag initialized;
+	std::call_once(initialized, []() {
+		llvm::InitializeAllTargetInfos();
+		llvm::InitializeAllTargets();
+		llvm::InitializeAllTargetMCs();
+		llvm::InitializeAllAsmPrinters();
+		llvm::InitializeNativeTarget();
+		llvm::InitializeNativeTargetAsmPrinter();
+		// Make the host process's symbols visible to the JIT
+		llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
+	});
+}
+
+std::vector<std::string> host_cpu_features() {
+	std::vector<std::string> features;
+
+	llvm::StringMap<bool> host_features;
+	if (llvm::sys::getHostCPUFeatures(host_features)) {
+		for (auto& feature : host_features) {
+			features.push_back((feature.getValue() ? "+" : "-") + feature.getKey().str());
+		}
+	}
+
+	return features;
+}
+
+static std::string join_features(const std::vector<std::string>& features) {
+	std::string joined;
+	for (auto& feature : features) {
+		joined += (joined.empty() ? "" : ",") + feature;
+	}
+	return joined;
+}
+
+llvm::CodeGenOpt::Level codegen_opt_level(unsigned int opt_level) {
+	switch (opt_level) {
+		case 0: return llvm::CodeGenOpt::None;
+		case 1: return llvm::CodeGenOpt::Less;
+		case 2: return llvm::CodeGenOpt::Default;
+		default: return llvm::CodeGenOpt::Aggressive;
+	}
+}
+
+std::unique_ptr<llvm::TargetMachine> create_host_target_machine(unsigned int opt_level) {
+	initialize_targets();
+
+	std::string triple = llvm::sys::getProcessTriple();
+	std::string error;
+	auto target = llvm::TargetRegistry::lookupTarget(triple, error);
+	if (target == nullptr) {
+		throw std::runtime_error("unavailable host target \"" + triple + "\": " + error);
+	}
+
+	return std::unique_ptr<llvm::TargetMachine>(target->createTargetMachine(
+		triple,
+		llvm::sys::getHostCPUName(),
+		join_features(host_cpu_features()),
+		llvm::TargetOptions(),
+		llvm::Optional<llvm::Reloc::Model>(llvm::Reloc::PIC_),
+		llvm::None,
+		codegen_opt_level(opt_level)
+	));
+}
+
+void target_host(llvm::Module& module, llvm::TargetMachine& target_machine) {
+	module.setTargetTriple(target_machine.getTargetTriple().str());
+	module.setDataLayout(target_machine.createDataLayout());
+
+	for (auto& function : module) {
+		if (!function.isDeclaration()) {
+			function.addFnAttr("target-cpu", target_machine.getTargetCPU());
+			function.addFnAttr("target-features", target_machine.getTargetFeatureString());
+		}
+	}
+}
+
+// Self-recursive calls are generated as guaranteed tail calls (see CodeGenerator::tail_call), which tail
+// call elimination only has to keep as tail calls. As ordinary tail calls, it turns them into loops.
+static void relax_self_tail_calls(llvm::Module& module) {
+	for (auto& function : module) {
+		for (auto& inst : llvm::instructions(function)) {
+			auto call = llvm::dyn_cast<llvm::CallInst>(&inst);
+			if (call != nullptr && call->isMustTailCall() && call->getCalledFunction() == &function) {
+				call->setTailCallKind(llvm::CallInst::TCK_Tail);
+			}
+		}
+	}
+}
+
+static void add_tail_call_elimination(const llvm::PassManagerBuilder&, llvm::legacy::PassManagerBase& passes) {
+	passes.add(llvm::createTailCallEliminationPass());
+}
+
+// The pipeline of opt -O<opt_level>, for opt_level 1 to 3
+static void configure_pipeline(llvm::PassManagerBuilder& builder, unsigned int opt_level, llvm::TargetMachine* target_machine) {
+	builder.OptLevel = opt_level;
+	builder.Inliner = llvm::createFunctionInliningPass(opt_level, 0, false);
+	// Both are off unless asked for, as they are by opt and clang from -O2
+	builder.LoopVectorize = opt_level > 1;
+	builder.SLPVectorize = opt_level > 1;
+	// The pipeline only eliminates tail calls from -O2, but self tail recursion becomes a loop from -O1
+	if (opt_level == 1) {
+		builder.addExtension(llvm::PassManagerBuilder::EP_ScalarOptimizerLate, add_tail_call_elimination);
+	}
+
+	if (target_machine != nullptr) {
+		target_machine->adjustPassManager(builder);
+	}
+}
+
+void optimize_functions(llvm::Module& module, unsigned int opt_level, llvm::TargetMachine* target_machine) {
+	if (opt_level == 0) {
+		return;
+	}
+
+	relax_self_tail_calls(module);
+
+	llvm::PassManagerBuilder builder;
+	configure_pipeline(builder, opt_level, target_machine);
+
+	llvm::legacy::FunctionPassManager function_passes(&module);
+	if (target_machine != nullptr) {
+		function_passes.add(llvm::createTargetTransformInfoWrapperPass(target_machine->getTargetIRAnalysis()));
+	}
+	builder.populateFunctionPassManager(function_passes);
+
+	function_passes.doInitialization();
+	for (auto& function : module) {
+		function_passes.run(function);
+	}
+	function_passes.doFinalization();
+}
+
+void optimize_module(llvm::Module& module, unsigned int opt_level, llvm::TargetMachine* target_machine, bool functions_optimised) {
+	// Functions the InlineCostModel chose are inlined at every level (see CodeGenerator::visit_func_decl)
+	if (opt_level == 0) {
+		llvm::legacy::PassManager module_passes;
+		module_passes.add(llvm::createAlwaysInlinerLegacyPass(false));
+		module_passes.run(module);
+		return;
+	}
+
+	if (!functions_optimised) {
+		optimize_functions(module, opt_level, target_machine);
+	}
+
+	llvm::PassManagerBuilder builder;
+	configure_pipeline(builder, opt_level, target_machine);
+
+	llvm::legacy::PassManager module_passes;
+	if (target_machine != nullptr) {
+		module_passes.add(new llvm::TargetLibraryInfoWrapperPass(target_machine->getTargetTriple()));
+		module_passes.add(llvm::createTargetTransformInfoWrapperPass(target_machine->getTargetIRAnalysis()));
+	}
+	builder.populateModulePassManager(module_passes);
+	module_passes.run(module);
+}
+
+// The MiniC line of the loop with the given header, from the loop ID on its latch (see
+// CodeGenerator::loop_id), or 0 if it has none
+static unsigned int loop_line(const llvm::Value* code_region) {
+	auto header = llvm::dyn_cast_or_null<llvm::BasicBlock>(code_region);
+	if (header == nullptr) {
+		return 0;
+	}
+
+	for (auto pred : llvm::predecessors(header)) {
+		auto loop_id = pred->getTerminator()->getMetadata(llvm::LLVMContext::MD_loop);
+		if (loop_id == nullptr) {
+			continue;
+		}
+
+		for (auto& operand : loop_id->operands()) {
+			auto property = llvm::dyn_cast<llvm::MDNode>(operand.get());
+			if (property == nullptr || property->getNumOperands() != 2) {
+				continue;
+			}
+
+			auto name = llvm::dyn_cast<llvm::MDString>(property->getOperand(0).get());
+			if (name != nullptr && name->getString() == LOOP_LINE_METADATA) {
+				return llvm::mdconst::extract<llvm::ConstantInt>(property->getOperand(1))->getZExtValue();
+			}
+		}
+	}
+
+	return 0;
+}
+
+class RemarkPrinter : public llvm::DiagnosticHandler {
+public:
+	RemarkPrinter(const RemarkFilters& filters, llvm::raw_ostream& os) :
+		passed(make_filter(filters.passed)),
+		missed(make_filter(filters.missed)),
+		analysis(make_filter(filters.analysis)),
+		os(os) { }
+
+	bool isPassedOptRemarkEnabled(llvm::StringRef pass_name) const override {
+		return this->passed != nullptr && this->passed->match(pass_name);
+	}
+
+	bool isMissedOptRemarkEnabled(llvm::StringRef pass_name) const override {
+		return this->missed != nullptr && this->missed->match(pass_name);
+	}
+
+	bool isAnalysisRemarkEnabled(llvm::StringRef pass_name) const override {
+		return this->analysis != nullptr && this->analysis->match(pass_name);
+	}
+
+	bool isAnyRemarkEnabled() const override {
+		return this->passed != nullptr || this->missed != nullptr || this->analysis != nullptr;
+	}
+
+	// Other diagnostics are left to the context to print
+	bool handleDiagnostics(const llvm::DiagnosticInfo& info) override {
+		auto remark = llvm::dyn_cast<llvm::DiagnosticInfoOptimizationBase>(&info);
+		if (remark == nullptr) {
+			return false;
+		}
+
+		const char* option = nullptr;
+		if (remark->isPassed() && this->isPassedOptRemarkEnabled(remark->getPassName())) {
+			option = "-Rpass";
+		} else if (remark->isMissed() && this->isMissedOptRemarkEnabled(remark->getPassName())) {
+			option = "-Rpass-missed";
+		} else if (remark->isAnalysis() && this->isAnalysisRemarkEnabled(remark->getPassName())) {
+			option = "-Rpass-analysis";
+		}
+		if (option == nullptr) {
+			return true;
+		}
+
+		this->os << "remark: " << remark->getFunction().getName();
+		if (auto ir_remark = llvm::dyn_cast<llvm::DiagnosticInfoIROptimization>(remark)) {
+			if (unsigned int line = loop_line(ir_remark->getCodeRegion())) {
+				this->os << ", loop at line " << line;
+			}
+		}
+		this->os << ": " << remark->getMsg() << " [" << option << "=" << remark->getPassName() << "]\n";
+		return true;
+	}
+
+private:
+	static std::unique_ptr<llvm::Regex> make_filter(const std::string& pattern) {
+		if (pattern.empty()) {
+			return nullptr;
+		}
+
+		auto regex = llvm::make_unique<llvm::Regex>(pattern);
+		std::string error;
+		if (!regex->isValid(error)) {
+			throw std::runtime_error("invalid remark filter \"" + pattern + "\": " + error);
+		}
+		return regex;
+	}
+
+	std::unique_ptr<llvm::Regex> passed;
+	std::unique_ptr<llvm::Regex> missed;
+	std::unique_ptr<llvm::Regex> analysis;
+	llvm::raw_ostream& os;
+};
+
+void print_remarks(llvm::LLVMContext& context, const RemarkFilters& filters, llvm::raw_ostream& os) {
+	context.setDiagnosticHandler(llvm::make_unique<RemarkPrinter>(filters, os));
+}
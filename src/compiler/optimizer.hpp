@@ -0,0 +1,52 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+
+// The optimisation pipeline, shared by mccomp's -O and the JIT, and the host target it optimises for.
+
+// Sets up LLVM's targets, once per process
+void initialize_targets();
+
+// The host's CPU features, as "+feature" or "-feature"
+std::vector<std::string> host_cpu_features();
+
+// The code generator's level for opt_level (0 to 3), as llc's -O
+llvm::CodeGenOpt::Level codegen_opt_level(unsigned int opt_level);
+
+// A target machine for the host's CPU and features. Throws std::runtime_error if the host's target is
+// unavailable.
+std::unique_ptr<llvm::TargetMachine> create_host_target_machine(unsigned int opt_level);
+
+// Targets the module at the host: its triple and data layout, and the host's CPU and features on every
+// function, so that the vectorizer's cost model (and llc) can use the host's vector registers
+void target_host(llvm::Module& module, llvm::TargetMachine& target_machine);
+
+// Runs the pipeline of opt -O<opt_level> (0 to 3) over the module, including the loop and SLP
+// vectorizers from -O2. Without a target machine, the cost model knows nothing of the target, so the
+// vectorizers only vectorize loops whose hints ask them to. Self tail recursion is turned into loops.
+// At -O0, only the functions marked alwaysinline are inlined. With functions_optimised, the pipeline's
+// per-function passes are skipped, as every function has been through optimize_functions already.
+void optimize_module(llvm::Module& module, unsigned int opt_level, llvm::TargetMachine* target_machine, bool functions_optimised = false);
+
+// The per-function passes that start optimize_module's pipeline, run over every function defined in the
+// module. The FunctionCache caches functions once they have been through them (see FunctionCache::update).
+void optimize_functions(llvm::Module& module, unsigned int opt_level, llvm::TargetMachine* target_machine);
+
+// Optimisation remarks, as clang's -Rpass, -Rpass-missed and -Rpass-analysis. Each filter is a regular
+// expression matched against the names of the passes whose remarks are printed ("loop-vectorize",
+// "inline", ...), and is empty to print none of that kind.
+struct RemarkFilters {
+	std::string passed;
+	std::string missed;
+	std::string analysis;
+};
+
+// Prints the remarks made while optimising modules in the context to os, one per line. A remark about a
+// loop gives the MiniC line of its while statement. Throws std::runtime_error if a filter is invalid.
+void print_remarks(llvm::LLVMContext& context, const RemarkFilters& filters, llvm::raw_ostream& os);
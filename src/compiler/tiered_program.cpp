@@ -0,0 +1,217 @@
+#include "tiered_program.hpp"
+#include <exception>
+#include <map>
+#include <stdexcept>
+
+#include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/IRBuilder.h>
+
+// Converts between a register (an i64, of which an int, float or bool uses the low 32 bits) and an LLVM
+// value of the given type
+static llvm::Value* from_slot(llvm::IRBuilder<>& builder, llvm::Value* slot, llvm::Type* type) {
+	if (type->isDoubleTy()) {
+		return builder.CreateBitCast(slot, type);
+	} else if (type->isIntegerTy(64)) {
+		return slot;
+	}
+
+	llvm::Value* low = builder.CreateTrunc(slot, builder.getInt32Ty());
+	if (type->isFloatTy()) {
+		return builder.CreateBitCast(low, type);
+	} else if (type->isIntegerTy(1)) {
+		return builder.CreateICmpNE(low, builder.getInt32(0));
+	}
+	return low;
+}
+
+static llvm::Value* to_slot(llvm::IRBuilder<>& builder, llvm::Value* value) {
+	if (value->getType()->isDoubleTy()) {
+		return builder.CreateBitCast(value, builder.getInt64Ty());
+	} else if (value->getType()->isFloatTy()) {
+		value = builder.CreateBitCast(value, builder.getInt32Ty());
+	}
+	return builder.CreateZExtOrBitCast(value, builder.getInt64Ty());
+}
+
+// Adds "<name>.tier_entry", with the signature of an Interpreter::NativeEntry, which calls the function
+// with its arguments taken from registers
+static void add_tier_entry(llvm::Module& module, llvm::Function& function) {
+	llvm::LLVMContext& context = module.getContext();
+	llvm::Type* slot_type = llvm::Type::getInt64Ty(context);
+	llvm::Type* slot_ptr_type = slot_type->getPointerTo();
+
+	auto entry_type = llvm::FunctionType::get(llvm::Type::getVoidTy(context), { slot_ptr_type, slot_ptr_type }, false);
+	auto entry = llvm::Function::Create(entry_type, llvm::Function::ExternalLinkage, function.getName() + ".tier_entry", &module);
+
+	llvm::IRBuilder<> builder(llvm::BasicBlock::Create(context, "entry", entry));
+	auto entry_arg = entry->arg_begin();
+	llvm::Value* args = &*entry_arg++;
+	llvm::Value* result = &*entry_arg;
+
+	std::vector<llvm::Value*> call_args;
+	unsigned int i = 0;
+	for (auto& param : function.args()) {
+		llvm::Value* arg_ptr = builder.CreateConstInBoundsGEP1_32(slot_type, args, i++);
+		llvm::Value* slot = builder.CreateLoad(arg_ptr);
+		call_args.push_back(from_slot(builder, slot, param.getType()));
+	}
+
+	llvm::Value* ret = builder.CreateCall(&function, call_args);
+	if (!function.getReturnType()->isVoidTy()) {
+		builder.CreateStore(to_slot(builder, ret), result);
+	}
+	builder.CreateRetVoid();
+}
+
+TieredProgram::TieredProgram(boost::string_ref source, TieringOptions options) :
+	source(source.to_string()),
+	options(options)
+{
+	CompilerOptions compiler_options;
+	compiler_options.generate_llvm = false;
+	compiler_options.generate_bytecode = true;
+	this->compilation = CompilerInstance(compiler_options).compile(this->source);
+	if (!this->compilation.succeeded()) {
+		return;
+	}
+
+	this->interpreter = llvm::make_unique<Interpreter>(*this->compilation.bytecode());
+	this->hot.resize(this->compilation.bytecode()->functions.size(), false);
+	this->interpreter->set_hot_callback(options.call_threshold, options.loop_threshold, [this](uint32_t function_index) {
+		this->function_hot(function_index);
+	});
+}
+
+TieredProgram::~TieredProgram() {
+	this->wait();
+}
+
+bool TieredProgram::succeeded() const {
+	return this->compilation.succeeded();
+}
+
+const std::vector<Diagnostic>& TieredProgram::diagnostics() const {
+	return this->compilation.diagnostics();
+}
+
+Interpreter& TieredProgram::running_interpreter() {
+	if (this->interpreter == nullptr) {
+		throw std::runtime_error("the program failed to compile");
+	}
+	return *this->interpreter;
+}
+
+bool TieredProgram::is_native(const std::string& name) const {
+	if (this->interpreter == nullptr) {
+		return false;
+	}
+
+	int64_t index = this->interpreter->function_index(name);
+	return index >= 0 && this->interpreter->has_native_entry(index);
+}
+
+std::string TieredProgram::wait() {
+	if (this->compile_thread.joinable()) {
+		this->compile_thread.join();
+	}
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->compile_error;
+}
+
+void TieredProgram::function_hot(uint32_t function_index) {
+	std::unique_lock<std::mutex> lock(this->mutex);
+
+	this->hot[function_index] = true;
+	if (this->native_ready) {
+		this->interpreter->set_native_entry(function_index, this->native_entries[function_index]);
+		return;
+	}
+	if (this->compile_started) {
+		return;
+	}
+
+	this->compile_started = true;
+	if (this->options.background) {
+		this->compile_thread = std::thread([this]() { this->compile_native(); });
+	} else {
+		lock.unlock();
+		this->compile_native();
+	}
+}
+
+void TieredProgram::compile_native() {
+	std::vector<Interpreter::NativeEntry> entries;
+	std::unique_ptr<JitProgram> jit;
+	std::string error;
+
+	try {
+		// The optimising tier compiles the program again from source, so it shares nothing with the
+		// interpreter but the globals and externs
+		auto compilation = CompilerInstance().compile(this->source);
+		if (!compilation.succeeded()) {
+			throw std::runtime_error("the program failed to compile for the JIT");
+		}
+
+		const bytecode::Module& bytecode = *this->compilation.bytecode();
+		llvm::Module& module = *compilation.module();
+
+		std::map<std::string, void*> symbols;
+		for (uint32_t i = 0; i < bytecode.externs.size(); i++) {
+			void* address = this->interpreter->native_extern(i);
+			if (address == nullptr) {
+				throw std::runtime_error("the extern \"" + bytecode.externs[i].name + "\" is not bound to a native function");
+			}
+			symbols[bytecode.externs[i].name] = address;
+		}
+
+		// Globals become declarations of the interpreter's. Every other value is at the start of its Slot,
+		// and a bool only uses the first byte, which holds the whole value on little-endian targets, as the
+		// interpreter only stores 0 or 1. Arrays are packed as they are here, but the interpreter's bool
+		// elements are 32 bits, where these would be bytes.
+		for (uint32_t i = 0; i < bytecode.globals.size(); i++) {
+			auto& global = bytecode.globals[i];
+			if (global.type == VarType::BoolArray) {
+				throw std::runtime_error("the global bool array \"" + global.name + "\" cannot be shared with native code");
+			}
+
+			auto gv = module.getNamedGlobal(global.name);
+			gv->setInitializer(nullptr);
+			gv->setLinkage(llvm::GlobalValue::ExternalLinkage);
+			symbols[global.name] = this->interpreter->global_address(i);
+		}
+
+		// A function taking an array stays in the interpreter, as its arguments refer to registers
+		for (auto& function : bytecode.functions) {
+			if (!function.code.empty() && function.num_param_registers == function.param_types.size()) {
+				add_tier_entry(module, *module.getFunction(function.name));
+			}
+		}
+
+		jit = compilation.jit(symbols, this->options.opt_level);
+		for (auto& function : bytecode.functions) {
+			bool has_entry = !function.code.empty() && function.num_param_registers == function.param_types.size();
+			entries.push_back(has_entry ? jit->function<void(const bytecode::Slot*, bytecode::Slot*)>(function.name + ".tier_entry") : nullptr);
+		}
+	} catch (const std::exception& e) {
+		error = e.what();
+	}
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if (!error.empty()) {
+		this->compile_error = error;
+		return;
+	}
+
+	this->jit = std::move(jit);
+	this->native_entries = std::move(entries);
+	this->native_ready = true;
+	for (uint32_t i = 0; i < this->hot.size(); i++) {
+		if (this->hot[i]) {
+			this->interpreter->set_native_entry(i, this->native_entries[i]);
+		}
+	}
+}
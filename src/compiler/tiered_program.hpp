@@ -0,0 +1,81 @@
+#pragma once
+
+#include "compiler_instance.hpp"
+#include "../interp/interpreter.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/utility/string_ref.hpp>
+
+struct TieringOptions {
+	uint64_t call_threshold = 1000; // calls to a function before it is compiled
+	uint64_t loop_threshold = 10000; // loop back edges taken in a function before it is compiled
+	unsigned int opt_level = 2;
+	bool background = true; // compile on a background thread, rather than the one that made a function hot
+};
+
+// Runs a program with tiered execution. Every function starts in the bytecode interpreter, which is
+// ready as soon as the program has been type checked. Once any function gets hot, the whole program is
+// compiled with the optimising pipeline and JIT compiled, and from then on each function switches to
+// its native code as soon as it is hot itself, by way of the interpreter's table of native entries.
+// Native code shares the interpreter's globals, so the two tiers can be mixed freely.
+//
+// There is no on-stack replacement: a call already running in the interpreter finishes there, so a
+// function that is hot because of its loops runs natively from its next call.
+//
+// Functions that take arrays are never promoted, though the functions they call can be. Functions can
+// only be promoted if every extern the program uses was bound with bind_native, so that
+// the native code can call it too. Externs must be bound before the first call, and calls must be made
+// from one thread at a time.
+class TieredProgram {
+public:
+	TieredProgram(boost::string_ref source, TieringOptions options = TieringOptions());
+	~TieredProgram();
+
+	TieredProgram(const TieredProgram&) = delete;
+	TieredProgram& operator=(const TieredProgram&) = delete;
+
+	bool succeeded() const;
+	const std::vector<Diagnostic>& diagnostics() const;
+
+	template <typename R, typename... Args>
+	void bind_native(const std::string& name, R (*function)(Args...)) {
+		this->running_interpreter().bind_native(name, function);
+	}
+
+	template <typename T>
+	std::function<T> function(const std::string& name) {
+		return this->running_interpreter().function<T>(name);
+	}
+
+	// Whether calls to the function now run native code
+	bool is_native(const std::string& name) const;
+
+	// Waits for the optimising compile, if one has started. Returns its error, or "" if it succeeded or
+	// never started.
+	std::string wait();
+
+private:
+	Interpreter& running_interpreter(); // throws if the program failed to compile
+	void function_hot(uint32_t function_index);
+	void compile_native();
+
+	std::string source;
+	TieringOptions options;
+
+	Compilation compilation; // holds the bytecode the interpreter runs
+	std::unique_ptr<Interpreter> interpreter;
+
+	std::mutex mutex; // guards everything below
+	std::vector<bool> hot;
+	bool compile_started = false;
+	bool native_ready = false;
+	std::vector<Interpreter::NativeEntry> native_entries;
+	std::unique_ptr<JitProgram> jit;
+	std::string compile_error;
+	std::thread compile_thread;
+};
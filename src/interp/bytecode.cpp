@@ -0,0 +1,43 @@
+#include "bytecode.hpp"
+#include "../ast/declaration.hpp"
+
+using ast::declaration::var_type_to_str;
+
+namespace bytecode {
+
+	const char* opcode_to_str(Opcode op) {
+		static const char* const names[] = {
+			#define BYTECODE_OPCODE_NAME(name) #name,
+			BYTECODE_OPCODES(BYTECODE_OPCODE_NAME)
+			#undef BYTECODE_OPCODE_NAME
+		};
+
+		return names[static_cast<size_t>(op)];
+	}
+
+	size_t element_size(VarType element_type) {
+		return element_type == VarType::Long || element_type == VarType::Double ? sizeof(int64_t) : sizeof(int32_t);
+	}
+
+	void Module::print(std::ostream& os) const {
+		for (size_t i = 0; i < this->globals.size(); i++) {
+			auto& global = this->globals[i];
+			os << "global " << i << ": " << global.name << " (" << (global.is_const ? "const " : "") << var_type_to_str(global.type) << ", slots " << global.offset << " to " << global.offset + global.size - 1 << ")" << std::endl;
+		}
+
+		for (size_t i = 0; i < this->externs.size(); i++) {
+			os << "extern " << i << ": " << this->externs[i].name << std::endl;
+		}
+
+		for (size_t i = 0; i < this->functions.size(); i++) {
+			auto& function = this->functions[i];
+			os << std::endl << "function " << i << ": " << function.name << " (" << function.num_registers << " registers)" << std::endl;
+
+			for (size_t pc = 0; pc < function.code.size(); pc++) {
+				auto& inst = function.code[pc];
+				os << "  " << pc << "\t" << opcode_to_str(inst.op) << "\t" << inst.a << ", " << inst.b << ", " << inst.c << std::endl;
+			}
+		}
+	}
+
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../ast/type.hpp"
+
+using namespace ast::type;
+
+namespace bytecode {
+
+	// Every opcode, in the order of the Opcode enum. The interpreter builds its dispatch table from this
+	// list, so the two cannot get out of step.
+	//
+	// Operands, where a, b and c are the fields of an Instruction, r[n] is register n of the frame and
+	// globals[n] is slot n of the globals:
+	//   LoadConst             r[a] = the 32 bit pattern b
+	//   LoadWideConst         r[a] = the 64 bit pattern with b as its low half and c as its high half
+	//   Move                  r[a] = r[b]
+	//   LoadGlobal            r[a] = globals[b]
+	//   StoreGlobal           globals[a] = r[b]
+	//   ArrayRef              r[a] = a reference to the array whose elements start at r[b]
+	//   GlobalArrayRef        r[a] = a reference to the array whose elements start at globals[b]
+	//   LoadElement           r[a] = element r[c] of the array r[b], of 32 bits
+	//   StoreElement          element r[b] of the array r[a] = r[c], of 32 bits
+	//   LoadWideElement,      as LoadElement and StoreElement, for elements of 64 bits (long and double)
+	//   StoreWideElement
+	//   IntToFloat .. FloatToDouble  r[a] = (type)r[b]
+	//   AddI .. NeB, And, Or  r[a] = r[b] op r[c]
+	//   NegI .. NegD, Not     r[a] = op r[b]
+	//   Jump                  continue at instruction b
+	//   Loop                  continue at instruction b, which is earlier (a loop's back edge)
+	//   JumpIfFalse           if r[a] is false, continue at instruction b
+	//   Call, CallExtern      r[a] = functions/externs[b](r[c], r[c + 1], ...)
+	//   Return                return r[a]
+	//   ReturnVoid            return
+	//
+	// An array is held in two consecutive registers, a reference to its elements followed by its length,
+	// and is passed to a function as both. The elements of a local array are registers of the frame that
+	// declares it, and those of a global array are slots of the globals. Elements are packed as they are
+	// in the generated code, so a register holds two int, float or bool elements, or one long or double.
+	#define BYTECODE_OPCODES(X) \
+		X(LoadConst) X(LoadWideConst) X(Move) X(LoadGlobal) X(StoreGlobal) \
+		X(ArrayRef) X(GlobalArrayRef) X(LoadElement) X(StoreElement) X(LoadWideElement) X(StoreWideElement) \
+		X(IntToFloat) X(IntToLong) X(IntToDouble) X(LongToFloat) X(LongToDouble) X(FloatToDouble) \
+		X(AddI) X(SubI) X(MulI) X(DivI) X(RemI) X(NegI) \
+		X(LtI) X(LeI) X(GtI) X(GeI) X(EqI) X(NeI) \
+		X(AddL) X(SubL) X(MulL) X(DivL) X(RemL) X(NegL) \
+		X(LtL) X(LeL) X(GtL) X(GeL) X(EqL) X(NeL) \
+		X(AddF) X(SubF) X(MulF) X(DivF) X(NegF) \
+		X(LtF) X(LeF) X(GtF) X(GeF) X(EqF) X(NeF) \
+		X(AddD) X(SubD) X(MulD) X(DivD) X(NegD) \
+		X(LtD) X(LeD) X(GtD) X(GeD) X(EqD) X(NeD) \
+		X(EqB) X(NeB) X(And) X(Or) X(Not) \
+		X(Jump) X(Loop) X(JumpIfFalse) X(Call) X(CallExtern) X(Return) X(ReturnVoid)
+
+	enum class Opcode : uint8_t {
+		#define BYTECODE_OPCODE_ENUM(name) name,
+		BYTECODE_OPCODES(BYTECODE_OPCODE_ENUM)
+		#undef BYTECODE_OPCODE_ENUM
+	};
+
+	const char* opcode_to_str(Opcode op);
+
+	struct Instruction {
+		Opcode op;
+		uint16_t a;
+		uint32_t b;
+		uint32_t c;
+	};
+
+	// One register. The TypeChecker has resolved every type, so the instruction reading a register
+	// knows which member is live. Bools are stored in i, as 0 or 1, and array references in p.
+	union Slot {
+		int32_t i;
+		float f;
+		int64_t l;
+		double d;
+		void* p;
+	};
+
+	// The size of an element of an array of the given element type, as in the generated code, except
+	// that bools take 32 bits rather than 8
+	size_t element_size(VarType element_type);
+
+	struct Function {
+		std::string name;
+		std::vector<VarType> param_types;
+		uint32_t num_param_registers = 0; // the parameters are the first registers, two for each array
+		ReturnType return_type;
+		uint32_t num_registers = 0;
+		std::vector<Instruction> code; // empty if the body was never parsed
+	};
+
+	struct Extern {
+		std::string name;
+		std::vector<VarType> param_types;
+		uint32_t num_param_registers = 0;
+		ReturnType return_type;
+	};
+
+	// A global variable, stored in one slot, or in as many as its elements are packed into for an array.
+	// Globals are zero initialised, as in the generated code, unless they have an initializer.
+	struct Global {
+		std::string name;
+		VarType type;
+		uint32_t offset; // of its first slot in the globals
+		uint32_t size; // in slots
+		uint32_t length; // in elements, for an array
+		bool is_const = false;
+		std::vector<Slot> initializer; // its first slots, the rest being zero
+	};
+
+	struct Module {
+		std::vector<Function> functions;
+		std::vector<Extern> externs;
+		std::vector<Global> globals;
+		uint32_t global_slots = 0;
+
+		std::unordered_map<std::string, uint32_t> function_indices;
+		std::unordered_map<std::string, uint32_t> extern_indices;
+
+		void print(std::ostream& os) const;
+	};
+
+}
@@ -0,0 +1,672 @@
+#include "bytecode_compiler.hpp"
+#include <cstring>
+#include <stdexcept>
+
+using bytecode::Opcode;
+
+// The instruction converting a value of one type to the wider type it is coerced to (see coerce_type)
+static Opcode conversion_opcode(VarType from, VarType to) {
+	if (from == VarType::Int) {
+		switch (to) {
+			case VarType::Long: return Opcode::IntToLong;
+			case VarType::Float: return Opcode::IntToFloat;
+			case VarType::Double: return Opcode::IntToDouble;
+			default: break;
+		}
+	} else if (from == VarType::Long) {
+		switch (to) {
+			case VarType::Float: return Opcode::LongToFloat;
+			case VarType::Double: return Opcode::LongToDouble;
+			default: break;
+		}
+	} else if (from == VarType::Float && to == VarType::Double) {
+		return Opcode::FloatToDouble;
+	}
+
+	throw std::logic_error(std::string("no conversion from ") + var_type_to_str(from) + " to " + var_type_to_str(to));
+}
+
+// The number of registers (or global slots) the elements of an array take up
+static uint64_t array_slots(VarType array_type, uint32_t length) {
+	uint64_t bytes = static_cast<uint64_t>(length) * bytecode::element_size(element_type(array_type));
+	return (bytes + sizeof(bytecode::Slot) - 1) / sizeof(bytecode::Slot);
+}
+
+// Whether evaluating an expression can change a local variable
+static bool contains_assignment(const Expr& expr) {
+	switch (expr.kind) {
+		case NodeKind::AssignExpr: return true;
+		case NodeKind::IndexExpr: return contains_assignment(*static_cast<const IndexExpr&>(expr).index);
+		case NodeKind::UnaryExpr: return contains_assignment(*static_cast<const UnaryExpr&>(expr).operand);
+		case NodeKind::BinaryExpr: {
+			auto& binary_expr = static_cast<const BinaryExpr&>(expr);
+			return contains_assignment(*binary_expr.first_operand) || contains_assignment(*binary_expr.second_operand);
+		}
+		case NodeKind::FuncCallExpr: {
+			for (auto& param : static_cast<const FuncCallExpr&>(expr).params) {
+				if (contains_assignment(*param)) {
+					return true;
+				}
+			}
+			return false;
+		}
+		default: return false;
+	}
+}
+
+// Vectors are only generated as LLVM IR, so a program that declares one does not compile to bytecode
+static void check_interpretable(const std::string& name, VarType type) {
+	if (is_vector_type(is_array_type(type) ? element_type(type) : type)) {
+		throw std::runtime_error("\"" + name + "\" is of the vector type " + var_type_to_str(type) + ", which the bytecode interpreter does not support");
+	}
+}
+
+// A constant as the register holding it would
+static bytecode::Slot constant_slot(const ConstantValue& value) {
+	bytecode::Slot slot;
+	slot.l = 0;
+	switch (value.type) {
+		case VarType::Float: slot.f = static_cast<float>(value.f); break;
+		case VarType::Double: slot.d = value.f; break;
+		case VarType::Long: slot.l = value.i; break;
+		default: slot.i = static_cast<int32_t>(value.i); break;
+	}
+	return slot;
+}
+
+static Opcode element_opcode(VarType element_type, Opcode narrow, Opcode wide) {
+	return bytecode::element_size(element_type) == sizeof(int64_t) ? wide : narrow;
+}
+
+static uint32_t num_param_registers(const std::vector<VarType>& param_types) {
+	uint32_t num_registers = 0;
+	for (auto type : param_types) {
+		num_registers += is_array_type(type) ? 2 : 1;
+	}
+	return num_registers;
+}
+
+static Opcode binary_opcode(BinaryOp op, VarType operand_type) {
+	switch (operand_type) {
+		case VarType::Int:
+			switch (op) {
+				case BinaryOp::Multiply: return Opcode::MulI;
+				case BinaryOp::Divide: return Opcode::DivI;
+				case BinaryOp::Modulo: return Opcode::RemI;
+				case BinaryOp::Plus: return Opcode::AddI;
+				case BinaryOp::Minus: return Opcode::SubI;
+				case BinaryOp::Less: return Opcode::LtI;
+				case BinaryOp::LessEqual: return Opcode::LeI;
+				case BinaryOp::Greater: return Opcode::GtI;
+				case BinaryOp::GreaterEqual: return Opcode::GeI;
+				case BinaryOp::Equals: return Opcode::EqI;
+				case BinaryOp::NotEquals: return Opcode::NeI;
+				default: break;
+			}
+			break;
+		case VarType::Long:
+			switch (op) {
+				case BinaryOp::Multiply: return Opcode::MulL;
+				case BinaryOp::Divide: return Opcode::DivL;
+				case BinaryOp::Modulo: return Opcode::RemL;
+				case BinaryOp::Plus: return Opcode::AddL;
+				case BinaryOp::Minus: return Opcode::SubL;
+				case BinaryOp::Less: return Opcode::LtL;
+				case BinaryOp::LessEqual: return Opcode::LeL;
+				case BinaryOp::Greater: return Opcode::GtL;
+				case BinaryOp::GreaterEqual: return Opcode::GeL;
+				case BinaryOp::Equals: return Opcode::EqL;
+				case BinaryOp::NotEquals: return Opcode::NeL;
+				default: break;
+			}
+			break;
+		case VarType::Float:
+			switch (op) {
+				case BinaryOp::Multiply: return Opcode::MulF;
+				case BinaryOp::Divide: return Opcode::DivF;
+				case BinaryOp::Plus: return Opcode::AddF;
+				case BinaryOp::Minus: return Opcode::SubF;
+				case BinaryOp::Less: return Opcode::LtF;
+				case BinaryOp::LessEqual: return Opcode::LeF;
+				case BinaryOp::Greater: return Opcode::GtF;
+				case BinaryOp::GreaterEqual: return Opcode::GeF;
+				case BinaryOp::Equals: return Opcode::EqF;
+				case BinaryOp::NotEquals: return Opcode::NeF;
+				default: break;
+			}
+			break;
+		case VarType::Double:
+			switch (op) {
+				case BinaryOp::Multiply: return Opcode::MulD;
+				case BinaryOp::Divide: return Opcode::DivD;
+				case BinaryOp::Plus: return Opcode::AddD;
+				case BinaryOp::Minus: return Opcode::SubD;
+				case BinaryOp::Less: return Opcode::LtD;
+				case BinaryOp::LessEqual: return Opcode::LeD;
+				case BinaryOp::Greater: return Opcode::GtD;
+				case BinaryOp::GreaterEqual: return Opcode::GeD;
+				case BinaryOp::Equals: return Opcode::EqD;
+				case BinaryOp::NotEquals: return Opcode::NeD;
+				default: break;
+			}
+			break;
+		case VarType::Bool:
+			switch (op) {
+				case BinaryOp::Equals: return Opcode::EqB;
+				case BinaryOp::NotEquals: return Opcode::NeB;
+				case BinaryOp::And: return Opcode::And;
+				case BinaryOp::Or: return Opcode::Or;
+				default: break;
+			}
+			break;
+		default:
+			break;
+	}
+
+	// The TypeChecker only lets through the operand types in the op's OpTable
+	throw std::logic_error(std::string("no instruction for the operator ") + binary_op_to_str(op));
+}
+
+bytecode::Module BytecodeCompiler::take_module() {
+	return std::move(this->module);
+}
+
+size_t BytecodeCompiler::emit(Opcode op, uint32_t a, uint32_t b, uint32_t c) {
+	auto& code = this->current_function->code;
+	code.push_back({ op, static_cast<uint16_t>(a), b, c });
+	return code.size() - 1;
+}
+
+void BytecodeCompiler::patch_jump(size_t jump) {
+	this->current_function->code[jump].b = this->current_function->code.size();
+}
+
+uint16_t BytecodeCompiler::allocate_register() {
+	uint16_t reg = this->next_register;
+	this->set_next_register(this->next_register + 1);
+	return reg;
+}
+
+void BytecodeCompiler::set_next_register(uint64_t reg) {
+	if (reg > UINT16_MAX) {
+		throw std::runtime_error("the function \"" + this->current_function->name + "\" needs too many registers for the bytecode interpreter");
+	}
+
+	this->next_register = reg;
+	if (reg > this->current_function->num_registers) {
+		this->current_function->num_registers = reg;
+	}
+}
+
+const uint16_t* BytecodeCompiler::lookup_local(const std::string& name) const {
+	for (auto it = this->scopes.rbegin(); it != this->scopes.rend(); it++) {
+		auto var = it->find(name);
+		if (var != it->end()) {
+			return &var->second;
+		}
+	}
+
+	return nullptr;
+}
+
+void BytecodeCompiler::visit_program(const Program& program) {
+	for (auto& ext : program.externs) {
+		this->dispatch(*ext);
+	}
+
+	// Every function gets its index up front, so the functions vector never moves while one is compiled
+	for (auto& decl : program.decls) {
+		if (decl->kind == NodeKind::FuncDecl) {
+			auto& func_decl = static_cast<const FuncDecl&>(*decl);
+
+			bytecode::Function function;
+			function.name = func_decl.name;
+			function.return_type = func_decl.return_type;
+			check_interpretable(func_decl.name, static_cast<VarType>(func_decl.return_type));
+			for (auto& param : func_decl.params) {
+				check_interpretable(param->name, param->type);
+				function.param_types.push_back(param->type);
+			}
+			function.num_param_registers = num_param_registers(function.param_types);
+
+			this->module.function_indices[func_decl.name] = this->module.functions.size();
+			this->module.functions.push_back(std::move(function));
+			this->function_decls[func_decl.name] = &func_decl;
+		}
+	}
+
+	for (auto& decl : program.decls) {
+		this->dispatch(*decl);
+	}
+}
+
+void BytecodeCompiler::visit_extern_decl(const ExternDecl& extern_decl) {
+	bytecode::Extern ext;
+	ext.name = extern_decl.name;
+	ext.return_type = extern_decl.return_type;
+	check_interpretable(extern_decl.name, static_cast<VarType>(extern_decl.return_type));
+	for (auto& param : extern_decl.params) {
+		check_interpretable(param->name, param->type);
+		ext.param_types.push_back(param->type);
+	}
+	ext.num_param_registers = num_param_registers(ext.param_types);
+
+	this->module.extern_indices[extern_decl.name] = this->module.externs.size();
+	this->module.externs.push_back(std::move(ext));
+}
+
+void BytecodeCompiler::visit_var_decl(const VarDecl& var_decl) {
+	check_interpretable(var_decl.name, var_decl.type);
+
+	bytecode::Global global;
+	global.name = var_decl.name;
+	global.type = var_decl.type;
+	global.offset = this->module.global_slots;
+	global.length = is_array_type(var_decl.type) ? var_decl.array_size : 0;
+	uint64_t size = is_array_type(var_decl.type) ? array_slots(var_decl.type, var_decl.array_size) : 1;
+
+	if (size > UINT32_MAX - global.offset) {
+		throw std::runtime_error("the global \"" + var_decl.name + "\" does not fit in the bytecode interpreter's globals");
+	}
+	global.size = size;
+
+	global.is_const = var_decl.is_const;
+
+	// The elements are packed into the initial slots as they are by the element instructions
+	if (!var_decl.initial_values.empty()) {
+		global.initializer.resize(is_array_type(var_decl.type) ? global.size : 1, bytecode::Slot());
+		size_t element_size = bytecode::element_size(is_array_type(var_decl.type) ? element_type(var_decl.type) : var_decl.type);
+		auto bytes = reinterpret_cast<char*>(global.initializer.data());
+		for (size_t i = 0; i < var_decl.initial_values.size(); i++) {
+			bytecode::Slot slot = constant_slot(var_decl.initial_values[i]);
+			std::memcpy(bytes + i * element_size, &slot, element_size);
+		}
+	}
+
+	this->global_indices[var_decl.name] = this->module.globals.size();
+	this->module.globals.push_back(std::move(global));
+	this->module.global_slots += global.size;
+}
+
+void BytecodeCompiler::visit_func_decl(const FuncDecl& func_decl) {
+	// A body that was never parsed leaves the function without code
+	if (func_decl.body == nullptr) {
+		return;
+	}
+
+	this->current_function = &this->module.functions[this->module.function_indices.at(func_decl.name)];
+	this->next_register = 0;
+
+	this->scopes.emplace_back();
+	for (auto& param : func_decl.params) {
+		this->scopes.back()[param->name] = this->allocate_register();
+		if (is_array_type(param->type)) {
+			this->allocate_register(); // its length
+		}
+	}
+
+	this->cg_block(*func_decl.body);
+
+	// The TypeChecker guarantees non-void functions end in a return
+	if (!this->return_called) {
+		this->emit(Opcode::ReturnVoid);
+	}
+	this->return_called = false;
+
+	this->scopes.pop_back();
+	this->current_function = nullptr;
+}
+
+void BytecodeCompiler::cg_block(const Block& block) {
+	for (auto& local_decl : block.var_decls) {
+		this->visit_local_decl(*local_decl);
+	}
+	this->first_temporary = this->next_register;
+
+	for (auto& stmt : block.statements) {
+		this->set_next_register(this->first_temporary);
+		this->dispatch(*stmt);
+		if (this->return_called) {
+			break;
+		}
+	}
+}
+
+void BytecodeCompiler::visit_block(const Block& block) {
+	uint32_t saved_next_register = this->next_register;
+	uint32_t saved_first_temporary = this->first_temporary;
+	this->scopes.emplace_back();
+
+	this->cg_block(block);
+
+	this->scopes.pop_back();
+	this->next_register = saved_next_register;
+	this->first_temporary = saved_first_temporary;
+}
+
+// A local array's elements are registers, followed by the two that hold the array itself
+void BytecodeCompiler::visit_local_decl(const VarDecl& local_decl) {
+	check_interpretable(local_decl.name, local_decl.type);
+
+	if (is_array_type(local_decl.type)) {
+		uint32_t elements = this->next_register;
+		this->set_next_register(elements + array_slots(local_decl.type, local_decl.array_size));
+
+		uint16_t array = this->allocate_register();
+		this->allocate_register();
+		this->emit(Opcode::ArrayRef, array, elements);
+		this->emit(Opcode::LoadConst, array + 1, local_decl.array_size);
+
+		this->scopes.back()[local_decl.name] = array;
+		return;
+	}
+
+	this->scopes.back()[local_decl.name] = this->allocate_register();
+}
+
+void BytecodeCompiler::visit_expr_stmt(const ExprStmt& expr_stmt) {
+	if (expr_stmt.expr == nullptr) return;
+
+	this->cg_expr(*expr_stmt.expr);
+}
+
+void BytecodeCompiler::visit_return_stmt(const Return& ret_stmt) {
+	if (!this->inlined_calls.empty()) {
+		auto& call = this->inlined_calls.back();
+		if (ret_stmt.return_val != nullptr) {
+			uint16_t val = this->cg_expr(*ret_stmt.return_val);
+			if (val != call.result) {
+				this->emit(Opcode::Move, call.result, val);
+			}
+		}
+		call.return_jumps.push_back(this->emit(Opcode::Jump));
+	} else if (ret_stmt.return_val == nullptr) {
+		this->emit(Opcode::ReturnVoid);
+	} else {
+		this->emit(Opcode::Return, this->cg_expr(*ret_stmt.return_val));
+	}
+
+	this->return_called = true;
+}
+
+void BytecodeCompiler::visit_if_else_stmt(const IfElse& if_else_stmt) {
+	size_t jump_to_false = this->emit(Opcode::JumpIfFalse, this->cg_expr(*if_else_stmt.cond));
+
+	this->dispatch(*if_else_stmt.if_true);
+	bool true_returned = this->return_called;
+	this->return_called = false;
+
+	if (if_else_stmt.if_false == nullptr) {
+		this->patch_jump(jump_to_false);
+		return;
+	}
+
+	size_t jump_to_end = 0;
+	if (!true_returned) {
+		jump_to_end = this->emit(Opcode::Jump);
+	}
+
+	this->patch_jump(jump_to_false);
+	this->dispatch(*if_else_stmt.if_false);
+	this->return_called = false;
+
+	if (!true_returned) {
+		this->patch_jump(jump_to_end);
+	}
+}
+
+void BytecodeCompiler::visit_while_stmt(const While& while_stmt) {
+	uint32_t cond_check = this->current_function->code.size();
+	size_t jump_to_end = this->emit(Opcode::JumpIfFalse, this->cg_expr(*while_stmt.cond));
+
+	this->dispatch(*while_stmt.body);
+	if (this->return_called) {
+		this->return_called = false;
+	} else {
+		this->emit(Opcode::Loop, 0, cond_check);
+	}
+
+	this->patch_jump(jump_to_end);
+}
+
+void BytecodeCompiler::visit_unary_expr(const UnaryExpr& unary_expr) {
+	uint32_t saved_next_register = this->next_register;
+	uint16_t operand = this->cg_expr(*unary_expr.operand);
+	this->set_next_register(saved_next_register);
+
+	Opcode op;
+	if (unary_expr.op == UnaryOp::Not) {
+		op = Opcode::Not;
+	} else {
+		switch (*unary_expr.operand->type) {
+			case VarType::Long: op = Opcode::NegL; break;
+			case VarType::Float: op = Opcode::NegF; break;
+			case VarType::Double: op = Opcode::NegD; break;
+			default: op = Opcode::NegI; break;
+		}
+	}
+
+	this->current_reg = this->allocate_register();
+	this->emit(op, this->current_reg, operand);
+}
+
+void BytecodeCompiler::visit_binary_expr(const BinaryExpr& binary_expr) {
+	uint32_t saved_next_register = this->next_register;
+
+	// A variable used directly as the left operand must be read before the right operand can assign it
+	uint16_t lhs = this->cg_expr(*binary_expr.first_operand);
+	if (lhs < this->first_temporary && contains_assignment(*binary_expr.second_operand)) {
+		uint16_t copy = this->allocate_register();
+		this->emit(Opcode::Move, copy, lhs);
+		lhs = copy;
+	}
+	uint16_t rhs = this->cg_expr(*binary_expr.second_operand);
+
+	// The operands have already been coerced to the parameter types of the entry the TypeChecker chose
+	Opcode op = binary_opcode(binary_expr.op, *binary_expr.first_operand->coerced_type);
+
+	this->set_next_register(saved_next_register);
+	this->current_reg = this->allocate_register();
+	this->emit(op, this->current_reg, lhs, rhs);
+}
+
+void BytecodeCompiler::visit_assign_expr(const AssignExpr& assign_expr) {
+	if (assign_expr.index != nullptr) {
+		uint16_t array = this->array_registers(assign_expr.name);
+		uint16_t index = this->cg_expr(*assign_expr.index);
+		if (index < this->first_temporary && contains_assignment(*assign_expr.expr)) {
+			uint16_t copy = this->allocate_register();
+			this->emit(Opcode::Move, copy, index);
+			index = copy;
+		}
+
+		uint16_t val = this->cg_expr(*assign_expr.expr);
+		this->emit(element_opcode(*assign_expr.type, Opcode::StoreElement, Opcode::StoreWideElement), array, index, val);
+		this->current_reg = val;
+		return;
+	}
+
+	uint16_t val = this->cg_expr(*assign_expr.expr);
+
+	if (auto var = this->lookup_local(assign_expr.name)) {
+		if (*var != val) {
+			this->emit(Opcode::Move, *var, val);
+		}
+		this->current_reg = *var;
+	} else {
+		auto& global = this->module.globals[this->global_indices.at(assign_expr.name)];
+		this->emit(Opcode::StoreGlobal, global.offset, val);
+		this->current_reg = val;
+	}
+}
+
+void BytecodeCompiler::visit_identifier_expr(const IdentifierExpr& identifier_expr) {
+	// Local variables are read straight from their registers
+	if (auto var = this->lookup_local(identifier_expr.name)) {
+		this->current_reg = *var;
+		return;
+	}
+
+	auto& global = this->module.globals[this->global_indices.at(identifier_expr.name)];
+	this->current_reg = this->allocate_register();
+
+	// A constant is folded into its uses, as it never changes
+	if (global.is_const && !is_array_type(global.type)) {
+		const bytecode::Slot& value = global.initializer.front();
+		if (bytecode::element_size(global.type) == sizeof(int64_t)) {
+			this->emit_wide_const(this->current_reg, static_cast<uint64_t>(value.l));
+		} else {
+			this->emit(Opcode::LoadConst, this->current_reg, static_cast<uint32_t>(value.i));
+		}
+		return;
+	}
+
+	this->emit(Opcode::LoadGlobal, this->current_reg, global.offset);
+}
+
+// The first of the two registers holding an array variable. A global array is loaded into temporaries.
+uint16_t BytecodeCompiler::array_registers(const std::string& name) {
+	if (auto var = this->lookup_local(name)) {
+		return *var;
+	}
+
+	auto& global = this->module.globals[this->global_indices.at(name)];
+	uint16_t array = this->allocate_register();
+	this->allocate_register();
+	this->emit(Opcode::GlobalArrayRef, array, global.offset);
+	this->emit(Opcode::LoadConst, array + 1, global.length);
+	return array;
+}
+
+void BytecodeCompiler::visit_index_expr(const IndexExpr& index_expr) {
+	uint32_t saved_next_register = this->next_register;
+	uint16_t array = this->array_registers(index_expr.name);
+	uint16_t index = this->cg_expr(*index_expr.index);
+	this->set_next_register(saved_next_register);
+
+	this->current_reg = this->allocate_register();
+	this->emit(element_opcode(*index_expr.type, Opcode::LoadElement, Opcode::LoadWideElement), this->current_reg, array, index);
+}
+
+void BytecodeCompiler::visit_func_call_expr(const FuncCallExpr& func_call_expr) {
+	// Reserve the argument registers first, so that temporaries used to compute them go above
+	uint32_t base = this->next_register;
+	uint32_t num_args = 0;
+	for (auto& param_expr : func_call_expr.params) {
+		num_args += is_array_type(*param_expr->type) ? 2 : 1;
+	}
+	this->set_next_register(base + num_args);
+
+	uint32_t arg_reg = base;
+	for (auto& param_expr : func_call_expr.params) {
+		if (is_array_type(*param_expr->type)) {
+			uint16_t array = this->array_registers(static_cast<const IdentifierExpr&>(*param_expr).name);
+			if (array != arg_reg) {
+				this->emit(Opcode::Move, arg_reg, array);
+				this->emit(Opcode::Move, arg_reg + 1, array + 1);
+			}
+			this->set_next_register(base + num_args);
+			arg_reg += 2;
+			continue;
+		}
+
+		uint16_t val = this->cg_expr(*param_expr);
+		if (val != arg_reg) {
+			this->emit(Opcode::Move, arg_reg, val);
+		}
+		this->set_next_register(base + num_args);
+		arg_reg++;
+	}
+
+	auto function = this->module.function_indices.find(func_call_expr.func_name);
+	if (this->inline_costs.is_inlined(func_call_expr.func_name)) {
+		this->cg_inlined_call(*this->function_decls.at(func_call_expr.func_name), base);
+	} else if (function != this->module.function_indices.end()) {
+		this->emit(Opcode::Call, base, function->second, base);
+	} else {
+		this->emit(Opcode::CallExtern, base, this->module.extern_indices.at(func_call_expr.func_name), base);
+	}
+
+	// The result is returned into the first argument register
+	this->set_next_register(base);
+	this->current_reg = this->allocate_register();
+}
+
+// Compiles the callee's body in place of a call whose arguments are in the registers from base, which
+// become its parameters. It sees none of the caller's variables, only the globals.
+void BytecodeCompiler::cg_inlined_call(const FuncDecl& callee, uint16_t base) {
+	auto saved_scopes = std::move(this->scopes);
+	uint32_t saved_first_temporary = this->first_temporary;
+
+	this->scopes.clear();
+	this->scopes.emplace_back();
+	uint16_t param_reg = base;
+	for (auto& param : callee.params) {
+		this->scopes.back()[param->name] = param_reg;
+		param_reg += is_array_type(param->type) ? 2 : 1;
+	}
+
+	this->inlined_calls.push_back({ base, {} });
+	this->cg_block(*callee.body);
+	InlinedCall call = std::move(this->inlined_calls.back());
+	this->inlined_calls.pop_back();
+
+	// A return that ends the body would jump to the very next instruction. Nothing can jump past it, as the
+	// last statement was the return itself.
+	auto& code = this->current_function->code;
+	if (this->return_called && !call.return_jumps.empty() && call.return_jumps.back() == code.size() - 1) {
+		code.pop_back();
+		call.return_jumps.pop_back();
+	}
+	for (size_t jump : call.return_jumps) {
+		this->patch_jump(jump);
+	}
+	this->return_called = false;
+
+	this->scopes = std::move(saved_scopes);
+	this->first_temporary = saved_first_temporary;
+}
+
+void BytecodeCompiler::visit_int_expr(const IntExpr& int_expr) {
+	this->current_reg = this->allocate_register();
+	if (*int_expr.type == VarType::Long) {
+		this->emit_wide_const(this->current_reg, static_cast<uint64_t>(int_expr.value));
+	} else {
+		this->emit(Opcode::LoadConst, this->current_reg, static_cast<uint32_t>(int_expr.value));
+	}
+}
+
+void BytecodeCompiler::visit_float_expr(const FloatExpr& float_expr) {
+	this->current_reg = this->allocate_register();
+	if (*float_expr.type == VarType::Double) {
+		uint64_t bits;
+		std::memcpy(&bits, &float_expr.value, sizeof(bits));
+		this->emit_wide_const(this->current_reg, bits);
+	} else {
+		float value = static_cast<float>(float_expr.value);
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		this->emit(Opcode::LoadConst, this->current_reg, bits);
+	}
+}
+
+void BytecodeCompiler::emit_wide_const(uint16_t reg, uint64_t bits) {
+	this->emit(Opcode::LoadWideConst, reg, static_cast<uint32_t>(bits), static_cast<uint32_t>(bits >> 32));
+}
+
+void BytecodeCompiler::visit_bool_expr(const BoolExpr& bool_expr) {
+	this->current_reg = this->allocate_register();
+	this->emit(Opcode::LoadConst, this->current_reg, bool_expr.value ? 1 : 0);
+}
+
+uint16_t BytecodeCompiler::cg_expr(const Expr& expr) {
+	this->dispatch(expr);
+
+	if (expr.coerced_type && *expr.coerced_type != *expr.type) {
+		uint16_t converted = this->current_reg >= this->first_temporary ? this->current_reg : this->allocate_register();
+		this->emit(conversion_opcode(*expr.type, *expr.coerced_type), converted, this->current_reg);
+		return converted;
+	}
+
+	return this->current_reg;
+}
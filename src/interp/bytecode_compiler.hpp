@@ -0,0 +1,87 @@
+#pragma once
+
+#include "bytecode.hpp"
+#include "../ast/static_visitor.hpp"
+#include "../ast/declaration.hpp"
+#include "../ast/statement.hpp"
+#include "../codegen/inline_cost.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace ast::declaration;
+using namespace ast::statement;
+
+// Compiles a type checked Program to register bytecode for the Interpreter, without touching LLVM. Like
+// the CodeGenerator, it relies on the TypeChecker's annotations (Expr::type and Expr::coerced_type) to
+// pick each instruction, so the bytecode behaves the same as the generated code.
+//
+// Parameters and local variables live in fixed registers, and temporaries are allocated above them in
+// stack order and released after every statement. The arguments of a call are placed in consecutive
+// registers at the top of the caller's frame, which then become the first registers of the callee's.
+// Local arrays keep their elements in registers too, so the interpreter needs no other memory.
+//
+// The functions the InlineCostModel chooses are compiled into every call instead, with their parameters
+// living in the argument registers, and each of their returns jumping past the inlined body.
+class BytecodeCompiler : public StaticVisitor<BytecodeCompiler> {
+public:
+	BytecodeCompiler() = default;
+
+	void visit_program(const Program& program);
+	void visit_extern_decl(const ExternDecl& extern_decl);
+	void visit_var_decl(const VarDecl& decl);
+	void visit_func_decl(const FuncDecl& decl);
+	void visit_block(const Block& block);
+	void visit_local_decl(const VarDecl& local_decl);
+	void visit_expr_stmt(const ExprStmt& expr_stmt);
+	void visit_return_stmt(const Return& ret_stmt);
+	void visit_if_else_stmt(const IfElse& if_else_stmt);
+	void visit_while_stmt(const While& while_stmt);
+	void visit_unary_expr(const UnaryExpr& unary_expr);
+	void visit_binary_expr(const BinaryExpr& binary_expr);
+	void visit_assign_expr(const AssignExpr& assign_expr);
+	void visit_identifier_expr(const IdentifierExpr& identifier_expr);
+	void visit_index_expr(const IndexExpr& index_expr);
+	void visit_func_call_expr(const FuncCallExpr& func_call_expr);
+	void visit_int_expr(const IntExpr& int_expr);
+	void visit_float_expr(const FloatExpr& float_expr);
+	void visit_bool_expr(const BoolExpr& bool_expr);
+
+	void cg_block(const Block& block);
+	uint16_t cg_expr(const Expr& expr);
+
+	// The functions to inline into every call, as for the CodeGenerator
+	InlineCostModel inline_costs;
+
+	// Hand the compiled module to the caller. The BytecodeCompiler must not be used afterwards.
+	bytecode::Module take_module();
+
+private:
+	size_t emit(bytecode::Opcode op, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0);
+	void emit_wide_const(uint16_t reg, uint64_t bits);
+	void patch_jump(size_t jump); // make a jump continue at the next instruction emitted
+	uint16_t allocate_register();
+	void set_next_register(uint64_t reg);
+	uint16_t array_registers(const std::string& name);
+	const uint16_t* lookup_local(const std::string& name) const;
+	void cg_inlined_call(const FuncDecl& callee, uint16_t base);
+
+	bytecode::Module module;
+	bytecode::Function* current_function = nullptr;
+
+	std::unordered_map<std::string, uint32_t> global_indices; // into module.globals
+	std::vector<std::unordered_map<std::string, uint16_t>> scopes; // the register of each local variable
+	uint32_t next_register = 0;
+	uint32_t first_temporary = 0; // registers below this hold variables
+
+	uint16_t current_reg = 0; // the register holding the value of the last expression
+	bool return_called = false;
+
+	struct InlinedCall {
+		uint16_t result; // the register each return moves its value to
+		std::vector<size_t> return_jumps; // patched to continue after the inlined body
+	};
+
+	std::unordered_map<std::string, const FuncDecl*> function_decls;
+	std::vector<InlinedCall> inlined_calls; // the innermost last
+};
@@ -0,0 +1,452 @@
+#include "interpreter.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+using bytecode::Instruction;
+using bytecode::Opcode;
+using bytecode::Slot;
+
+// With GCC and clang, each instruction jumps straight to the handler of the next one through a table of
+// label addresses ("computed goto"), instead of going back round a switch. Every handler then has its own
+// indirect branch, which the CPU predicts far better than the single one of a switch.
+#if defined(__GNUC__)
+#define MINIC_COMPUTED_GOTO 1
+#endif
+
+static InterpreterError out_of_bounds(int32_t index, int32_t length) {
+	return InterpreterError("array index " + std::to_string(index) + " is out of bounds for an array of length " + std::to_string(length));
+}
+
+namespace {
+	// Restores the top of the stack however a call ends, so that the interpreter stays usable after a
+	// runtime error or an exception thrown by a host function
+	struct RestoreTop {
+		Slot*& top;
+		Slot* saved;
+		~RestoreTop() { this->top = this->saved; }
+	};
+}
+
+Interpreter::Interpreter(const bytecode::Module& module, size_t stack_size) :
+	module(module),
+	globals(module.global_slots, Slot()),
+	native_externs(module.externs.size(), nullptr),
+	calls(module.functions.size(), 0),
+	loops(module.functions.size(), 0),
+	native_entries(new std::atomic<NativeEntry>[module.functions.size()]),
+	stack(stack_size, Slot())
+{
+	this->stack_top = this->stack.data();
+
+	for (auto& global : module.globals) {
+		std::copy(global.initializer.begin(), global.initializer.end(), this->globals.begin() + global.offset);
+	}
+
+	for (size_t i = 0; i < module.functions.size(); i++) {
+		this->native_entries[i].store(nullptr, std::memory_order_relaxed);
+	}
+
+	for (auto& ext : module.externs) {
+		std::string name = ext.name;
+		this->externs.push_back([name](const Slot*) -> Slot {
+			throw InterpreterError("call to the unbound extern \"" + name + "\"");
+		});
+	}
+}
+
+void Interpreter::bind(const std::string& name, HostFunction function) {
+	auto ext = this->module.extern_indices.find(name);
+	if (ext != this->module.extern_indices.end()) {
+		this->externs[ext->second] = std::move(function);
+		this->native_externs[ext->second] = nullptr;
+	}
+}
+
+int64_t Interpreter::function_index(const std::string& name) const {
+	auto function = this->module.function_indices.find(name);
+	return function == this->module.function_indices.end() ? -1 : function->second;
+}
+
+const std::vector<uint64_t>& Interpreter::call_counts() const {
+	return this->calls;
+}
+
+const std::vector<uint64_t>& Interpreter::loop_counts() const {
+	return this->loops;
+}
+
+void Interpreter::set_hot_callback(uint64_t call_threshold, uint64_t loop_threshold, std::function<void(uint32_t)> callback) {
+	this->call_threshold = call_threshold;
+	this->loop_threshold = loop_threshold;
+	this->hot_callback = std::move(callback);
+}
+
+void Interpreter::set_native_entry(uint32_t function_index, NativeEntry entry) {
+	this->native_entries[function_index].store(entry, std::memory_order_release);
+}
+
+bool Interpreter::has_native_entry(uint32_t function_index) const {
+	return this->native_entries[function_index].load(std::memory_order_acquire) != nullptr;
+}
+
+Slot* Interpreter::global_address(uint32_t global_index) {
+	return &this->globals[this->module.globals.at(global_index).offset];
+}
+
+void* Interpreter::array_elements(Slot reference) {
+	return reference.p;
+}
+
+void* Interpreter::native_extern(uint32_t extern_index) const {
+	return this->native_externs.at(extern_index);
+}
+
+void Interpreter::check_signature(const std::string& kind, const std::string& name, const std::vector<VarType>& param_types, ReturnType return_type, const std::vector<ReturnType>& actual_param_types, ReturnType actual_return_type) const {
+	bool matches = param_types.size() == actual_param_types.size() && return_type == actual_return_type;
+	for (size_t i = 0; matches && i < param_types.size(); i++) {
+		matches = (size_t)param_types[i] == (size_t)actual_param_types[i];
+	}
+
+	if (!matches) {
+		throw InterpreterError("the " + kind + " \"" + name + "\" does not have the signature it is used with");
+	}
+}
+
+Slot Interpreter::call(uint32_t function_index, const Slot* args) {
+	auto& function = this->module.functions.at(function_index);
+
+	if (auto native = this->native_entries[function_index].load(std::memory_order_acquire)) {
+		Slot result = Slot();
+		native(args, &result);
+		return result;
+	}
+
+	Slot* base = this->stack_top;
+	if (base + function.num_param_registers > this->stack.data() + this->stack.size()) {
+		throw InterpreterError("stack overflow");
+	}
+	std::copy(args, args + function.num_param_registers, base);
+
+	RestoreTop restore { this->stack_top, base };
+
+	return this->run(function_index, base);
+}
+
+Slot Interpreter::run(uint32_t function_index, Slot* base) {
+	// The caller's state while a call runs. The caller's Call instruction, just before return_pc, says
+	// which register the result goes in.
+	struct Frame {
+		uint32_t function;
+		const Instruction* code;
+		const Instruction* return_pc;
+		Slot* base;
+	};
+	std::vector<Frame> frames;
+
+	const bytecode::Function* functions = this->module.functions.data();
+	Slot* globals = this->globals.data();
+	Slot* stack_end = this->stack.data() + this->stack.size();
+	uint64_t* calls = this->calls.data();
+	uint64_t* loops = this->loops.data();
+	std::atomic<NativeEntry>* native_entries = this->native_entries.get();
+
+	uint32_t current = 0; // the running function
+	const Instruction* code = nullptr; // the running function's code, which jumps are relative to
+	const Instruction* pc = nullptr;
+	Slot* r = base;
+
+	// Enter a function whose arguments are in place at new_base. Locals start at zero, as globals do.
+	auto enter = [&](uint32_t index, Slot* new_base) {
+		auto& callee = functions[index];
+		if (callee.code.empty()) {
+			throw InterpreterError("the function \"" + callee.name + "\" has no body");
+		}
+		if (new_base + callee.num_registers > stack_end) {
+			throw InterpreterError("stack overflow");
+		}
+
+		std::fill(new_base + callee.num_param_registers, new_base + callee.num_registers, Slot());
+		if (++calls[index] == this->call_threshold && this->hot_callback) {
+			this->hot_callback(index);
+		}
+		current = index;
+		r = new_base;
+		code = callee.code.data();
+		pc = code;
+	};
+
+	enter(function_index, base);
+
+	// Array bounds are always checked, whatever the generated code does. Elements are read and written
+	// with memcpy, as they are packed rather than stored in Slots.
+	auto element = [&](Slot reference, Slot length, Slot index, size_t size) -> char* {
+		if (static_cast<uint32_t>(index.i) >= static_cast<uint32_t>(length.i)) {
+			throw out_of_bounds(index.i, length.i);
+		}
+
+		return static_cast<char*>(reference.p) + static_cast<size_t>(index.i) * size;
+	};
+
+#ifdef MINIC_COMPUTED_GOTO
+	static const void* const dispatch_table[] = {
+		#define BYTECODE_OPCODE_LABEL(name) &&op_##name,
+		BYTECODE_OPCODES(BYTECODE_OPCODE_LABEL)
+		#undef BYTECODE_OPCODE_LABEL
+	};
+	#define CASE(name) op_##name:
+	#define DISPATCH() goto *dispatch_table[static_cast<size_t>(pc->op)]
+	#define NEXT() pc++; DISPATCH()
+
+	DISPATCH();
+#else
+	#define CASE(name) case Opcode::name:
+	#define DISPATCH() continue
+	#define NEXT() pc++; continue
+
+	for (;;) switch (pc->op) {
+#endif
+
+	CASE(LoadConst) {
+		r[pc->a].i = static_cast<int32_t>(pc->b);
+		NEXT();
+	}
+	CASE(LoadWideConst) {
+		r[pc->a].l = static_cast<int64_t>(pc->b | static_cast<uint64_t>(pc->c) << 32);
+		NEXT();
+	}
+	CASE(Move) {
+		r[pc->a] = r[pc->b];
+		NEXT();
+	}
+	CASE(LoadGlobal) {
+		r[pc->a] = globals[pc->b];
+		NEXT();
+	}
+	CASE(StoreGlobal) {
+		globals[pc->a] = r[pc->b];
+		NEXT();
+	}
+	CASE(ArrayRef) {
+		r[pc->a].p = r + pc->b;
+		NEXT();
+	}
+	CASE(GlobalArrayRef) {
+		r[pc->a].p = globals + pc->b;
+		NEXT();
+	}
+	CASE(LoadElement) {
+		std::memcpy(&r[pc->a].i, element(r[pc->b], r[pc->b + 1], r[pc->c], sizeof(int32_t)), sizeof(int32_t));
+		NEXT();
+	}
+	CASE(StoreElement) {
+		std::memcpy(element(r[pc->a], r[pc->a + 1], r[pc->b], sizeof(int32_t)), &r[pc->c].i, sizeof(int32_t));
+		NEXT();
+	}
+	CASE(LoadWideElement) {
+		std::memcpy(&r[pc->a].l, element(r[pc->b], r[pc->b + 1], r[pc->c], sizeof(int64_t)), sizeof(int64_t));
+		NEXT();
+	}
+	CASE(StoreWideElement) {
+		std::memcpy(element(r[pc->a], r[pc->a + 1], r[pc->b], sizeof(int64_t)), &r[pc->c].l, sizeof(int64_t));
+		NEXT();
+	}
+
+	CASE(IntToFloat) { r[pc->a].f = static_cast<float>(r[pc->b].i); NEXT(); }
+	CASE(IntToLong) { r[pc->a].l = r[pc->b].i; NEXT(); }
+	CASE(IntToDouble) { r[pc->a].d = r[pc->b].i; NEXT(); }
+	CASE(LongToFloat) { r[pc->a].f = static_cast<float>(r[pc->b].l); NEXT(); }
+	CASE(LongToDouble) { r[pc->a].d = static_cast<double>(r[pc->b].l); NEXT(); }
+	CASE(FloatToDouble) { r[pc->a].d = r[pc->b].f; NEXT(); }
+
+	// Integer arithmetic wraps, as it does in the generated code
+	CASE(AddI) {
+		r[pc->a].i = static_cast<int32_t>(static_cast<uint32_t>(r[pc->b].i) + static_cast<uint32_t>(r[pc->c].i));
+		NEXT();
+	}
+	CASE(SubI) {
+		r[pc->a].i = static_cast<int32_t>(static_cast<uint32_t>(r[pc->b].i) - static_cast<uint32_t>(r[pc->c].i));
+		NEXT();
+	}
+	CASE(MulI) {
+		r[pc->a].i = static_cast<int32_t>(static_cast<uint32_t>(r[pc->b].i) * static_cast<uint32_t>(r[pc->c].i));
+		NEXT();
+	}
+	CASE(DivI) {
+		int32_t lhs = r[pc->b].i, rhs = r[pc->c].i;
+		if (rhs == 0) {
+			throw InterpreterError("division by zero");
+		}
+		r[pc->a].i = (lhs == INT32_MIN && rhs == -1) ? INT32_MIN : lhs / rhs;
+		NEXT();
+	}
+	CASE(RemI) {
+		int32_t lhs = r[pc->b].i, rhs = r[pc->c].i;
+		if (rhs == 0) {
+			throw InterpreterError("division by zero");
+		}
+		r[pc->a].i = rhs == -1 ? 0 : lhs % rhs;
+		NEXT();
+	}
+	CASE(NegI) {
+		r[pc->a].i = static_cast<int32_t>(0u - static_cast<uint32_t>(r[pc->b].i));
+		NEXT();
+	}
+	CASE(LtI) { r[pc->a].i = r[pc->b].i < r[pc->c].i; NEXT(); }
+	CASE(LeI) { r[pc->a].i = r[pc->b].i <= r[pc->c].i; NEXT(); }
+	CASE(GtI) { r[pc->a].i = r[pc->b].i > r[pc->c].i; NEXT(); }
+	CASE(GeI) { r[pc->a].i = r[pc->b].i >= r[pc->c].i; NEXT(); }
+	CASE(EqI) { r[pc->a].i = r[pc->b].i == r[pc->c].i; NEXT(); }
+	CASE(NeI) { r[pc->a].i = r[pc->b].i != r[pc->c].i; NEXT(); }
+
+	CASE(AddL) {
+		r[pc->a].l = static_cast<int64_t>(static_cast<uint64_t>(r[pc->b].l) + static_cast<uint64_t>(r[pc->c].l));
+		NEXT();
+	}
+	CASE(SubL) {
+		r[pc->a].l = static_cast<int64_t>(static_cast<uint64_t>(r[pc->b].l) - static_cast<uint64_t>(r[pc->c].l));
+		NEXT();
+	}
+	CASE(MulL) {
+		r[pc->a].l = static_cast<int64_t>(static_cast<uint64_t>(r[pc->b].l) * static_cast<uint64_t>(r[pc->c].l));
+		NEXT();
+	}
+	CASE(DivL) {
+		int64_t lhs = r[pc->b].l, rhs = r[pc->c].l;
+		if (rhs == 0) {
+			throw InterpreterError("division by zero");
+		}
+		r[pc->a].l = (lhs == INT64_MIN && rhs == -1) ? INT64_MIN : lhs / rhs;
+		NEXT();
+	}
+	CASE(RemL) {
+		int64_t lhs = r[pc->b].l, rhs = r[pc->c].l;
+		if (rhs == 0) {
+			throw InterpreterError("division by zero");
+		}
+		r[pc->a].l = rhs == -1 ? 0 : lhs % rhs;
+		NEXT();
+	}
+	CASE(NegL) {
+		r[pc->a].l = static_cast<int64_t>(0u - static_cast<uint64_t>(r[pc->b].l));
+		NEXT();
+	}
+	CASE(LtL) { r[pc->a].i = r[pc->b].l < r[pc->c].l; NEXT(); }
+	CASE(LeL) { r[pc->a].i = r[pc->b].l <= r[pc->c].l; NEXT(); }
+	CASE(GtL) { r[pc->a].i = r[pc->b].l > r[pc->c].l; NEXT(); }
+	CASE(GeL) { r[pc->a].i = r[pc->b].l >= r[pc->c].l; NEXT(); }
+	CASE(EqL) { r[pc->a].i = r[pc->b].l == r[pc->c].l; NEXT(); }
+	CASE(NeL) { r[pc->a].i = r[pc->b].l != r[pc->c].l; NEXT(); }
+
+	CASE(AddF) { r[pc->a].f = r[pc->b].f + r[pc->c].f; NEXT(); }
+	CASE(SubF) { r[pc->a].f = r[pc->b].f - r[pc->c].f; NEXT(); }
+	CASE(MulF) { r[pc->a].f = r[pc->b].f * r[pc->c].f; NEXT(); }
+	CASE(DivF) { r[pc->a].f = r[pc->b].f / r[pc->c].f; NEXT(); }
+	CASE(NegF) { r[pc->a].f = -r[pc->b].f; NEXT(); }
+	// Float comparisons are ordered (false if either side is NaN), including !=, as in the generated code
+	CASE(LtF) { r[pc->a].i = r[pc->b].f < r[pc->c].f; NEXT(); }
+	CASE(LeF) { r[pc->a].i = r[pc->b].f <= r[pc->c].f; NEXT(); }
+	CASE(GtF) { r[pc->a].i = r[pc->b].f > r[pc->c].f; NEXT(); }
+	CASE(GeF) { r[pc->a].i = r[pc->b].f >= r[pc->c].f; NEXT(); }
+	CASE(EqF) { r[pc->a].i = r[pc->b].f == r[pc->c].f; NEXT(); }
+	CASE(NeF) { r[pc->a].i = r[pc->b].f < r[pc->c].f || r[pc->b].f > r[pc->c].f; NEXT(); }
+
+	CASE(AddD) { r[pc->a].d = r[pc->b].d + r[pc->c].d; NEXT(); }
+	CASE(SubD) { r[pc->a].d = r[pc->b].d - r[pc->c].d; NEXT(); }
+	CASE(MulD) { r[pc->a].d = r[pc->b].d * r[pc->c].d; NEXT(); }
+	CASE(DivD) { r[pc->a].d = r[pc->b].d / r[pc->c].d; NEXT(); }
+	CASE(NegD) { r[pc->a].d = -r[pc->b].d; NEXT(); }
+	CASE(LtD) { r[pc->a].i = r[pc->b].d < r[pc->c].d; NEXT(); }
+	CASE(LeD) { r[pc->a].i = r[pc->b].d <= r[pc->c].d; NEXT(); }
+	CASE(GtD) { r[pc->a].i = r[pc->b].d > r[pc->c].d; NEXT(); }
+	CASE(GeD) { r[pc->a].i = r[pc->b].d >= r[pc->c].d; NEXT(); }
+	CASE(EqD) { r[pc->a].i = r[pc->b].d == r[pc->c].d; NEXT(); }
+	CASE(NeD) { r[pc->a].i = r[pc->b].d < r[pc->c].d || r[pc->b].d > r[pc->c].d; NEXT(); }
+
+	// Both operands of && and || have been evaluated, as in the generated code
+	CASE(EqB) { r[pc->a].i = r[pc->b].i == r[pc->c].i; NEXT(); }
+	CASE(NeB) { r[pc->a].i = r[pc->b].i != r[pc->c].i; NEXT(); }
+	CASE(And) { r[pc->a].i = r[pc->b].i & r[pc->c].i; NEXT(); }
+	CASE(Or) { r[pc->a].i = r[pc->b].i | r[pc->c].i; NEXT(); }
+	CASE(Not) { r[pc->a].i = !r[pc->b].i; NEXT(); }
+
+	CASE(Jump) {
+		pc = code + pc->b;
+		DISPATCH();
+	}
+	CASE(Loop) {
+		if (++loops[current] == this->loop_threshold && this->hot_callback) {
+			this->hot_callback(current);
+		}
+		pc = code + pc->b;
+		DISPATCH();
+	}
+	CASE(JumpIfFalse) {
+		if (r[pc->a].i == 0) {
+			pc = code + pc->b;
+			DISPATCH();
+		}
+		NEXT();
+	}
+	CASE(Call) {
+		if (auto native = native_entries[pc->b].load(std::memory_order_acquire)) {
+			Slot result = Slot();
+			native(r + pc->c, &result);
+			r[pc->a] = result;
+			NEXT();
+		}
+
+		frames.push_back({ current, code, pc + 1, r });
+		enter(pc->b, r + pc->c);
+		DISPATCH();
+	}
+	CASE(CallExtern) {
+		// The arguments are the top of the frame, so host functions that call back in start above them
+		Slot result;
+		{
+			RestoreTop restore { this->stack_top, this->stack_top };
+			this->stack_top = r + pc->c + this->module.externs[pc->b].num_param_registers;
+			result = this->externs[pc->b](r + pc->c);
+		}
+
+		r[pc->a] = result;
+		NEXT();
+	}
+	CASE(Return) {
+		Slot result = r[pc->a];
+		if (frames.empty()) {
+			return result;
+		}
+
+		auto& frame = frames.back();
+		current = frame.function;
+		code = frame.code;
+		r = frame.base;
+		pc = frame.return_pc;
+		r[(pc - 1)->a] = result;
+		frames.pop_back();
+		DISPATCH();
+	}
+	CASE(ReturnVoid) {
+		if (frames.empty()) {
+			return Slot();
+		}
+
+		auto& frame = frames.back();
+		current = frame.function;
+		code = frame.code;
+		r = frame.base;
+		pc = frame.return_pc;
+		frames.pop_back();
+		DISPATCH();
+	}
+
+#ifndef MINIC_COMPUTED_GOTO
+	}
+#endif
+
+	#undef CASE
+	#undef DISPATCH
+	#undef NEXT
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+#include "bytecode.hpp"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Conversions between C++ values and registers, for calls across the host boundary
+template <typename T>
+struct SlotCast;
+
+template <>
+struct SlotCast<int> {
+	static const ReturnType return_type = ReturnType::Int;
+	static int get(bytecode::Slot slot) { return slot.i; }
+	static bytecode::Slot make(int value) { bytecode::Slot slot; slot.i = value; return slot; }
+};
+
+template <>
+struct SlotCast<float> {
+	static const ReturnType return_type = ReturnType::Float;
+	static float get(bytecode::Slot slot) { return slot.f; }
+	static bytecode::Slot make(float value) { bytecode::Slot slot; slot.f = value; return slot; }
+};
+
+template <>
+struct SlotCast<int64_t> {
+	static const ReturnType return_type = ReturnType::Long;
+	static int64_t get(bytecode::Slot slot) { return slot.l; }
+	static bytecode::Slot make(int64_t value) { bytecode::Slot slot; slot.l = value; return slot; }
+};
+
+template <>
+struct SlotCast<double> {
+	static const ReturnType return_type = ReturnType::Double;
+	static double get(bytecode::Slot slot) { return slot.d; }
+	static bytecode::Slot make(double value) { bytecode::Slot slot; slot.d = value; return slot; }
+};
+
+template <>
+struct SlotCast<bool> {
+	static const ReturnType return_type = ReturnType::Bool;
+	static bool get(bytecode::Slot slot) { return slot.i != 0; }
+	static bytecode::Slot make(bool value) { bytecode::Slot slot; slot.i = value ? 1 : 0; return slot; }
+};
+
+template <>
+struct SlotCast<void> {
+	static const ReturnType return_type = ReturnType::Void;
+	static void get(bytecode::Slot) { }
+};
+
+// Thrown when a program fails at run time, e.g. by calling an unbound extern, dividing by zero or
+// overflowing the stack
+class InterpreterError : public std::runtime_error {
+public:
+	InterpreterError(const std::string& message) : std::runtime_error(message) { }
+};
+
+// Runs a bytecode::Module (see BytecodeCompiler). The interpreter keeps the program's globals and its
+// stack of registers, and refers to the module, which must outlive it. Externs are bound to host
+// functions by name. Calls run on the caller's thread, and one Interpreter must only run one call at a
+// time, but host functions may call back into it.
+//
+// Array indices are always checked, and indexing out of bounds throws an InterpreterError.
+//
+// For tiered execution, the interpreter counts the calls to each function and the back edges taken in
+// its loops, and reports a function as hot when either count reaches its threshold. Any function can be
+// given native code at any time, from any thread, and every call made after that runs the native code.
+class Interpreter {
+public:
+	using HostFunction = std::function<bytecode::Slot(const bytecode::Slot* args)>;
+	// Native code for a function, taking its arguments and returning its result as registers
+	using NativeEntry = void (*)(const bytecode::Slot* args, bytecode::Slot* result);
+
+	Interpreter(const bytecode::Module& module, size_t stack_size = 1 << 20);
+
+	// Binding a name the program does not declare as an extern does nothing
+	void bind(const std::string& name, HostFunction function);
+
+	// Binds a C++ function, which must have the extern's signature
+	template <typename R, typename... Args>
+	void bind_native(const std::string& name, R (*function)(Args...));
+
+	// The index of the named function, or -1 if there is no such function
+	int64_t function_index(const std::string& name) const;
+
+	// Runs a function, with its arguments in "args"
+	bytecode::Slot call(uint32_t function_index, const bytecode::Slot* args);
+
+	// A callable for the named function, which must have the signature T
+	template <typename T>
+	std::function<T> function(const std::string& name);
+
+	// Number of calls the interpreter has made to each function, and of loop back edges it has taken in
+	// each, indexed as module.functions
+	const std::vector<uint64_t>& call_counts() const;
+	const std::vector<uint64_t>& loop_counts() const;
+
+	// The callback is made on the interpreting thread, at most once per function for each threshold
+	void set_hot_callback(uint64_t call_threshold, uint64_t loop_threshold, std::function<void(uint32_t function_index)> callback);
+	void set_native_entry(uint32_t function_index, NativeEntry entry);
+	bool has_native_entry(uint32_t function_index) const;
+
+	// Where a global is stored, so that native code can share it. Every global takes up one Slot, whose
+	// first bytes hold the value as native code stores it, except that a bool is its first byte, and an
+	// array's elements are packed as they are in native code (see bytecode::element_size).
+	bytecode::Slot* global_address(uint32_t global_index);
+	// The C++ function an extern was bound to with bind_native, or nullptr
+	void* native_extern(uint32_t extern_index) const;
+
+	// The first element of an array, for host functions given one. An array argument is two registers,
+	// its reference and its length. The elements are packed, as an array of int32_t, float, int64_t or
+	// double, with an int32_t of 0 or 1 for each bool.
+	void* array_elements(bytecode::Slot reference);
+
+private:
+	bytecode::Slot run(uint32_t function_index, bytecode::Slot* base);
+	void check_signature(const std::string& kind, const std::string& name, const std::vector<VarType>& param_types, ReturnType return_type, const std::vector<ReturnType>& actual_param_types, ReturnType actual_return_type) const;
+
+	const bytecode::Module& module;
+	std::vector<bytecode::Slot> globals;
+	std::vector<HostFunction> externs;
+	std::vector<void*> native_externs;
+
+	std::vector<uint64_t> calls;
+	std::vector<uint64_t> loops;
+	uint64_t call_threshold = 0; // 0 when there is no hot callback
+	uint64_t loop_threshold = 0;
+	std::function<void(uint32_t)> hot_callback;
+	std::unique_ptr<std::atomic<NativeEntry>[]> native_entries;
+
+	std::vector<bytecode::Slot> stack;
+	bytecode::Slot* stack_top; // the first register not used by a running call
+};
+
+namespace interp_detail {
+
+	template <size_t... I>
+	struct Indices { };
+
+	template <size_t N, size_t... I>
+	struct MakeIndices : MakeIndices<N - 1, N - 1, I...> { };
+
+	template <size_t... I>
+	struct MakeIndices<0, I...> {
+		using type = Indices<I...>;
+	};
+
+	template <typename R, typename... Args>
+	struct NativeCall {
+		template <size_t... I>
+		static bytecode::Slot call(R (*function)(Args...), const bytecode::Slot* args, Indices<I...>) {
+			return SlotCast<R>::make(function(SlotCast<Args>::get(args[I])...));
+		}
+	};
+
+	template <typename... Args>
+	struct NativeCall<void, Args...> {
+		template <size_t... I>
+		static bytecode::Slot call(void (*function)(Args...), const bytecode::Slot* args, Indices<I...>) {
+			function(SlotCast<Args>::get(args[I])...);
+			return bytecode::Slot();
+		}
+	};
+
+	template <typename T>
+	struct InterpretedFunction;
+
+	template <typename R, typename... Args>
+	struct InterpretedFunction<R(Args...)> {
+		static std::vector<ReturnType> param_types() {
+			return { SlotCast<Args>::return_type... };
+		}
+
+		static std::function<R(Args...)> make(Interpreter& interpreter, uint32_t index) {
+			return [&interpreter, index](Args... args) {
+				// One extra slot, so that the array is never empty
+				bytecode::Slot slots[] = { SlotCast<Args>::make(args)..., bytecode::Slot() };
+				return SlotCast<R>::get(interpreter.call(index, slots));
+			};
+		}
+	};
+
+}
+
+template <typename R, typename... Args>
+void Interpreter::bind_native(const std::string& name, R (*function)(Args...)) {
+	auto ext = this->module.extern_indices.find(name);
+	if (ext == this->module.extern_indices.end()) {
+		return;
+	}
+
+	auto& decl = this->module.externs[ext->second];
+	this->check_signature("extern", name, decl.param_types, decl.return_type, { SlotCast<Args>::return_type... }, SlotCast<R>::return_type);
+
+	this->bind(name, [function](const bytecode::Slot* args) {
+		return interp_detail::NativeCall<R, Args...>::call(function, args, typename interp_detail::MakeIndices<sizeof...(Args)>::type());
+	});
+	this->native_externs[ext->second] = reinterpret_cast<void*>(function);
+}
+
+template <typename T>
+std::function<T> Interpreter::function(const std::string& name) {
+	int64_t index = this->function_index(name);
+	if (index < 0) {
+		throw InterpreterError("no function called \"" + name + "\"");
+	}
+
+	auto& decl = this->module.functions[index];
+	this->check_signature("function", name, decl.param_types, decl.return_type, interp_detail::InterpretedFunction<T>::param_types(), SlotCast<typename std::function<T>::result_type>::return_type);
+
+	return interp_detail::InterpretedFunction<T>::make(*this, index);
+}
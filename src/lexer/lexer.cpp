@@ -46,8 +46,16 @@ namespace lexer {
 			if (identifier == boost::string_ref("int"))    return Token(Token::Type::Int,     identifier, this->current_line, column_num);
 			if (identifier == boost::string_ref("bool"))   return Token(Token::Type::Bool,    identifier, this->current_line, column_num);
 			if (identifier == boost::string_ref("float"))  return Token(Token::Type::Float,   identifier, this->current_line, column_num);
+			if (identifier == boost::string_ref("long"))   return Token(Token::Type::Long,    identifier, this->current_line, column_num);
+			if (identifier == boost::string_ref("double")) return Token(Token::Type::Double,  identifier, this->current_line, column_num);
+			if (identifier == boost::string_ref("int4"))   return Token(Token::Type::Int4,    identifier, this->current_line, column_num);
+			if (identifier == boost::string_ref("int8"))   return Token(Token::Type::Int8,    identifier, this->current_line, column_num);
+			if (identifier == boost::string_ref("float4")) return Token(Token::Type::Float4,  identifier, this->current_line, column_num);
+			if (identifier == boost::string_ref("float8")) return Token(Token::Type::Float8,  identifier, this->current_line, column_num);
 			if (identifier == boost::string_ref("void"))   return Token(Token::Type::Void,    identifier, this->current_line, column_num);
 			if (identifier == boost::string_ref("extern")) return Token(Token::Type::Extern,  identifier, this->current_line, column_num);
+			if (identifier == boost::string_ref("inline")) return Token(Token::Type::Inline,  identifier, this->current_line, column_num);
+			if (identifier == boost::string_ref("const"))  return Token(Token::Type::Const,   identifier, this->current_line, column_num);
 			if (identifier == boost::string_ref("if"))     return Token(Token::Type::If,      identifier, this->current_line, column_num);
 			if (identifier == boost::string_ref("else"))   return Token(Token::Type::Else,    identifier, this->current_line, column_num);
 			if (identifier == boost::string_ref("while"))  return Token(Token::Type::While,   identifier, this->current_line, column_num);
@@ -69,6 +77,8 @@ namespace lexer {
 				case '}': return Token(Token::Type::RBrace,    str.substr(i++, 1), this->current_line, column_num);
 				case '(': return Token(Token::Type::LParen,    str.substr(i++, 1), this->current_line, column_num);
 				case ')': return Token(Token::Type::RParen,    str.substr(i++, 1), this->current_line, column_num);
+				case '[': return Token(Token::Type::LBracket,  str.substr(i++, 1), this->current_line, column_num);
+				case ']': return Token(Token::Type::RBracket,  str.substr(i++, 1), this->current_line, column_num);
 				case ';': return Token(Token::Type::SemiColon, str.substr(i++, 1), this->current_line, column_num);
 				case ',': return Token(Token::Type::Comma,     str.substr(i++, 1), this->current_line, column_num);
 				case '-': return Token(Token::Type::Minus,     str.substr(i++, 1), this->current_line, column_num);
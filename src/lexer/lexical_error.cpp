@@ -17,3 +17,11 @@ const char* LexicalError::what() const noexcept {
 	return this->err_string.c_str();
 }
 
+unsigned int LexicalError::line() const noexcept {
+	return this->line_num;
+}
+
+unsigned int LexicalError::column() const noexcept {
+	return this->column_num;
+}
+
@@ -7,6 +7,8 @@ class LexicalError : public std::exception {
 public:
 	LexicalError(boost::string_ref bad_input, unsigned int line_num, unsigned int column_num) noexcept;
 	const char* what() const noexcept override;
+	unsigned int line() const noexcept;
+	unsigned int column() const noexcept;
 
 private:
 	boost::string_ref bad_input;
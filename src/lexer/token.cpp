@@ -14,11 +14,19 @@ namespace lexer {
 			case Token::Type::Int: return "type keyword \"int\"";
 			case Token::Type::Bool: return "type keyword \"bool\"";
 			case Token::Type::Float: return "type keyword \"float\"";
+			case Token::Type::Long: return "type keyword \"long\"";
+			case Token::Type::Double: return "type keyword \"double\"";
+			case Token::Type::Int4: return "type keyword \"int4\"";
+			case Token::Type::Int8: return "type keyword \"int8\"";
+			case Token::Type::Float4: return "type keyword \"float4\"";
+			case Token::Type::Float8: return "type keyword \"float8\"";
 			case Token::Type::Void: return "type keyword \"void\"";
 			case Token::Type::IntLit: return "integer";
 			case Token::Type::FloatLit: return "float";
 			case Token::Type::BoolLit: return "boolean";
 			case Token::Type::Extern: return "keyword \"extern\"";
+			case Token::Type::Inline: return "keyword \"inline\"";
+			case Token::Type::Const: return "keyword \"const\"";
 			case Token::Type::If: return "keyword \"if\"";
 			case Token::Type::Else: return "keyword \"else\"";
 			case Token::Type::While: return "keyword \"while\"";
@@ -30,6 +38,8 @@ namespace lexer {
 			case Token::Type::RBrace: return "operator \"}\"";
 			case Token::Type::LParen: return "operator \"(\"";
 			case Token::Type::RParen: return "operator \")\"";
+			case Token::Type::LBracket: return "operator \"[\"";
+			case Token::Type::RBracket: return "operator \"]\"";
 			case Token::Type::SemiColon: return "symbol \";\"";
 			case Token::Type::Comma: return "symbol \",\"";
 			case Token::Type::BitAnd: return "operator \"&\"";
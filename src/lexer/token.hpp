@@ -11,11 +11,19 @@ namespace lexer {
 			Int,
 			Bool,
 			Float,
+			Long,
+			Double,
+			Int4,
+			Int8,
+			Float4,
+			Float8,
 			Void,
 			IntLit,
 			BoolLit,
 			FloatLit,
 			Extern,
+			Inline,
+			Const,
 			If,
 			Else,
 			While,
@@ -27,6 +35,8 @@ namespace lexer {
 			RBrace,
 			LParen,
 			RParen,
+			LBracket,
+			RBracket,
 			SemiColon,
 			Comma,
 			Minus,
@@ -2,65 +2,308 @@
 #include <vector>
 #include <boost/utility/string_ref.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
-#include "lexer/lexer.hpp"
 #include <fstream>
 #include <sstream>
 #include <exception>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <memory>
 
-#include "ast/expr.hpp"
-#include "ast/statement.hpp"
-#include "ast/declaration.hpp"
-#include "ast/tree_printer.hpp"
+#include <llvm/ADT/SmallString.h>
+#include "cache/compile_cache.hpp"
+#include "cache/function_cache.hpp"
+#include "timing/time_report.hpp"
+#include "interp/interpreter.hpp"
+#include "compiler/compiler_instance.hpp"
 
-#include "parser/parse.hpp"
-#include "parser/token_stream.hpp"
-#include <memory>
+// Print the errors of a compile as mccomp always has: those from parsing and type checking to stdout,
+// followed by how many there were, and any other to stderr
+void report_errors(const std::vector<Diagnostic>& diags) {
+	size_t count = 0;
+	for (auto& diag : diags) {
+		if (diag.phase == Diagnostic::Phase::Parsing || diag.phase == Diagnostic::Phase::TypeChecking) {
+			std::cout << diag.message << std::endl << std::endl;
+			count++;
+		} else {
+			std::cerr << diag.message << std::endl;
+		}
+	}
+
+	if (count > 0) {
+		std::cout << count << (count == 1 ? " error" : " errors") << " found." << std::endl;
+	}
+}
+
+// The externs the test drivers provide, for programs run by --run
+int host_print_int(int x) {
+	fprintf(stderr, "%d\n", x);
+	return 0;
+}
+
+float host_print_float(float x) {
+	fprintf(stderr, "%f\n", x);
+	return 0;
+}
 
-#include "codegen/codegen.hpp"
+// Interpret one of the program's functions, which must take no parameters, printing what it returns
+int run_interpreted(const bytecode::Module& module, const std::string& function_name, bool print_bytecode, TimeReport* time_report) {
+	if (print_bytecode) {
+		module.print(std::cout);
+	}
+
+	auto index = module.function_indices.find(function_name);
+	if (index == module.function_indices.end() || !module.functions[index->second].param_types.empty()) {
+		std::cerr << "usage error: --run needs a function without parameters, and there is no function \"" << function_name << "\" that takes none" << std::endl;
+		return 1;
+	}
+
+	Interpreter interpreter(module);
+	interpreter.bind_native("print_int", &host_print_int);
+	interpreter.bind_native("print_float", &host_print_float);
+
+	bytecode::Slot result;
+	try {
+		TimeScope timer(time_report, "Interpret");
+		result = interpreter.call(index->second, nullptr);
+	} catch (const InterpreterError& e) {
+		std::cerr << "runtime error: " << e.what() << std::endl;
+		return 1;
+	}
+
+	switch (module.functions[index->second].return_type) {
+		case ReturnType::Int: std::cout << result.i << std::endl; break;
+		case ReturnType::Float: std::cout << result.f << std::endl; break;
+		case ReturnType::Bool: std::cout << (result.i != 0 ? "true" : "false") << std::endl; break;
+		case ReturnType::Long: std::cout << result.l << std::endl; break;
+		case ReturnType::Double: std::cout << result.d << std::endl; break;
+		case ReturnType::Void: break;
+		// Programs using vectors do not compile to bytecode
+		default: break;
+	}
+
+	return 0;
+}
 
 int main(int argc, char** argv) {
 	// Parse command line arguments
+	char* filepath = nullptr;
+	std::string output_path = "output.ll"; // "-" for stdout
+	bool check_only = false;
+	const char* run_function = nullptr; // interpret this function instead of generating code
+	bool print_bytecode = false;
+	const char* cache_dir = std::getenv("MCCOMP_CACHE_DIR");
+	uint64_t cache_size_mb = 256;
+	bool print_cache_stats = false;
+	bool incremental = false; // only regenerate the functions that changed since the last compile
+	bool time_summary = false;
+	const char* time_trace = nullptr;
+	bool inline_report = false; // print which functions are inlined into their callers, and why
+	std::string output_options; // every option that changes the generated code, as part of the cache key
+
+	// Optimised at -O0, which only inlines the functions the InlineCostModel chose, unless -O1 or above is
+	// given
+	CompilerOptions options;
+	options.optimize = true;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg(argv[i]);
+
+		if (arg == "-o") {
+			if (i + 1 == argc) {
+				std::cerr << "usage error: -o needs an output path" << std::endl;
+				return 1;
+			}
+			output_path = argv[++i];
+		} else if (arg.compare(0, 2, "-o") == 0) {
+			output_path = argv[i] + 2;
+		} else if (arg == "--check" || arg == "--syntax-only") {
+			check_only = true;
+		} else if (arg.compare(0, 6, "--run=") == 0) {
+			run_function = argv[i] + 6;
+		} else if (arg == "--print-bytecode") {
+			print_bytecode = true;
+		} else if (arg.compare(0, 13, "--parse-jobs=") == 0) {
+			options.parse_jobs = std::max(std::atoi(arg.c_str() + 13), 1);
+		} else if (arg.compare(0, 12, "--cache-dir=") == 0) {
+			cache_dir = argv[i] + 12;
+		} else if (arg.compare(0, 13, "--cache-size=") == 0) {
+			cache_size_mb = std::strtoull(arg.c_str() + 13, nullptr, 10);
+		} else if (arg == "--cache-stats") {
+			print_cache_stats = true;
+		} else if (arg == "--incremental") {
+			incremental = true;
+		} else if (arg == "-fbounds-check") {
+			options.bounds_checks = true;
+			output_options += arg + " ";
+		} else if (arg.size() == 3 && arg.compare(0, 2, "-O") == 0 && arg[2] >= '0' && arg[2] <= '3') {
+			options.opt_level = arg[2] - '0';
+			output_options += arg + " ";
+		} else if (arg == "-march=native") {
+			options.target_native = true;
+			output_options += arg + " ";
+		} else if (arg.compare(0, 18, "-fvectorize-width=") == 0) {
+			options.loop_hints.vectorize_width = std::atoi(arg.c_str() + 18);
+			output_options += arg + " ";
+		} else if (arg.compare(0, 19, "-finterleave-count=") == 0) {
+			options.loop_hints.interleave_count = std::atoi(arg.c_str() + 19);
+			output_options += arg + " ";
+		} else if (arg.compare(0, 15, "-funroll-count=") == 0) {
+			options.loop_hints.unroll_count = std::atoi(arg.c_str() + 15);
+			output_options += arg + " ";
+		} else if (arg.compare(0, 9, "--export=") == 0) {
+			std::istringstream names(arg.substr(9));
+			for (std::string name; std::getline(names, name, ',');) {
+				if (!name.empty()) {
+					options.exports.push_back(name);
+				}
+			}
+			output_options += arg + " ";
+		} else if (arg.compare(0, 7, "-Rpass=") == 0) {
+			options.remarks.passed = arg.substr(7);
+		} else if (arg.compare(0, 14, "-Rpass-missed=") == 0) {
+			options.remarks.missed = arg.substr(14);
+		} else if (arg.compare(0, 16, "-Rpass-analysis=") == 0) {
+			options.remarks.analysis = arg.substr(16);
+		} else if (arg == "-finline-report") {
+			inline_report = true;
+		} else if (arg == "-ftime-report") {
+			time_summary = true;
+		} else if (arg == "-ftime-trace") {
+			time_trace = "output.json";
+		} else if (arg.compare(0, 13, "-ftime-trace=") == 0) {
+			time_trace = argv[i] + 13;
+		} else if (arg[0] == '-') {
+			std::cerr << "usage error: unknown option \"" << arg << "\"" << std::endl;
+			return 1;
+		} else if (filepath != nullptr) {
+			std::cerr << "usage error: only supply a single minic file as command line argument!" << std::endl;
+			return -1;
+		} else {
+			filepath = argv[i];
+		}
+	}
+
+	std::unique_ptr<CompileCache> cache;
+	std::unique_ptr<FunctionCache> function_cache;
+	if (cache_dir != nullptr && *cache_dir != '\0') {
+		cache = llvm::make_unique<CompileCache>(cache_dir, cache_size_mb * 1024 * 1024);
+		function_cache = llvm::make_unique<FunctionCache>(std::string(cache_dir) + "/functions", cache_size_mb * 1024 * 1024);
+	} else if (print_cache_stats || incremental) {
+		std::cerr << "usage error: --cache-stats and --incremental require a cache directory (--cache-dir or MCCOMP_CACHE_DIR)" << std::endl;
+		return 1;
+	}
 
-	// If no parameters are supplied
-	if (argc == 1) {
+	if (print_cache_stats) {
+		auto print_stats = [](const char* name, const CompileCache::Stats& stats) {
+			std::cout
+				<< name << " hits: " << stats.hits << std::endl
+				<< name << " misses: " << stats.misses << std::endl
+				<< name << " entries: " << stats.entries << std::endl
+				<< name << " size: " << stats.size << " bytes" << std::endl;
+		};
+
+		print_stats("file", cache->stats());
+		print_stats("function", function_cache->stats());
+		return 0;
+	}
+
+	// If no file is supplied
+	if (filepath == nullptr) {
 		std::cerr << "usage error: supply a minic file to compile as a command line argument!" << std::endl;
 		return 1;
 	}
 
-	// If more than 1 parameter is supplied
-	if (argc > 2) {
-		std::cerr << "usage error: only supply a single minic file as command line argument!" << std::endl;
-		return -1;
+	// Reports are written when time_report is destroyed, however main returns
+	std::unique_ptr<TimeReport> time_report;
+	if (time_summary || time_trace != nullptr) {
+		time_report = llvm::make_unique<TimeReport>();
+		time_report->print_summary_on_exit = time_summary;
+		if (time_trace != nullptr) {
+			time_report->trace_path = time_trace;
+		}
 	}
 
-	char* filepath = argv[1];
+	// Only a compile that writes its output uses the caches
+	bool generate_code = !check_only && run_function == nullptr;
+	// Remarks are only made by the optimiser, so a compile that prints them cannot be served from the cache
+	bool remarks_requested = !options.remarks.passed.empty() || !options.remarks.missed.empty() || !options.remarks.analysis.empty();
 
+	// A check-only compile stops once the program is type checked, and a run in the interpreter only needs
+	// its bytecode
+	options.generate_llvm = generate_code;
+	options.generate_bytecode = !check_only && run_function != nullptr;
+	// The AST is printed unless stdout is taken by the output
+	options.print_ast = generate_code && output_path != "-";
+	options.inline_report = inline_report ? &std::cerr : nullptr;
+	options.time_report = time_report.get();
+	if (incremental && generate_code) {
+		options.function_cache = function_cache.get();
+		options.cache_options = output_options;
+	}
 
 	try {
 		// Memory map the file we want to compile. This allows for fast iteration during lexing.
 		boost::iostreams::mapped_file_source file(filepath);
 	
-		// Lex the file into our token stream.
-		lexer::Lexer l(boost::string_ref(file.data(), file.size()));
-		TokenStream ts;
-		l.lex(ts.tokens);
-
-		// Parse the program into AST
-		Parser p(ts);
-		auto prog = p.parse_program();
-
-		// Print AST
-		TreePrinter tp;
-		prog->accept_visitor(tp);
-
-		// Generate code into "output.ll"
-		CodeGenerator cg;
-		prog->accept_visitor(cg);
-		cg.write_to_file("output.ll");
+		// An unchanged file compiled with the same options is copied straight out of the cache
+		std::string cache_key;
+		if (cache != nullptr && generate_code && !remarks_requested) {
+			TimeScope timer(time_report.get(), "Cache lookup");
+			cache_key = CompileCache::make_key(boost::string_ref(file.data(), file.size()), output_options);
+			if (output_path == "-") {
+				auto contents = cache->fetch_contents(cache_key);
+				if (contents) {
+					std::cout << *contents;
+					return 0;
+				}
+			} else if (cache->fetch(cache_key, output_path.c_str())) {
+				file.close();
+				return 0;
+			}
+		}
+
+		CompilerInstance compiler(options);
+		Compilation compilation = compiler.compile(boost::string_ref(file.data(), file.size()));
+		if (!compilation.succeeded()) {
+			report_errors(compilation.diagnostics());
+			return 1;
+		}
+
+		if (check_only) {
+			file.close();
+			return 0;
+		}
+		if (run_function != nullptr) {
+			return run_interpreted(*compilation.bytecode(), run_function, print_bytecode, time_report.get());
+		}
+
+		{
+			TimeScope timer(time_report.get(), "Write output");
+			// Only stored under a key that was looked up, which a compile printing remarks skips
+			if (output_path != "-") {
+				compilation.write_ir(output_path);
+				if (!cache_key.empty()) {
+					cache->store(cache_key, output_path.c_str());
+				}
+			} else if (!cache_key.empty()) {
+				// stdout cannot be copied into the cache afterwards, so the IR is kept in memory
+				llvm::SmallString<0> ir;
+				compilation.emit_ir(ir);
+				std::cout.write(ir.data(), ir.size());
+				cache->store_contents(cache_key, std::string(ir.begin(), ir.end()));
+			} else {
+				compilation.write_ir(output_path);
+			}
+		}
 		
 		file.close();
 	} catch (const std::exception& e) {
-		// Catch any exceptions we may have thrown during lexing, parsing or code generation, and print it out
-		std::cout << e.what() << std::endl;
+		// Catch any exceptions thrown while reading the file or writing the output, and fail, so that scripts
+		// do not take a missing output for a successful compile
+		std::cerr << e.what() << std::endl;
+		return 1;
 	}
+
+	return 0;
 }
@@ -8,12 +8,18 @@
 #include <forward_list>
 #include <memory>
 #include <llvm/ADT/STLExtras.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
 
 using namespace ast::expr;
 using namespace ast::statement;
 using namespace ast::declaration;
 
-Parser::Parser(TokenStream& ts) noexcept :
+Parser::Parser(TokenStream& ts, bool defer_bodies) noexcept :
+	defer_bodies(defer_bodies),
 	ts(ts) { }
 
 
@@ -31,14 +37,21 @@ std::unique_ptr<Program> Parser::parse_program() {
 }
 
 std::forward_list<std::unique_ptr<Declaration>> Parser::parse_decl_list() {
-	auto decl = this->parse_decl();
+	std::unique_ptr<Declaration> decl;
+	try {
+		decl = this->parse_decl();
+	} catch (const ParseError& e) {
+		this->recover_decl(e);
+	}
 
 	switch (ts.peek_type(1)) {
 		// decl_list ::= decl
 		case Token::Type::EndOfInput:
 			{
 				std::forward_list<std::unique_ptr<Declaration>> decl_list;
-				decl_list.push_front(std::move(decl));
+				if (decl != nullptr) {
+					decl_list.push_front(std::move(decl));
+				}
 				return decl_list;
 			}
 			//return std::forward_list<std::unique_ptr<Declaration>> { std::move(decl) };
@@ -47,15 +60,25 @@ std::forward_list<std::unique_ptr<Declaration>> Parser::parse_decl_list() {
 		case Token::Type::Int:
 		case Token::Type::Float:
 		case Token::Type::Bool:
+		case Token::Type::Long:
+		case Token::Type::Double:
+		case Token::Type::Int4:
+		case Token::Type::Int8:
+		case Token::Type::Float4:
+		case Token::Type::Float8:
 		case Token::Type::Void:
+		case Token::Type::Inline:
+		case Token::Type::Const:
 			{
 				auto decl_list = this->parse_decl_list();
-				decl_list.push_front(std::move(decl));
+				if (decl != nullptr) {
+					decl_list.push_front(std::move(decl));
+				}
 				return decl_list;
 			}
 
 		default:
-			throw ParseError(
+			this->recover_decl(ParseError(
 				this->ts.current_line(),
 				this->ts.current_column(),
 				"a list of declarations",
@@ -65,10 +88,27 @@ std::forward_list<std::unique_ptr<Declaration>> Parser::parse_decl_list() {
 					Token::Type::Int,
 					Token::Type::Float,
 					Token::Type::Bool,
-					Token::Type::Void
+					Token::Type::Long,
+					Token::Type::Double,
+					Token::Type::Int4,
+					Token::Type::Int8,
+					Token::Type::Float4,
+					Token::Type::Float8,
+					Token::Type::Void,
+					Token::Type::Inline,
+					Token::Type::Const
 				},
 				ts.next()
-			);
+			));
+
+			std::forward_list<std::unique_ptr<Declaration>> decl_list;
+			if (ts.peek_type(1) != Token::Type::EndOfInput) {
+				decl_list = this->parse_decl_list();
+			}
+			if (decl != nullptr) {
+				decl_list.push_front(std::move(decl));
+			}
+			return decl_list;
 	}
 }
 
@@ -76,49 +116,131 @@ std::unique_ptr<Declaration> Parser::parse_decl() {
 	auto line_num = this->ts.current_line();
 	auto column_num = this->ts.current_column();
 
-	if (ts.peek_type(1) == Token::Type::Void) {
+	// fun_decl ::= "inline" return_type IDENTIFIER "(" params ")" block
+	bool is_inline = ts.peek_type(1) == Token::Type::Inline;
+	if (is_inline) {
+		ts.next();
+	}
+
+	// var_decl ::= "const" var_type IDENTIFIER ...
+	bool is_const = !is_inline && ts.peek_type(1) == Token::Type::Const;
+	if (is_const) {
+		ts.next();
+	}
+
+	if (ts.peek_type(1) == Token::Type::Void && !is_const) {
 		// parse a void function
 		auto decl = llvm::make_unique<FuncDecl>();
 
 		decl->line_num = line_num;
 		decl->column_num = column_num;
+		decl->is_inline = is_inline;
 		decl->return_type = this->parse_return_type();
 		decl->name = this->parse_identifier("a function declaration");
 		this->consume(Token::Type::LParen, "a function declaration", "a \"(\" to signify the start of the parameter list");
 		decl->params = this->parse_params();
 		this->consume(Token::Type::RParen, "a function declaration", "a \"(\" to signify the end of the parameter list");
-		decl->body = this->parse_block();
+		this->parse_func_body(*decl);
 
 		return std::move(decl);
 	}
 
 	// parse a non-void function
-	auto var_type = this->parse_var_type("a function declaration");
+	auto var_type = this->parse_var_type(is_const ? "a constant declaration" : "a function declaration");
 	auto name = this->parse_identifier("a function declaration");
 
 	const Token& symbol = ts.next();
+	if (is_inline && symbol.type != Token::Type::LParen) {
+		throw ParseError(
+			this->ts.current_line(),
+			this->ts.current_column(),
+			"an inline function declaration",
+			"a parameter list, as only functions can be declared inline",
+			std::vector<Token::Type> { Token::Type::LParen },
+			symbol
+		);
+	}
+	if (is_const && symbol.type != Token::Type::Assign && symbol.type != Token::Type::LBracket) {
+		throw ParseError(
+			this->ts.current_line(),
+			this->ts.current_column(),
+			"a constant declaration",
+			"an initializer or array size, as only variables can be declared const, and must be given a value",
+			std::vector<Token::Type> {
+				Token::Type::Assign,
+				Token::Type::LBracket
+			},
+			symbol
+		);
+	}
+
 	switch (symbol.type) {
 		case Token::Type::SemiColon:
 			{
 				auto var_decl = llvm::make_unique<VarDecl>();
 
+				var_decl->line_num = line_num;
+				var_decl->column_num = column_num;
 				var_decl->type = var_type;
 				var_decl->name = name;
 
 				return std::move(var_decl);
 			}
 
+		// var_decl ::= ["const"] var_type IDENTIFIER "=" expr ";"
+		case Token::Type::Assign:
+			{
+				auto var_decl = llvm::make_unique<VarDecl>();
+
+				var_decl->line_num = line_num;
+				var_decl->column_num = column_num;
+				var_decl->type = var_type;
+				var_decl->name = name;
+				var_decl->is_const = is_const;
+				var_decl->initializer_begin = this->ts.index;
+				var_decl->initializer.push_front(this->parse_expr());
+				var_decl->initializer_end = this->ts.index;
+				this->consume(Token::Type::SemiColon, "a global variable declaration", "a \";\" to end the variable declaration");
+
+				return std::move(var_decl);
+			}
+
+		// var_decl ::= ["const"] var_type IDENTIFIER "[" INT_LIT "]" ["=" "{" arg_list "}"] ";"
+		case Token::Type::LBracket:
+			{
+				auto var_decl = llvm::make_unique<VarDecl>();
+
+				var_decl->line_num = line_num;
+				var_decl->column_num = column_num;
+				var_decl->type = array_type(var_type);
+				var_decl->name = name;
+				var_decl->is_const = is_const;
+				var_decl->array_size = this->parse_array_size("a global array declaration");
+				if (is_const || ts.peek_type(1) == Token::Type::Assign) {
+					this->consume(Token::Type::Assign, "a constant array declaration", "a \"=\" followed by the elements, as a constant must be given a value");
+					var_decl->initializer_begin = this->ts.index;
+					this->consume(Token::Type::LBrace, "an array initializer", "a \"{\" to start the list of elements");
+					var_decl->initializer = this->parse_arg_list();
+					this->consume(Token::Type::RBrace, "an array initializer", "a \"}\" to end the list of elements");
+					var_decl->initializer_end = this->ts.index;
+				}
+				this->consume(Token::Type::SemiColon, "a global array declaration", "a \";\" to end the array declaration");
+
+				return std::move(var_decl);
+			}
+
 		case Token::Type::LParen:
 			{
 				auto func_decl = llvm::make_unique<FuncDecl>();
 
 				func_decl->line_num = line_num;
 				func_decl->column_num = column_num;
+				func_decl->is_inline = is_inline;
 				func_decl->return_type = static_cast<ReturnType>(var_type);
 				func_decl->params = this->parse_params();
 				func_decl->name = name;
 				this->consume(Token::Type::RParen, "a function declaration", "a \"(\" to signify the end of the parameter list");
-				func_decl->body = this->parse_block();
+				this->parse_func_body(*func_decl);
 
 				return std::move(func_decl);
 			}
@@ -128,9 +250,11 @@ std::unique_ptr<Declaration> Parser::parse_decl() {
 				this->ts.current_line(),
 				this->ts.current_column(),
 				"a variable or function declaration",
-				"parameter list or end of variable declaration",
+				"parameter list, array size, initializer or end of variable declaration",
 				std::vector<Token::Type> {
 					Token::Type::SemiColon,
+					Token::Type::Assign,
+					Token::Type::LBracket,
 					Token::Type::LParen
 				},
 				symbol
@@ -150,17 +274,135 @@ std::unique_ptr<Block> Parser::parse_block() {
 	return block;
 }
 
+void Parser::parse_func_body(FuncDecl& decl) {
+	decl.body_begin = this->ts.index;
+
+	if (this->defer_bodies) {
+		this->skip_block();
+	} else {
+		decl.body = this->parse_block();
+	}
+
+	decl.body_end = this->ts.index;
+}
+
+void Parser::skip_block() {
+	this->consume(Token::Type::LBrace, "a block of code", "a \"{\" to signfiy the start of the code block");
+
+	unsigned int depth = 1;
+	while (depth > 0) {
+		const Token& tok = this->ts.next();
+
+		switch (tok.type) {
+			case Token::Type::LBrace: depth++; break;
+			case Token::Type::RBrace: depth--; break;
+
+			case Token::Type::EndOfInput:
+				throw ParseError(
+					tok.line_num,
+					tok.column_num,
+					"a block of code",
+					"a \"}\" to end the code block",
+					std::vector<Token::Type> { Token::Type::RBrace },
+					tok
+				);
+
+			default: break;
+		}
+	}
+}
+
+// Parse the body of a function declared while bodies were deferred. The body's tokens are copied into
+// their own stream (terminated by an end of input at the closing brace), so that bodies can be parsed
+// independently of each other and of this parser's position.
+void Parser::parse_deferred_body(FuncDecl& decl) {
+	TokenStream body_ts;
+	body_ts.tokens.assign(this->ts.tokens.begin() + decl.body_begin, this->ts.tokens.begin() + decl.body_end);
+
+	const Token& close_brace = body_ts.tokens.back();
+	body_ts.tokens.emplace_back(Token::Type::EndOfInput, "", close_brace.line_num, close_brace.column_num + 1);
+
+	Parser body_parser(body_ts);
+	try {
+		decl.body = body_parser.parse_block();
+	} catch (const ParseError& e) {
+		body_parser.errors.push_back(e);
+	}
+
+	this->errors.insert(this->errors.end(), body_parser.errors.begin(), body_parser.errors.end());
+}
+
+void Parser::parse_deferred_bodies(Program& program, unsigned int num_threads) {
+	std::vector<FuncDecl*> funcs;
+	for (auto& decl : program.decls) {
+		if (auto func_decl = dynamic_cast<FuncDecl*>(decl.get())) {
+			if (func_decl->body == nullptr) {
+				funcs.push_back(func_decl);
+			}
+		}
+	}
+
+	this->parse_deferred_bodies(funcs, num_threads);
+}
+
+void Parser::parse_deferred_bodies(const std::vector<FuncDecl*>& funcs, unsigned int num_threads) {
+	// Each function gets its own parser, so the workers share nothing but the (read only) token
+	// stream. Errors are merged afterwards and sorted into source order, as those found in the declarations
+	// were recorded before any body was parsed.
+	std::vector<Parser> body_parsers(funcs.size(), Parser(this->ts));
+	std::atomic<size_t> next_func(0);
+
+	auto worker = [&]() {
+		for (size_t i = next_func++; i < funcs.size(); i = next_func++) {
+			body_parsers[i].parse_deferred_body(*funcs[i]);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned int i = 1; i < num_threads; i++) {
+		threads.emplace_back(worker);
+	}
+	worker();
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	for (auto& body_parser : body_parsers) {
+		this->errors.insert(this->errors.end(), body_parser.errors.begin(), body_parser.errors.end());
+	}
+
+	std::stable_sort(this->errors.begin(), this->errors.end(), [](const ParseError& a, const ParseError& b) {
+		return a.line() != b.line() ? a.line() < b.line() : a.column() < b.column();
+	});
+}
+
 std::forward_list<std::unique_ptr<VarDecl>> Parser::parse_local_decl_list() {
 	switch (ts.peek_type(1)) {
 		// local_decls ::= local_decl local_decls
 		case Token::Type::Int:
 		case Token::Type::Float:
 		case Token::Type::Bool:
+		case Token::Type::Long:
+		case Token::Type::Double:
+		case Token::Type::Int4:
+		case Token::Type::Int8:
+		case Token::Type::Float4:
+		case Token::Type::Float8:
 			{
-				auto local_decl = this->parse_local_decl();
+				size_t decl_start = this->ts.index;
+				std::unique_ptr<VarDecl> local_decl;
+				try {
+					local_decl = this->parse_local_decl();
+				} catch (const ParseError& e) {
+					this->recover_stmt(e, decl_start);
+				}
+
 				auto local_decl_list = this->parse_local_decl_list();
 
-				local_decl_list.push_front(std::move(local_decl));
+				if (local_decl != nullptr) {
+					local_decl_list.push_front(std::move(local_decl));
+				}
 
 				return local_decl_list;
 			}
@@ -194,6 +436,12 @@ std::forward_list<std::unique_ptr<VarDecl>> Parser::parse_local_decl_list() {
 					Token::Type::Int,
 					Token::Type::Float,
 					Token::Type::Bool,
+					Token::Type::Long,
+					Token::Type::Double,
+					Token::Type::Int4,
+					Token::Type::Int8,
+					Token::Type::Float4,
+					Token::Type::Float8,
 					Token::Type::While,
 					Token::Type::If,
 					Token::Type::LBrace,
@@ -215,8 +463,15 @@ std::forward_list<std::unique_ptr<VarDecl>> Parser::parse_local_decl_list() {
 
 std::unique_ptr<VarDecl> Parser::parse_local_decl() {
 	auto local_decl = llvm::make_unique<VarDecl>();
+	local_decl->line_num = this->ts.current_line();
+	local_decl->column_num = this->ts.current_column();
 	local_decl->type = this->parse_var_type("a local variable declaration");
 	local_decl->name = this->parse_identifier("a local variable declaration");
+	if (ts.peek_type(1) == Token::Type::LBracket) {
+		this->ts.next();
+		local_decl->type = array_type(local_decl->type);
+		local_decl->array_size = this->parse_array_size("a local array declaration");
+	}
 	this->consume(Token::Type::SemiColon, "a local variable declaration", "a \";\" to end the local variable declaration");
 	return local_decl;
 }
@@ -240,14 +495,34 @@ std::forward_list<std::unique_ptr<Statement>> Parser::parse_stmt_list() {
 		case Token::Type::IntLit:
 		case Token::Type::FloatLit:
 		case Token::Type::BoolLit: {
-			auto stmt = this->parse_stmt();
+			size_t stmt_start = this->ts.index;
+			std::unique_ptr<Statement> stmt;
+			try {
+				stmt = this->parse_stmt();
+			} catch (const ParseError& e) {
+				this->recover_stmt(e, stmt_start);
+			}
+
 			auto stmt_list = this->parse_stmt_list();
-			stmt_list.push_front(std::move(stmt));
+			if (stmt != nullptr) {
+				stmt_list.push_front(std::move(stmt));
+			}
 			return stmt_list;
 		}
 
-		default:
+		// Nothing more can be parsed
+		case Token::Type::EndOfInput:
 			throw ParseError(
+				this->ts.current_line(),
+				this->ts.current_column(),
+				"a basic block",
+				"a closing \"}\" or beginning of a statement",
+				std::vector<Token::Type> { Token::Type::RBrace },
+				ts.next()
+			);
+
+		default:
+			this->recover_stmt(ParseError(
 				this->ts.current_line(),
 				this->ts.current_column(),
 				"a basic block",
@@ -267,7 +542,9 @@ std::forward_list<std::unique_ptr<Statement>> Parser::parse_stmt_list() {
 					Token::Type::BoolLit
 				},
 				ts.next()
-			);
+			), this->ts.index);
+
+			return this->parse_stmt_list();
 	}
 }
 
@@ -422,6 +699,14 @@ std::forward_list<std::unique_ptr<ExternDecl>> Parser::parse_extern_list() {
 		case Token::Type::Int:
 		case Token::Type::Float:
 		case Token::Type::Bool:
+		case Token::Type::Long:
+		case Token::Type::Double:
+		case Token::Type::Int4:
+		case Token::Type::Int8:
+		case Token::Type::Float4:
+		case Token::Type::Float8:
+		case Token::Type::Inline:
+		case Token::Type::Const:
 			{
 				std::forward_list<std::unique_ptr<ExternDecl>> extern_list;
 				return extern_list;
@@ -438,7 +723,15 @@ std::forward_list<std::unique_ptr<ExternDecl>> Parser::parse_extern_list() {
 					Token::Type::Void,
 					Token::Type::Int,
 					Token::Type::Float,
-					Token::Type::Bool
+					Token::Type::Bool,
+					Token::Type::Long,
+					Token::Type::Double,
+					Token::Type::Int4,
+					Token::Type::Int8,
+					Token::Type::Float4,
+					Token::Type::Float8,
+					Token::Type::Inline,
+					Token::Type::Const
 				},
 				ts.next()
 			);
@@ -477,6 +770,12 @@ std::forward_list<std::unique_ptr<Param>> Parser::parse_params() {
 		case Token::Type::Int:
 		case Token::Type::Float:
 		case Token::Type::Bool:
+		case Token::Type::Long:
+		case Token::Type::Double:
+		case Token::Type::Int4:
+		case Token::Type::Int8:
+		case Token::Type::Float4:
+		case Token::Type::Float8:
 			return this->parse_param_list();
 
 		default:
@@ -490,7 +789,13 @@ std::forward_list<std::unique_ptr<Param>> Parser::parse_params() {
 					Token::Type::Void,
 					Token::Type::Int,
 					Token::Type::Float,
-					Token::Type::Bool
+					Token::Type::Bool,
+					Token::Type::Long,
+					Token::Type::Double,
+					Token::Type::Int4,
+					Token::Type::Int8,
+					Token::Type::Float4,
+					Token::Type::Float8
 				},
 				ts.next()
 			);
@@ -518,6 +823,13 @@ std::unique_ptr<Param> Parser::parse_param() {
 	param->type = this->parse_var_type("parameter definition");
 	param->name = this->parse_identifier("parameter definition");
 
+	// param ::= var_type IDENTIFIER "[" "]"
+	if (ts.peek_type(1) == Token::Type::LBracket) {
+		this->ts.next();
+		this->consume(Token::Type::RBracket, "an array parameter definition", "a \"]\", as array parameters take arrays of any size");
+		param->type = array_type(param->type);
+	}
+
 	return param;
 }
 
@@ -529,8 +841,8 @@ std::string Parser::parse_identifier(const char* context) {
 	}
 
 	throw ParseError(
-		this->ts.current_column(),
 		this->ts.current_line(),
+		this->ts.current_column(),
 		std::string(context),
 		"an identifier",
 		std::vector<Token::Type> { Token::Type::Identifier },
@@ -550,6 +862,24 @@ VarType Parser::parse_var_type(const char* context) {
 		// var_type ::= "bool"
 		case Token::Type::Bool: return VarType::Bool;
 
+		// var_type ::= "long"
+		case Token::Type::Long: return VarType::Long;
+
+		// var_type ::= "double"
+		case Token::Type::Double: return VarType::Double;
+
+		// var_type ::= "int4"
+		case Token::Type::Int4: return VarType::Int4;
+
+		// var_type ::= "int8"
+		case Token::Type::Int8: return VarType::Int8;
+
+		// var_type ::= "float4"
+		case Token::Type::Float4: return VarType::Float4;
+
+		// var_type ::= "float8"
+		case Token::Type::Float8: return VarType::Float8;
+
 		default:
 			throw ParseError(
 				this->ts.current_line(),
@@ -559,13 +889,38 @@ VarType Parser::parse_var_type(const char* context) {
 				std::vector<Token::Type> {
 					Token::Type::Int,
 					Token::Type::Float,
-					Token::Type::Bool
+					Token::Type::Bool,
+					Token::Type::Long,
+					Token::Type::Double,
+					Token::Type::Int4,
+					Token::Type::Int8,
+					Token::Type::Float4,
+					Token::Type::Float8
 				},
 				tok
 			);
 	}
 }
 
+// Parses the rest of an array size, after the "[", which must be a positive integer literal
+unsigned int Parser::parse_array_size(const char* context) {
+	const Token& tok = this->ts.next();
+	unsigned long size = tok.type == Token::Type::IntLit ? std::stoul(std::string(tok.lexeme)) : 0;
+	if (size == 0 || size > UINT32_MAX) {
+		throw ParseError(
+			this->ts.current_line(),
+			this->ts.current_column(),
+			std::string(context),
+			"a positive integer for the size of the array",
+			std::vector<Token::Type> { Token::Type::IntLit },
+			tok
+		);
+	}
+
+	this->consume(Token::Type::RBracket, context, "a \"]\" to end the array size");
+	return size;
+}
+
 ReturnType Parser::parse_return_type() {
 	switch (ts.next().type) {
 		// return_type ::= "void"
@@ -580,6 +935,24 @@ ReturnType Parser::parse_return_type() {
 		// return_type ::= "bool"
 		case Token::Type::Bool: return ReturnType::Bool;
 
+		// return_type ::= "long"
+		case Token::Type::Long: return ReturnType::Long;
+
+		// return_type ::= "double"
+		case Token::Type::Double: return ReturnType::Double;
+
+		// return_type ::= "int4"
+		case Token::Type::Int4: return ReturnType::Int4;
+
+		// return_type ::= "int8"
+		case Token::Type::Int8: return ReturnType::Int8;
+
+		// return_type ::= "float4"
+		case Token::Type::Float4: return ReturnType::Float4;
+
+		// return_type ::= "float8"
+		case Token::Type::Float8: return ReturnType::Float8;
+
 		default: throw ParseError("Expected return type, found something else...");
 	}
 }
@@ -629,6 +1002,7 @@ std::unique_ptr<Expr> Parser::parse_primary_expr() {
 				switch (ts.peek_type(2)) {
 					case Token::Type::Assign: return this->parse_assign_expr();
 					case Token::Type::LParen: return this->parse_func_call_expr();
+					case Token::Type::LBracket: return this->parse_index_expr();
 					default: return this->parse_identifier_expr();
 				}
 			}
@@ -674,14 +1048,28 @@ std::unique_ptr<Expr> Parser::parse_negate_expr() {
 std::unique_ptr<Expr> Parser::parse_int_expr() {
 	auto line_num = this->ts.current_line();
 	auto column_num = this->ts.current_column();
-	int value = std::stoi(std::string(this->ts.next().lexeme));
+	const Token& literal = this->ts.next();
+
+	int64_t value;
+	try {
+		value = std::stoll(std::string(literal.lexeme));
+	} catch (const std::out_of_range&) {
+		throw ParseError(line_num, column_num, "an integer literal", "an integer no larger than a long can hold", literal);
+	}
 	return llvm::make_unique<IntExpr>(value, line_num, column_num);
 }
 
 std::unique_ptr<Expr> Parser::parse_float_expr() {
 	auto line_num = this->ts.current_line();
 	auto column_num = this->ts.current_column();
-	float value = std::stof(std::string(this->ts.next().lexeme));
+	const Token& literal = this->ts.next();
+
+	double value;
+	try {
+		value = std::stod(std::string(literal.lexeme));
+	} catch (const std::out_of_range&) {
+		throw ParseError(line_num, column_num, "a floating point literal", "a number within the range of a double", literal);
+	}
 	return llvm::make_unique<FloatExpr>(value, line_num, column_num);
 }
 
@@ -716,6 +1104,31 @@ std::unique_ptr<Expr> Parser::parse_assign_expr() {
 	return assign_expr;
 }
 
+std::unique_ptr<Expr> Parser::parse_index_expr() {
+	auto line_num = this->ts.current_line();
+	auto column_num = this->ts.current_column();
+
+	auto name = this->parse_identifier("an array element");
+	this->consume(Token::Type::LBracket, "an array element", "a \"[\" to begin the index");
+	auto index = this->parse_expr();
+	this->consume(Token::Type::RBracket, "an array element", "a \"]\" to end the index");
+
+	// element_assign ::= IDENTIFIER "[" expr "]" "=" expr
+	if (ts.peek_type(1) == Token::Type::Assign) {
+		this->ts.next();
+
+		auto assign_expr = llvm::make_unique<AssignExpr>();
+		assign_expr->line_num = line_num;
+		assign_expr->column_num = column_num;
+		assign_expr->name = std::move(name);
+		assign_expr->index = std::move(index);
+		assign_expr->expr = this->parse_expr();
+		return std::move(assign_expr);
+	}
+
+	return llvm::make_unique<IndexExpr>(std::move(name), std::move(index), line_num, column_num);
+}
+
 std::unique_ptr<Expr> Parser::parse_func_call_expr() {
 	auto fc_expr = llvm::make_unique<FuncCallExpr>();
 	
@@ -761,6 +1174,80 @@ std::forward_list<std::unique_ptr<Expr>> Parser::parse_arg_list() {
 	return args;
 }
 
+void Parser::recover_stmt(const ParseError& error, size_t stmt_start) {
+	this->errors.push_back(error);
+
+	// The token that caused the error has usually been consumed. If it was the "}" closing the
+	// enclosing block or a ";", step back so that we synchronize on it.
+	if (this->ts.index > stmt_start) {
+		Token::Type last_type = this->ts.tokens[this->ts.index - 1].type;
+		if (last_type == Token::Type::RBrace || last_type == Token::Type::SemiColon) {
+			this->ts.index--;
+		}
+	}
+
+	// Panic mode: skip to the end of the statement, or to the end of the block (leaving the "}" for parse_block)
+	while (true) {
+		switch (this->ts.peek_type(1)) {
+			case Token::Type::SemiColon:
+				this->ts.next();
+				return;
+
+			case Token::Type::RBrace:
+			case Token::Type::EndOfInput:
+				return;
+
+			default:
+				this->ts.next();
+		}
+	}
+}
+
+void Parser::recover_decl(const ParseError& error) {
+	this->errors.push_back(error);
+
+	// Panic mode: skip past the next top level ";" or "}" after which another declaration (or the end of input) starts.
+	// Errors inside function bodies are recovered from at the statement level, so we are at most inside the body
+	// of the function whose signature was bad.
+	int brace_depth = 0;
+	while (true) {
+		Token::Type type = this->ts.next().type;
+
+		if (type == Token::Type::EndOfInput) {
+			this->ts.index = this->ts.tokens.size() - 1;
+			return;
+		}
+
+		if (type == Token::Type::LBrace) {
+			brace_depth++;
+		} else if (type == Token::Type::RBrace) {
+			brace_depth--;
+		}
+
+		if ((type == Token::Type::SemiColon || type == Token::Type::RBrace) && brace_depth <= 0) {
+			switch (this->ts.peek_type(1)) {
+				case Token::Type::Int:
+				case Token::Type::Float:
+				case Token::Type::Bool:
+				case Token::Type::Long:
+				case Token::Type::Double:
+				case Token::Type::Int4:
+				case Token::Type::Int8:
+				case Token::Type::Float4:
+				case Token::Type::Float8:
+				case Token::Type::Void:
+				case Token::Type::Inline:
+				case Token::Type::Const:
+				case Token::Type::EndOfInput:
+					return;
+
+				default:
+					break;
+			}
+		}
+	}
+}
+
 void Parser::consume(Token::Type expected_type, const char* context, const char* expected) {
 	const Token& tok = this->ts.next();
 	Token::Type actual_type = tok.type;
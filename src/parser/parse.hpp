@@ -5,17 +5,23 @@
 #include "../ast/declaration.hpp"
 #include "../ast/expr.hpp"
 #include "token_stream.hpp"
+#include "parse_error.hpp"
 
 using namespace ast::declaration;
 
 class Parser {
 public:
-	Parser(TokenStream& ts) noexcept;
+	Parser(TokenStream& ts, bool defer_bodies = false) noexcept;
 
 	std::unique_ptr<Program> parse_program();
 	std::forward_list<std::unique_ptr<Declaration>> parse_decl_list();
 	std::unique_ptr<Declaration> parse_decl();
 	std::unique_ptr<Block> parse_block();
+	void parse_func_body(FuncDecl& decl);
+	void skip_block();
+	void parse_deferred_body(FuncDecl& decl);
+	void parse_deferred_bodies(Program& program, unsigned int num_threads);
+	void parse_deferred_bodies(const std::vector<FuncDecl*>& funcs, unsigned int num_threads);
 	std::forward_list<std::unique_ptr<VarDecl>> parse_local_decl_list();
 	std::unique_ptr<VarDecl> parse_local_decl();
 	std::forward_list<std::unique_ptr<Statement>> parse_stmt_list();
@@ -27,6 +33,7 @@ public:
 	std::unique_ptr<Param> parse_param();
 	std::string parse_identifier(const char* context);
 	VarType parse_var_type(const char* context);
+	unsigned int parse_array_size(const char* context);
 	std::unique_ptr<Statement> parse_expr_stmt();
 	std::unique_ptr<Statement> parse_if_stmt();
 	std::unique_ptr<Statement> parse_while_stmt();
@@ -42,12 +49,23 @@ public:
 	std::unique_ptr<Expr> parse_parens_expr();
 	std::unique_ptr<Expr> parse_assign_expr();
 	std::unique_ptr<Expr> parse_func_call_expr();
+	std::unique_ptr<Expr> parse_index_expr();
 	std::unique_ptr<Expr> parse_identifier_expr();
 	std::forward_list<std::unique_ptr<Expr>> parse_args();
 	std::forward_list<std::unique_ptr<Expr>> parse_arg_list();
 	ReturnType parse_return_type();
 	void consume(Token::Type expected_type, const char* context, const char* expected);
 
+	// Errors recovered from while parsing. The program returned by parse_program is only usable if this is empty.
+	std::vector<ParseError> errors;
+
+	// When set, function bodies are skipped over by brace matching and only their token ranges are
+	// recorded, leaving FuncDecl::body null until parse_deferred_body(ies) is called.
+	bool defer_bodies;
+
 private:
+	void recover_stmt(const ParseError& error, size_t stmt_start);
+	void recover_decl(const ParseError& error);
+
 	TokenStream& ts;
 };
@@ -1,7 +1,10 @@
 #include "parse_error.hpp"
 #include "../lexer/token.hpp"
 
-ParseError::ParseError(const std::string& err_string) : err_string(err_string) { }
+ParseError::ParseError(const std::string& err_string) :
+	line_num(0),
+	column_num(0),
+	err_string(err_string) { }
 
 ParseError::ParseError(unsigned int line_num, unsigned int column_num, const std::string& context, const std::string& expected_string, const std::vector<Token::Type> expected_types, const Token& unexpected_token) noexcept :
 	line_num(line_num),
@@ -49,7 +52,7 @@ ParseError::ParseError(unsigned int line_num, unsigned int column_num, const std
 		+ ":\n\tin "
 		+ this->context
 		+ ":\n\texpected "
-		+ this->expected_string;
+		+ this->expected_string
 		+ "\n\tinstead found the "
 		+ unexpected_token.to_string();
 }
@@ -57,3 +60,11 @@ ParseError::ParseError(unsigned int line_num, unsigned int column_num, const std
 const char* ParseError::what() const noexcept {
 	return this->err_string.c_str();
 }
+
+unsigned int ParseError::line() const noexcept {
+	return this->line_num;
+}
+
+unsigned int ParseError::column() const noexcept {
+	return this->column_num;
+}
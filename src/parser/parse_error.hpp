@@ -13,6 +13,8 @@ public:
 	ParseError(unsigned int line_num, unsigned int column_num, const std::string& context, const std::string& expected_string, const std::vector<Token::Type> expected_types, const Token& unexpected_token) noexcept;
 	ParseError(unsigned int line_num, unsigned int column_num, const std::string& context, const std::string& expected_string, const Token& unexpected_token) noexcept;
 	const char* what() const noexcept override;
+	unsigned int line() const noexcept;
+	unsigned int column() const noexcept;
 
 private:
 	std::string expected_string;
@@ -0,0 +1,23 @@
+#include "time_report.hpp"
+#include <cstdlib>
+#include <new>
+
+// Replaces the global operator new/delete so that allocations can be counted per phase. The array and
+// nothrow forms all forward to these. Only mccomp itself is built with this file, so that programs
+// embedding the compiler keep their own allocator.
+void* operator new(std::size_t size) {
+	record_allocation(size);
+
+	if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
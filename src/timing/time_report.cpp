@@ -0,0 +1,193 @@
+#include "time_report.hpp"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sys/resource.h>
+
+// Relaxed atomics, so counting costs next to nothing over the allocation itself
+static std::atomic<uint64_t> num_allocations(0);
+static std::atomic<uint64_t> num_allocated_bytes(0);
+
+void record_allocation(std::size_t bytes) {
+	num_allocations.fetch_add(1, std::memory_order_relaxed);
+	num_allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+uint64_t allocation_count() {
+	return num_allocations.load(std::memory_order_relaxed);
+}
+
+uint64_t allocated_bytes() {
+	return num_allocated_bytes.load(std::memory_order_relaxed);
+}
+
+static long peak_rss_kb() {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+static std::string json_escape(const std::string& s) {
+	std::string escaped;
+	for (char c : s) {
+		if (c == '"' || c == '\\') {
+			escaped += '\\';
+		}
+		escaped += c;
+	}
+	return escaped;
+}
+
+TimeReport::TimeReport() :
+	start(std::chrono::steady_clock::now()) { }
+
+TimeReport::~TimeReport() {
+	if (this->print_summary_on_exit) {
+		this->print_summary(std::cerr);
+	}
+
+	if (!this->trace_path.empty()) {
+		this->write_trace(this->trace_path);
+	}
+}
+
+uint64_t TimeReport::now_us() const {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - this->start).count();
+}
+
+void TimeReport::add_event(Event event) {
+	this->events.push_back(std::move(event));
+}
+
+void TimeReport::print_summary(std::ostream& os) const {
+	uint64_t total_us = this->now_us();
+
+	// Phases may run more than once (e.g. per input), so they are summed by name, in order of first use
+	std::vector<std::string> phase_order;
+	std::map<std::string, Event> phases;
+	std::vector<const Event*> functions;
+
+	for (auto& event : this->events) {
+		if (event.category != "phase") {
+			functions.push_back(&event);
+			continue;
+		}
+
+		auto it = phases.find(event.name);
+		if (it == phases.end()) {
+			phase_order.push_back(event.name);
+			phases.insert({ event.name, event });
+		} else {
+			it->second.duration_us += event.duration_us;
+			it->second.allocations += event.allocations;
+			it->second.allocated_bytes += event.allocated_bytes;
+			it->second.peak_rss_kb = std::max(it->second.peak_rss_kb, event.peak_rss_kb);
+		}
+	}
+
+	auto print_row = [&os, total_us](const std::string& name, uint64_t duration_us, uint64_t allocations, uint64_t bytes, long rss_kb) {
+		os
+			<< std::left << std::setw(28) << name
+			<< std::right << std::setw(12) << std::fixed << std::setprecision(3) << duration_us / 1000.0
+			<< std::setw(8) << std::setprecision(1) << (total_us == 0 ? 0.0 : 100.0 * duration_us / total_us)
+			<< std::setw(12) << allocations
+			<< std::setw(14) << bytes
+			<< std::setw(14) << rss_kb
+			<< std::endl;
+	};
+
+	os << "===-------------------------------------------------------------------------===" << std::endl;
+	os << "                          mccomp time report" << std::endl;
+	os << "===-------------------------------------------------------------------------===" << std::endl;
+	os
+		<< std::left << std::setw(28) << "phase"
+		<< std::right << std::setw(12) << "time (ms)"
+		<< std::setw(8) << "%"
+		<< std::setw(12) << "allocs"
+		<< std::setw(14) << "alloc bytes"
+		<< std::setw(14) << "peak RSS (KB)"
+		<< std::endl;
+
+	for (auto& name : phase_order) {
+		auto& phase = phases.at(name);
+		print_row(name, phase.duration_us, phase.allocations, phase.allocated_bytes, phase.peak_rss_kb);
+	}
+	print_row("total", total_us, allocation_count(), allocated_bytes(), peak_rss_kb());
+
+	if (!functions.empty()) {
+		const size_t max_functions = 10;
+
+		std::sort(functions.begin(), functions.end(), [](const Event* a, const Event* b) {
+			return a->duration_us > b->duration_us;
+		});
+
+		os << std::endl << "slowest functions (of " << functions.size() << "):" << std::endl;
+		for (size_t i = 0; i < functions.size() && i < max_functions; i++) {
+			auto& func = *functions[i];
+			print_row(func.name, func.duration_us, func.allocations, func.allocated_bytes, func.peak_rss_kb);
+		}
+	}
+}
+
+void TimeReport::write_trace(const std::string& path) const {
+	std::ofstream out(path);
+	if (!out) {
+		std::cerr << "Failed to open file for time trace: " << path << std::endl;
+		return;
+	}
+
+	out << "{\"traceEvents\":[";
+
+	bool first = true;
+	for (auto& event : this->events) {
+		if (!first) {
+			out << ",";
+		}
+		first = false;
+
+		out
+			<< std::endl
+			<< "{\"pid\":1,\"tid\":0,\"ph\":\"X\""
+			<< ",\"ts\":" << event.start_us
+			<< ",\"dur\":" << event.duration_us
+			<< ",\"name\":\"" << json_escape(event.name) << "\""
+			<< ",\"cat\":\"" << event.category << "\""
+			<< ",\"args\":{"
+				<< "\"allocations\":" << event.allocations
+				<< ",\"allocated_bytes\":" << event.allocated_bytes
+				<< ",\"peak_rss_kb\":" << event.peak_rss_kb
+			<< "}}";
+	}
+
+	out << std::endl << "],\"displayTimeUnit\":\"ms\"}" << std::endl;
+}
+
+TimeScope::TimeScope(TimeReport* report, std::string name, const char* category) :
+	report(report),
+	name(std::move(name)),
+	category(category)
+{
+	if (this->report != nullptr) {
+		this->start_us = this->report->now_us();
+		this->start_allocations = allocation_count();
+		this->start_allocated_bytes = allocated_bytes();
+	}
+}
+
+TimeScope::~TimeScope() {
+	if (this->report == nullptr) {
+		return;
+	}
+
+	this->report->add_event({
+		this->name,
+		this->category,
+		this->start_us,
+		this->report->now_us() - this->start_us,
+		allocation_count() - this->start_allocations,
+		allocated_bytes() - this->start_allocated_bytes,
+		peak_rss_kb()
+	});
+}
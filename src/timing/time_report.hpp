@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Number of calls to operator new, and the bytes they requested, since the program started. These stay
+// at zero unless the program is linked with alloc_count.cpp, which calls record_allocation.
+void record_allocation(std::size_t bytes);
+uint64_t allocation_count();
+uint64_t allocated_bytes();
+
+// Records how long each phase of a compile takes, with the allocations made during the phase and the peak
+// resident set size at its end. The events can be printed as a text summary (-ftime-report) and/or
+// written as Chrome trace events (-ftime-trace), which is the format clang's -ftime-trace produces, so
+// the same viewers (chrome://tracing, Perfetto, speedscope) can be used.
+class TimeReport {
+public:
+	struct Event {
+		std::string name;
+		std::string category; // "phase" for the driver's phases, "function" for per-function events
+		uint64_t start_us;
+		uint64_t duration_us;
+		uint64_t allocations;
+		uint64_t allocated_bytes;
+		long peak_rss_kb;
+	};
+
+	TimeReport();
+	// Writes whichever outputs were requested, so that a report is produced however the compile ends
+	~TimeReport();
+
+	uint64_t now_us() const;
+	void add_event(Event event);
+
+	void print_summary(std::ostream& os) const;
+	void write_trace(const std::string& path) const;
+
+	bool print_summary_on_exit = false;
+	std::string trace_path; // written on exit if non-empty
+
+private:
+	std::chrono::steady_clock::time_point start;
+	std::vector<Event> events;
+};
+
+// Records an event spanning its lifetime. Does nothing if the report is nullptr, so timers can be left in
+// place when no report was asked for.
+class TimeScope {
+public:
+	TimeScope(TimeReport* report, std::string name, const char* category = "phase");
+	~TimeScope();
+
+	TimeScope(const TimeScope&) = delete;
+	TimeScope& operator=(const TimeScope&) = delete;
+
+private:
+	TimeReport* report;
+	std::string name;
+	const char* category;
+	uint64_t start_us;
+	uint64_t start_allocations;
+	uint64_t start_allocated_bytes;
+};
@@ -0,0 +1,99 @@
+// MiniC program using fixed-size arrays: global, local and passed to functions
+extern int print_int(int X);
+extern float print_float(float X);
+
+int squares[32];
+
+void fill_squares(int a[], int n)
+{
+    int i;
+
+    i = 0;
+    while (i < n) {
+      a[i] = i * i;
+      i = i + 1;
+    }
+}
+
+int sum(int a[], int n)
+{
+    int i;
+    int total;
+
+    i = 0;
+    total = 0;
+    while (i < n) {
+      total = total + a[i];
+      i = i + 1;
+    }
+
+    return total;
+}
+
+float mean(int n)
+{
+    float values[32];
+    float total;
+    int i;
+
+    i = 0;
+    total = 0.0;
+    while (i < n) {
+      values[i] = i * 1.0;
+      i = i + 1;
+    }
+
+    i = 0;
+    while (i < n) {
+      total = total + values[i];
+      i = i + 1;
+    }
+
+    return total / n;
+}
+
+// Counts the primes below n with a sieve
+int count_primes(int n)
+{
+    bool composite[64];
+    int i;
+    int j;
+    int count;
+
+    i = 0;
+    while (i < n) {
+      composite[i] = false;
+      i = i + 1;
+    }
+
+    count = 0;
+    i = 2;
+    while (i < n) {
+      if (!composite[i]) {
+        count = count + 1;
+        j = i * i;
+        while (j < n) {
+          composite[j] = true;
+          j = j + i;
+        }
+      }
+      i = i + 1;
+    }
+
+    return count;
+}
+
+int arrays(int n)
+{
+    int result;
+
+    fill_squares(squares, n);
+    result = sum(squares, n) + 10000 * count_primes(n);
+    print_int(result);
+
+    if (mean(n) == (n - 1) / 2.0) {
+      result = result + 100000;
+    }
+
+    return result;
+}
@@ -0,0 +1,63 @@
+// MiniC program mixing pure functions with ones that write globals and arrays, and recurse
+extern int print_int(int X);
+
+int calls;
+int history[4];
+
+// Pure, so calls to it can be hoisted out of the loop in attributes
+int cube(int x)
+{
+    return x * x * x;
+}
+
+// Reads a global, so its calls cannot be moved past the writes to it
+int scaled(int x)
+{
+    return x * calls;
+}
+
+// Writes a global
+int counted(int x)
+{
+    calls = calls + 1;
+    return x;
+}
+
+// Writes through its array parameter
+void record(int a[], int i, int value)
+{
+    a[i] = value;
+}
+
+// Pure, but recursive
+bool is_even(int n)
+{
+    if (n < 2) {
+      return n == 0;
+    }
+    return is_even(n - 2);
+}
+
+int attributes(int n)
+{
+    int local[4];
+    int total;
+    int i;
+
+    calls = 0;
+    total = 0;
+    i = 0;
+    while (i < n) {
+      total = total + cube(n) + scaled(2) + counted(i);
+      record(history, i % 4, total);
+      record(local, i % 4, i);
+      i = i + 1;
+    }
+
+    if (is_even(n)) {
+      total = total + history[1] + local[3];
+    }
+
+    print_int(total);
+    return total;
+}
@@ -0,0 +1,30 @@
+// MiniC program indexing a global array in counted loops, and at an index it is given. It is compiled
+// with -fbounds-check: run_tests checks that element traps out of bounds, and that once optimised no
+// bounds check is left in fill, whose loops never index past the end.
+int data[64];
+
+int fill(int n)
+{
+    int i;
+    int total;
+
+    i = 0;
+    while (i < 64) {
+      data[i] = i * n;
+      i = i + 1;
+    }
+
+    total = 0;
+    i = 0;
+    while (i < 64) {
+      total = total + data[i] / (i + 1);
+      i = i + 1;
+    }
+
+    return total;
+}
+
+int element(int i)
+{
+    return data[i];
+}
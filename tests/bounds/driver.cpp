@@ -0,0 +1,51 @@
+#include <iostream>
+#include <cstdio>
+#include <math.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// mccomp -fbounds-check bounds.c -o bounds.ll && clang++ driver.cpp bounds.ll -o bounds
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+extern "C" DLLEXPORT int print_int(int X) {
+  fprintf(stderr, "%d\n", X);
+  return 0;
+}
+
+extern "C" DLLEXPORT float print_float(float X) {
+  fprintf(stderr, "%f\n", X);
+  return 0;
+}
+
+extern "C" {
+  int fill(int n);
+  int element(int i);
+}
+
+// Indexing past the end traps, so it is done in a child process
+bool element_traps(int i) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    element(i);
+    _exit(0);
+  }
+
+  int status = 0;
+  waitpid(pid, &status, 0);
+  return pid > 0 && WIFSIGNALED(status);
+}
+
+int main() {
+    int result = fill(3);
+    int last = element(63);
+
+    if (result == 125 && last == 189 && element_traps(64) && element_traps(-1))
+    	printf("PASSED Result: %d\n", result);
+    else
+    	printf("FAILED Result: %d\n", result);
+}
@@ -0,0 +1,34 @@
+#include <iostream>
+#include <cstdio>
+#include <math.h>
+
+// clang++ driver.cpp globals.ll -o globals
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+extern "C" DLLEXPORT int print_int(int X) {
+  fprintf(stderr, "%d\n", X);
+  return 0;
+}
+
+extern "C" DLLEXPORT float print_float(float X) {
+  fprintf(stderr, "%f\n", X);
+  return 0;
+}
+
+extern "C" {
+  double globals(int n);
+}
+
+int main() {
+    double result = globals(10);
+
+    if (result == 864.0)
+    	printf("PASSED Result: %f\n", result);
+    else
+    	printf("FAILED Result: %f\n", result);
+}
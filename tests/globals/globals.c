@@ -0,0 +1,48 @@
+// MiniC program using initialized globals, and constants folded at compile time
+extern int print_int(int X);
+
+const int SIZE = 8;
+const int HALF = SIZE / 2;
+const long BIG = 3000000000;
+const float SCALE = 0.5;
+const double TENTH = 0.1;
+const bool ENABLED = !false && SIZE > HALF;
+
+// A lookup table, and one whose int and negated elements are converted to double
+const int PRIMES[8] = { 2, 3, 5, 7, 11, 13, 17, 19 };
+const double WEIGHTS[4] = { 0.25, 0.5, 1, -HALF };
+
+// Initialized globals that can still be assigned, the elements not given being zero
+int counter = 100;
+float offsets[4] = { 1.5, -2.5 };
+long accumulated = BIG * 2;
+
+double globals(int n)
+{
+    int i;
+    int total;
+    double weighted;
+
+    total = 0;
+    i = 0;
+    while (i < SIZE) {
+      total = total + PRIMES[i] * n;
+      i = i + 1;
+    }
+
+    weighted = 0;
+    i = 0;
+    while (i < HALF) {
+      weighted = weighted + WEIGHTS[i] * PRIMES[i];
+      i = i + 1;
+    }
+
+    counter = counter + n;
+    offsets[2] = SCALE * n;
+
+    if (ENABLED && accumulated == 6000000000) {
+      total = total + counter;
+    }
+
+    return total + weighted + TENTH * 10 + offsets[0] + offsets[1] + offsets[2] + offsets[3];
+}
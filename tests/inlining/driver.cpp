@@ -0,0 +1,34 @@
+#include <iostream>
+#include <cstdio>
+#include <math.h>
+
+// clang++ driver.cpp inlining.ll -o inlining
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+extern "C" DLLEXPORT int print_int(int X) {
+  fprintf(stderr, "%d\n", X);
+  return 0;
+}
+
+extern "C" DLLEXPORT float print_float(float X) {
+  fprintf(stderr, "%f\n", X);
+  return 0;
+}
+
+extern "C" {
+  int inlining(int n);
+}
+
+int main() {
+    int result = inlining(100);
+
+    if (result == -15911)
+    	printf("PASSED Result: %d\n", result);
+    else
+    	printf("FAILED Result: %d\n", result);
+}
@@ -0,0 +1,97 @@
+// MiniC program whose small functions, and those declared inline, are inlined into their callers
+extern int print_int(int X);
+
+int calls;
+
+// Small enough to inline without being declared inline
+int square(int x)
+{
+    return x * x;
+}
+
+// Assigns its parameter, which must leave the caller's argument as it was
+int twice(int x)
+{
+    x = x + x;
+    return x;
+}
+
+// Writes a global, and returns nothing
+void count(int by)
+{
+    calls = calls + by;
+}
+
+// Returns an int as a long, which has to be converted in the inlined body too
+long widen(int x)
+{
+    return x;
+}
+
+inline int clamp(int x, int lo, int hi)
+{
+    if (x < lo) {
+      return lo;
+    }
+    if (x > hi) {
+      return hi;
+    }
+    return x;
+}
+
+// Larger than a small function, and returns from inside its loop
+inline int sum_until_odd(int a[], int n)
+{
+    int total;
+    int i;
+
+    total = 0;
+    i = 0;
+    while (i < n) {
+      if (a[i] % 2 == 1) {
+        return total;
+      }
+      total = total + a[i];
+      i = i + 1;
+    }
+
+    return total;
+}
+
+// Never inlined, as it calls itself
+int triangle(int n)
+{
+    if (n <= 0) {
+      return 0;
+    }
+    return n + triangle(n - 1);
+}
+
+int inlining(int n)
+{
+    int values[8];
+    int i;
+    int result;
+    long wide;
+
+    calls = 0;
+    result = 0;
+    wide = 0;
+    i = 0;
+    while (i < n) {
+      values[i % 8] = twice(i);
+      result = result + clamp(square(i), 4, 50) + twice(i) - i;
+      wide = wide + widen(i) * 1000000;
+      count(2);
+      i = i + 1;
+    }
+
+    values[5] = 7;
+    result = result + sum_until_odd(values, 8) + triangle(n) + calls;
+
+    if (wide > 2147483647) {
+      result = -result;
+    }
+
+    return result;
+}
@@ -0,0 +1,34 @@
+#include <iostream>
+#include <cstdio>
+#include <math.h>
+
+// clang++ driver.cpp long_double.ll -o long_double
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+extern "C" DLLEXPORT int print_int(int X) {
+  fprintf(stderr, "%d\n", X);
+  return 0;
+}
+
+extern "C" DLLEXPORT float print_float(float X) {
+  fprintf(stderr, "%f\n", X);
+  return 0;
+}
+
+extern "C" {
+  long long_double(int n);
+}
+
+int main() {
+    long result = long_double(3000);
+
+    if (result == -20018030013L)
+    	printf("PASSED Result: %ld\n", result);
+    else
+    	printf("FAILED Result: %ld\n", result);
+}
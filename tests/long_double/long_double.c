@@ -0,0 +1,84 @@
+// MiniC program using the 64-bit types: long and double variables, arrays and literals
+extern int print_int(int X);
+extern float print_float(float X);
+
+long squares[4];
+
+// The sum of the squares of 1 to n, which no longer fits in an int from n = 1861
+long sum_squares(int n)
+{
+    long total;
+    long i;
+
+    total = 0;
+    i = 1;
+    while (i <= n) {
+      total = total + i * i;
+      i = i + 1;
+    }
+
+    return total;
+}
+
+double sum(double a[], int n)
+{
+    double total;
+    int i;
+
+    total = 0;
+    i = 0;
+    while (i < n) {
+      total = total + a[i];
+      i = i + 1;
+    }
+
+    return total;
+}
+
+// Whether adding up n tenths comes to n / 10 to within 1e-9, which takes double precision
+bool tenths_accurate(int n)
+{
+    double total;
+    double target;
+    double difference;
+    int i;
+
+    total = 0;
+    i = 0;
+    while (i < n) {
+      total = total + 0.1;
+      i = i + 1;
+    }
+
+    target = n;
+    target = target / 10;
+    difference = total - target;
+    return difference < 0.000000001 && difference > -0.000000001;
+}
+
+long long_double(int n)
+{
+    double halves[8];
+    long result;
+    int i;
+
+    i = 0;
+    while (i < 4) {
+      squares[i] = sum_squares(n + i);
+      i = i + 1;
+    }
+
+    i = 0;
+    while (i < 8) {
+      halves[i] = i * 0.5;
+      i = i + 1;
+    }
+
+    result = squares[3] - squares[1] + 10000000000 * (squares[0] % 7);
+
+    if (sum(halves, 8) == 14.0 && tenths_accurate(n)) {
+      result = -result;
+    }
+
+    return result;
+}
@@ -0,0 +1,40 @@
+#include <iostream>
+#include <cstdio>
+#include <math.h>
+
+// clang++ driver.cpp math.ll -o math
+// sqrtf and the other math functions come from the C math library wherever the backend still calls them
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+extern "C" DLLEXPORT int print_int(int X) {
+  fprintf(stderr, "%d\n", X);
+  return 0;
+}
+
+extern "C" DLLEXPORT float print_float(float X) {
+  fprintf(stderr, "%f\n", X);
+  return 0;
+}
+
+extern "C" {
+  float math(int n);
+}
+
+bool essentiallyEqual(float a, float b, float epsilon)
+{
+    return fabs(a - b) <= ( (fabs(a) > fabs(b) ? fabs(b) : fabs(a)) * epsilon);
+}
+
+int main() {
+    float result = math(10);
+
+    if (essentiallyEqual(result, 11.194f, 0.00001f))
+    	printf("PASSED Result: %f\n", result);
+    else
+    	printf("FAILED Result: %f\n", result);
+}
@@ -0,0 +1,48 @@
+// MiniC program calling C math library functions, which are compiled to LLVM intrinsics
+extern float print_float(float X);
+extern float sqrtf(float x);
+extern float fabsf(float x);
+extern float floorf(float x);
+extern float fminf(float x, float y);
+extern float fmaxf(float x, float y);
+extern float fmaf(float x, float y, float z);
+extern double sqrt(double x);
+
+// The length of the path through the points (i, sqrt(i)) for i from 0 to n
+float path_length(int n)
+{
+    float total;
+    float previous;
+    float rise;
+    int i;
+
+    total = 0;
+    previous = 0;
+    i = 1;
+    while (i <= n) {
+      rise = sqrtf(i) - previous;
+      total = total + sqrtf(fmaf(rise, rise, 1));
+      previous = previous + rise;
+      i = i + 1;
+    }
+
+    return total;
+}
+
+float math(int n)
+{
+    float length;
+    float result;
+
+    length = path_length(n);
+    print_float(length);
+
+    // Clamped to [0, 100] and rounded down to a thousandth
+    result = floorf(fminf(fmaxf(length, 0), 100) * 1000) / 1000;
+
+    if (sqrt(2.0) * sqrt(2.0) - 2 < 0.000000001) {
+      result = result + fabsf(-0.5);
+    }
+
+    return result;
+}
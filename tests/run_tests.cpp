@@ -0,0 +1,571 @@
+// In-process test runner. Compiles every tests/<name>/<name>.c with libminic, JIT compiles the module
+// and checks its entry point the same way tests/<name>/driver.cpp does. Tests run concurrently on one
+// CompilerInstance, and every compile has its own LLVMContext, so nothing is shared between them. With
+// --interpret, the programs are run by the bytecode interpreter instead, against the same checks, and
+// with --tiered they are run as TieredPrograms that promote every function on its first call, so that
+// the checks exercise both tiers and the switch between them. Tests of vector types are skipped when
+// interpreting, as the bytecode interpreter does not support them, and tests of bounds checks are skipped
+// when tiered, as the native tier does not make them.
+//
+// usage: ./run_tests [--junit=results.xml] [--jobs=N] [--interpret | --tiered] [tests_dir]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <llvm/IR/Attributes.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+
+#include "../src/compiler/compiler_instance.hpp"
+#include "../src/compiler/optimizer.hpp"
+#include "../src/compiler/tiered_program.hpp"
+#include "../src/interp/interpreter.hpp"
+
+// The drivers' externs print their argument. Tests run concurrently, so here they only consume it.
+extern "C" int test_print_int(int X) {
+	volatile int sink = X;
+	(void)sink;
+	return 0;
+}
+
+extern "C" float test_print_float(float X) {
+	volatile float sink = X;
+	(void)sink;
+	return 0;
+}
+
+// The C math library functions the tests call. Only the interpreter calls them through the binding, as
+// compiled code calls the LLVM intrinsic for each instead.
+template <typename P>
+void bind_math_externs(P& program) {
+	program.bind_native("sqrtf", &::sqrtf);
+	program.bind_native("fabsf", &::fabsf);
+	program.bind_native("floorf", &::floorf);
+	program.bind_native("fminf", &::fminf);
+	program.bind_native("fmaxf", &::fmaxf);
+	program.bind_native("fmaf", &::fmaf);
+	program.bind_native("sqrt", static_cast<double (*)(double)>(&::sqrt));
+}
+
+bool essentially_equal(float a, float b, float epsilon) {
+	return std::fabs(a - b) <= ((std::fabs(a) > std::fabs(b) ? std::fabs(b) : std::fabs(a)) * epsilon);
+}
+
+// Looks up entry points in a test program, which is JIT compiled, interpreted or tiered
+class Program {
+public:
+	Program(JitProgram& jit) : jit(&jit) { }
+	Program(Interpreter& interpreter) : interpreter(&interpreter) { }
+	Program(TieredProgram& tiered) : tiered(&tiered) { }
+
+	template <typename T>
+	std::function<T> entry(const char* name) const {
+		if (this->interpreter != nullptr) {
+			return this->interpreter->function<T>(name);
+		} else if (this->tiered != nullptr) {
+			return this->tiered->function<T>(name);
+		}
+
+		auto function = this->jit->function<T>(name);
+		if (function == nullptr) {
+			throw std::runtime_error(std::string("no function called \"") + name + "\"");
+		}
+		return function;
+	}
+
+	// Whether the call stops at a bounds check. Compiled code traps, so it is called in a child process
+	// for the trap to kill, while the interpreter throws.
+	bool traps(const std::function<void()>& call) const {
+		if (this->jit == nullptr) {
+			try {
+				call();
+			} catch (const InterpreterError&) {
+				return true;
+			}
+			return false;
+		}
+
+		pid_t pid = fork();
+		if (pid == 0) {
+			call();
+			_exit(0);
+		}
+
+		int status = 0;
+		waitpid(pid, &status, 0);
+		return pid > 0 && WIFSIGNALED(status);
+	}
+
+private:
+	JitProgram* jit = nullptr;
+	Interpreter* interpreter = nullptr;
+	TieredProgram* tiered = nullptr;
+};
+
+// What each driver.cpp checks. A check returns an empty string if the test passed, and otherwise why not.
+using Check = std::function<std::string(const Program&)>;
+
+std::string expect(bool passed, const std::string& result) {
+	return passed ? "" : "unexpected result: " + result;
+}
+
+const std::vector<std::pair<std::string, Check>> CHECKS = {
+	{ "addition", [](const Program& p) {
+		int result = p.entry<int(int, int)>("addition")(6, 3);
+		return expect(result == 9, std::to_string(result));
+	} },
+	{ "arrays", [](const Program& p) {
+		int result = p.entry<int(int)>("arrays")(20);
+		return expect(result == 182470, std::to_string(result));
+	} },
+	{ "attributes", [](const Program& p) {
+		int result = p.entry<int(int)>("attributes")(10);
+		return expect(result == 20277, std::to_string(result));
+	} },
+	{ "bounds", [](const Program& p) {
+		int result = p.entry<int(int)>("fill")(3);
+		auto element = p.entry<int(int)>("element");
+		if (result != 125 || element(63) != 189) {
+			return expect(false, std::to_string(result));
+		}
+		return expect(
+			p.traps([&]() { element(64); }) && p.traps([&]() { element(-1); }),
+			"an index out of bounds did not trap"
+		);
+	} },
+	{ "cosine", [](const Program& p) {
+		auto cosine = p.entry<float(float)>("cosine");
+		float x = 3.14159;
+		return expect(
+			essentially_equal(cosine(x), -1.0f, 0.00001f)
+				&& essentially_equal(cosine(x / 3.0), 0.5f, 0.00001f)
+				&& essentially_equal(cosine(2 * x / 3), -0.5f, 0.00001f),
+			std::to_string(cosine(x))
+		);
+	} },
+	{ "factorial", [](const Program& p) {
+		int result = p.entry<int(int)>("factorial")(10);
+		return expect(result == 3628800, std::to_string(result));
+	} },
+	{ "fibonacci", [](const Program& p) {
+		int result = p.entry<int(int)>("fibonacci")(10);
+		return expect(result == 88, std::to_string(result));
+	} },
+	{ "globals", [](const Program& p) {
+		double result = p.entry<double(int)>("globals")(10);
+		return expect(result == 864.0, std::to_string(result));
+	} },
+	{ "inlining", [](const Program& p) {
+		int result = p.entry<int(int)>("inlining")(100);
+		return expect(result == -15911, std::to_string(result));
+	} },
+	{ "long_double", [](const Program& p) {
+		int64_t result = p.entry<int64_t(int)>("long_double")(3000);
+		return expect(result == -20018030013LL, std::to_string(result));
+	} },
+	{ "math", [](const Program& p) {
+		float result = p.entry<float(int)>("math")(10);
+		return expect(essentially_equal(result, 11.194f, 0.00001f), std::to_string(result));
+	} },
+	{ "palindrome", [](const Program& p) {
+		auto palindrome = p.entry<bool(int)>("palindrome");
+		return expect(palindrome(12321) && palindrome(45677654) && !palindrome(123786), "");
+	} },
+	{ "pi", [](const Program& p) {
+		float result = p.entry<float()>("pi")();
+		return expect(essentially_equal(result, 3.141592f, 0.000001f), std::to_string(result));
+	} },
+	{ "recurse", [](const Program& p) {
+		int result = p.entry<int(int)>("recursion_driver")(20);
+		return expect(result == 210, std::to_string(result));
+	} },
+	{ "rfact", [](const Program& p) {
+		int result = p.entry<int(int)>("rfact")(10);
+		return expect(result == 3628800, std::to_string(result));
+	} },
+	{ "unary", [](const Program& p) {
+		float result = p.entry<float(int, float)>("unary")(2, 3.0);
+		return expect(essentially_equal(result, 4.0, 0.001), std::to_string(result));
+	} },
+	{ "vectors", [](const Program& p) {
+		float result = p.entry<float(int)>("vectors")(10);
+		return expect(result == -780.5f, std::to_string(result));
+	} },
+	{ "void", [](const Program& p) {
+		p.entry<void()>("Void")();
+		return std::string();
+	} },
+	{ "while", [](const Program& p) {
+		int result = p.entry<int(int)>("While")(1);
+		return expect(result == 10, std::to_string(result));
+	} },
+};
+
+// Tests of vector types, which only the LLVM backends support, so are skipped with --interpret and --tiered
+const std::vector<std::string> NATIVE_ONLY = { "vectors" };
+
+// Tests whose checks are run again on code the JIT optimised at -O2, as what they test only changes the
+// generated code once the optimiser uses it
+const std::vector<std::string> ALSO_OPTIMISED = { "attributes" };
+
+// Tests compiled with bounds checks, which TieredPrograms do not make, so are skipped with --tiered
+const std::vector<std::string> BOUNDS_CHECKED = { "bounds" };
+
+// Checks of the IR a test compiles to, before it is optimised, made when it is JIT compiled
+using IrCheck = std::function<std::string(const llvm::Module&)>;
+
+// Whether a function has exactly the attributes the AttributeInference should give it
+std::string expect_attributes(const llvm::Module& module, const char* name, bool readnone, bool readonly, bool nounwind, bool norecurse) {
+	const llvm::Function* function = module.getFunction(name);
+	if (function == nullptr) {
+		return std::string("no function called \"") + name + "\"";
+	}
+
+	const std::pair<llvm::Attribute::AttrKind, bool> expected[] = {
+		{ llvm::Attribute::ReadNone, readnone },
+		{ llvm::Attribute::ReadOnly, readonly },
+		{ llvm::Attribute::NoUnwind, nounwind },
+		{ llvm::Attribute::NoRecurse, norecurse },
+	};
+
+	std::string failure;
+	for (auto& attribute : expected) {
+		if (function->hasFnAttribute(attribute.first) != attribute.second) {
+			failure += std::string(failure.empty() ? "" : ", ") + (attribute.second ? "missing " : "unexpected ")
+				+ llvm::Attribute::getNameFromAttrKind(attribute.first).str();
+		}
+	}
+	return failure.empty() ? "" : std::string(name) + ": " + failure;
+}
+
+const std::vector<std::pair<std::string, IrCheck>> IR_CHECKS = {
+	{ "attributes", [](const llvm::Module& module) {
+		// Only a function that neither reads nor writes memory is readnone, and only one that writes none is
+		// readonly. The callee of a call to an extern could do anything.
+		const std::string failures[] = {
+			expect_attributes(module, "cube", true, false, true, true),
+			expect_attributes(module, "scaled", false, true, true, true), // reads a global
+			expect_attributes(module, "counted", false, false, true, true), // writes a global
+			expect_attributes(module, "record", false, false, true, true), // writes through an array parameter
+			expect_attributes(module, "is_even", true, false, true, false), // recursive
+			expect_attributes(module, "attributes", false, false, false, false), // calls print_int
+		};
+
+		for (auto& failure : failures) {
+			if (!failure.empty()) {
+				return "unexpected attributes: " + failure;
+			}
+		}
+		return std::string();
+	} },
+};
+
+// Checks of the IR a test compiles to once optimised at -O2, made on a copy of the module
+const std::vector<std::pair<std::string, IrCheck>> OPTIMISED_IR_CHECKS = {
+	{ "bounds", [](const llvm::Module& module) {
+		// The loops in fill never index past the end of the array, so the optimiser removes their checks
+		const std::pair<const char*, bool> expected[] = { { "fill", false }, { "element", true } };
+		for (auto& function : expected) {
+			bool traps = false;
+			for (auto& block : *module.getFunction(function.first)) {
+				for (auto& inst : block) {
+					auto call = llvm::dyn_cast<llvm::CallInst>(&inst);
+					traps |= call != nullptr && call->getCalledFunction() != nullptr
+						&& call->getCalledFunction()->getIntrinsicID() == llvm::Intrinsic::trap;
+				}
+			}
+
+			if (traps != function.second) {
+				return std::string(function.first) + (traps ? " still has a bounds check" : " has no bounds check");
+			}
+		}
+		return std::string();
+	} },
+};
+
+struct TestResult {
+	std::string name;
+	std::string failure; // empty if the test passed
+	bool skipped = false;
+	double seconds = 0;
+};
+
+std::string read_file(const std::string& path) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in) {
+		throw std::runtime_error("cannot read " + path);
+	}
+
+	std::ostringstream contents;
+	contents << in.rdbuf();
+	return contents.str();
+}
+
+std::string run_tiered_test(const Check& check, const std::string& source) {
+	TieringOptions options;
+	options.call_threshold = 1;
+	options.loop_threshold = 1;
+	options.background = false;
+
+	TieredProgram program(source, options);
+	if (!program.succeeded()) {
+		return "compile failed";
+	}
+	program.bind_native("print_int", &test_print_int);
+	program.bind_native("print_float", &test_print_float);
+	bind_math_externs(program);
+
+	std::string failure = check(Program(program));
+	std::string compile_error = program.wait();
+	return failure.empty() && !compile_error.empty() ? "optimising compile failed: " + compile_error : failure;
+}
+
+std::string run_test(CompilerOptions options, bool tiered, const std::string& tests_dir, const std::string& name) {
+	const Check* check = nullptr;
+	for (auto& entry : CHECKS) {
+		if (entry.first == name) {
+			check = &entry.second;
+		}
+	}
+	if (check == nullptr) {
+		return "no expectations for this test in run_tests.cpp";
+	}
+
+	std::string source = read_file(tests_dir + "/" + name + "/" + name + ".c");
+	if (tiered) {
+		return run_tiered_test(*check, source);
+	}
+
+	options.bounds_checks = std::find(BOUNDS_CHECKED.begin(), BOUNDS_CHECKED.end(), name) != BOUNDS_CHECKED.end();
+	CompilerInstance compiler(options);
+
+	auto compilation = compiler.compile(source);
+	if (!compilation.succeeded()) {
+		std::string failure = "compile failed:";
+		for (auto& diagnostic : compilation.diagnostics()) {
+			failure += "\n" + diagnostic.message;
+		}
+		return failure;
+	}
+
+	if (compilation.bytecode() != nullptr) {
+		Interpreter interpreter(*compilation.bytecode());
+		interpreter.bind_native("print_int", &test_print_int);
+		interpreter.bind_native("print_float", &test_print_float);
+		bind_math_externs(interpreter);
+		return (*check)(Program(interpreter));
+	}
+
+	for (auto& entry : IR_CHECKS) {
+		if (entry.first == name) {
+			std::string failure = entry.second(*compilation.module());
+			if (!failure.empty()) {
+				return failure;
+			}
+		}
+	}
+
+	for (auto& entry : OPTIMISED_IR_CHECKS) {
+		if (entry.first == name) {
+			auto optimised = llvm::CloneModule(*compilation.module());
+			optimize_module(*optimised, 2, nullptr);
+			std::string failure = entry.second(*optimised);
+			if (!failure.empty()) {
+				return "at -O2: " + failure;
+			}
+		}
+	}
+
+	const std::map<std::string, void*> externs = {
+		{ "print_int", reinterpret_cast<void*>(&test_print_int) },
+		{ "print_float", reinterpret_cast<void*>(&test_print_float) },
+	};
+	std::string failure = (*check)(Program(*compilation.jit(externs)));
+	if (!failure.empty() || std::find(ALSO_OPTIMISED.begin(), ALSO_OPTIMISED.end(), name) == ALSO_OPTIMISED.end()) {
+		return failure;
+	}
+
+	// The JIT takes the module, so the optimised code comes from a second compile
+	auto optimised = compiler.compile(source);
+	failure = (*check)(Program(*optimised.jit(externs, 2)));
+	return failure.empty() ? "" : "at -O2: " + failure;
+}
+
+std::vector<std::string> find_tests(const std::string& tests_dir) {
+	std::vector<std::string> names;
+
+	DIR* d = opendir(tests_dir.c_str());
+	if (d == nullptr) {
+		throw std::runtime_error("cannot open tests directory " + tests_dir);
+	}
+
+	while (dirent* ent = readdir(d)) {
+		std::string name(ent->d_name);
+		if (name[0] != '.' && std::ifstream(tests_dir + "/" + name + "/" + name + ".c").good()) {
+			names.push_back(name);
+		}
+	}
+
+	closedir(d);
+	std::sort(names.begin(), names.end());
+	return names;
+}
+
+std::string xml_escape(const std::string& s) {
+	std::string escaped;
+	for (char c : s) {
+		switch (c) {
+			case '<': escaped += "&lt;"; break;
+			case '>': escaped += "&gt;"; break;
+			case '&': escaped += "&amp;"; break;
+			case '"': escaped += "&quot;"; break;
+			default: escaped += c; break;
+		}
+	}
+	return escaped;
+}
+
+void write_junit(const std::string& path, const std::vector<TestResult>& results, double total_seconds) {
+	size_t failures = 0;
+	size_t skipped = 0;
+	for (auto& result : results) {
+		failures += result.failure.empty() ? 0 : 1;
+		skipped += result.skipped ? 1 : 0;
+	}
+
+	std::ofstream out(path);
+	out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl;
+	out << "<testsuite name=\"minic\" tests=\"" << results.size() << "\" failures=\"" << failures << "\" skipped=\"" << skipped << "\" time=\"" << total_seconds << "\">" << std::endl;
+
+	for (auto& result : results) {
+		out << "  <testcase classname=\"minic\" name=\"" << xml_escape(result.name) << "\" time=\"" << result.seconds << "\"";
+		if (result.skipped) {
+			out << ">" << std::endl;
+			out << "    <skipped/>" << std::endl;
+			out << "  </testcase>" << std::endl;
+		} else if (result.failure.empty()) {
+			out << "/>" << std::endl;
+		} else {
+			out << ">" << std::endl;
+			out << "    <failure message=\"" << xml_escape(result.failure) << "\"/>" << std::endl;
+			out << "  </testcase>" << std::endl;
+		}
+	}
+
+	out << "</testsuite>" << std::endl;
+}
+
+int main(int argc, char** argv) {
+	std::string tests_dir = "tests";
+	std::string junit_path;
+	unsigned int jobs = std::max(std::thread::hardware_concurrency(), 1u);
+	CompilerOptions options;
+	bool tiered = false;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg(argv[i]);
+
+		if (arg.compare(0, 8, "--junit=") == 0) {
+			junit_path = arg.substr(8);
+		} else if (arg.compare(0, 7, "--jobs=") == 0) {
+			jobs = std::max(std::atoi(arg.c_str() + 7), 1);
+		} else if (arg == "--interpret") {
+			options.generate_llvm = false;
+			options.generate_bytecode = true;
+		} else if (arg == "--tiered") {
+			tiered = true;
+		} else if (arg[0] == '-') {
+			std::cerr << "usage error: unknown option \"" << arg << "\"" << std::endl;
+			return 1;
+		} else {
+			tests_dir = arg;
+		}
+	}
+
+	bool interpreted = options.generate_bytecode || tiered;
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::string> names = find_tests(tests_dir);
+	std::vector<TestResult> results(names.size());
+	std::atomic<size_t> next_test(0);
+
+	auto worker = [&]() {
+		for (size_t i = next_test++; i < names.size(); i = next_test++) {
+			auto test_start = std::chrono::steady_clock::now();
+
+			results[i].name = names[i];
+			if (interpreted && std::find(NATIVE_ONLY.begin(), NATIVE_ONLY.end(), names[i]) != NATIVE_ONLY.end()) {
+				results[i].skipped = true;
+				continue;
+			}
+			if (tiered && std::find(BOUNDS_CHECKED.begin(), BOUNDS_CHECKED.end(), names[i]) != BOUNDS_CHECKED.end()) {
+				results[i].skipped = true;
+				continue;
+			}
+
+			try {
+				results[i].failure = run_test(options, tiered, tests_dir, names[i]);
+			} catch (const std::exception& e) {
+				results[i].failure = e.what();
+			}
+
+			results[i].seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - test_start).count();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned int i = 1; i < jobs; i++) {
+		threads.emplace_back(worker);
+	}
+	worker();
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	double total_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	size_t failures = 0;
+	size_t skipped = 0;
+	for (auto& result : results) {
+		if (result.skipped) {
+			std::cout << result.name << ": skipped" << std::endl;
+			skipped++;
+		} else if (result.failure.empty()) {
+			std::cout << result.name << ": ok" << std::endl;
+		} else {
+			std::cout << result.name << ": FAILED" << std::endl << "  " << result.failure << std::endl;
+			failures++;
+		}
+	}
+
+	std::cout << std::endl << results.size() - skipped - failures << "/" << results.size() - skipped << " tests passed";
+	if (skipped > 0) {
+		std::cout << " (" << skipped << " skipped)";
+	}
+	std::cout << " in " << total_seconds * 1000 << " ms" << std::endl;
+
+	if (!junit_path.empty()) {
+		write_junit(junit_path, results, total_seconds);
+	}
+
+	return failures == 0 ? 0 : 1;
+}
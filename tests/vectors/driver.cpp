@@ -0,0 +1,34 @@
+#include <iostream>
+#include <cstdio>
+#include <math.h>
+
+// clang++ driver.cpp vectors.ll -o vectors
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+extern "C" DLLEXPORT int print_int(int X) {
+  fprintf(stderr, "%d\n", X);
+  return 0;
+}
+
+extern "C" DLLEXPORT float print_float(float X) {
+  fprintf(stderr, "%f\n", X);
+  return 0;
+}
+
+extern "C" {
+  float vectors(int n);
+}
+
+int main() {
+    float result = vectors(10);
+
+    if (result == -780.5f)
+    	printf("PASSED Result: %f\n", result);
+    else
+    	printf("FAILED Result: %f\n", result);
+}
@@ -0,0 +1,38 @@
+// MiniC program using SIMD vector types: lane-wise arithmetic and negation, lane access and reductions
+extern int print_int(int X);
+extern float print_float(float X);
+
+float8 rows[4];
+
+int4 squares(int4 v)
+{
+    return v * v;
+}
+
+float vectors(int n)
+{
+    int4 a;
+    float4 f;
+    float8 total;
+    int i;
+
+    a = n;
+    a[1] = 2;
+    a[2] = 3;
+    a[3] = -4;
+    a = squares(a) + 1;
+    f = a;
+
+    total = 0;
+    i = 0;
+    while (i < 4) {
+      rows[i] = i * 0.5;
+      total = total + rows[i] * 2;
+      i = i + 1;
+    }
+    total[7] = -1;
+    print_float(total[0]);
+
+    return reduce_add(a) + reduce_add(total) + 1000 * reduce_min(total) + reduce_max(a) + reduce_max(f / 2)
+      + reduce_max(-f) + reduce_min(-a);
+}